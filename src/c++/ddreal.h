@@ -0,0 +1,504 @@
+/*  Double-double arithmetic for the floating point benchmark
+
+    A ddreal represents a number as the unevaluated sum of two
+    IEEE doubles, hi + lo, with |lo| <= ulp(hi) / 2, giving about
+    106 bits (32 decimal digits) of mantissa.  All arithmetic is
+    built from the error-free transformations two_sum and
+    two_prod, the latter using a fused multiply-add when the
+    compiler reports one is available (FP_FAST_FMA) and Dekker's
+    splitting otherwise.  The algorithms are those of Hida, Li,
+    and Bailey's QD library:
+        https://www.davidhbailey.com/dhbsoftware/
+
+    Unlike __float128 and MPFR numbers, a ddreal is a plain pair
+    of doubles: it lives in registers or on the stack, never
+    touches the heap, and the straight-line code of each operation
+    is exposed to the optimiser.
+
+    Only the operations and functions the benchmark needs are
+    provided: arithmetic, comparison, sqrt, and the trigonometric
+    functions sin, cos, tan, cot, and asin.  The trigonometric
+    functions reduce their argument modulo pi/2 and sum a Taylor
+    series which terminates as soon as the terms fall below the
+    precision of the type.  This is fast for the small angles
+    which occur in ray tracing and correct, if slower, for any
+    argument of modest magnitude.
+
+    This file also contains the error-free transformations and
+    constant tables shared with the quad-double type in qdreal.h.
+    Editing to strings is done by the generic code in realedit.h.  */
+
+#ifndef DDREAL_H
+#define DDREAL_H
+
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <string>
+
+#include "realedit.h"
+
+namespace ddqd {
+
+    /*  Error-free transformations.  Each returns the rounded
+        result of an operation and stores its exact rounding
+        error in err.  */
+
+    //  Sum of two doubles
+    inline double two_sum(double a, double b, double &err) {
+        double s = a + b;
+        double bb = s - a;
+        err = (a - (s - bb)) + (b - bb);
+        return s;
+    }
+
+    //  Sum of two doubles, requires |a| >= |b|
+    inline double quick_two_sum(double a, double b, double &err) {
+        double s = a + b;
+        err = b - (s - a);
+        return s;
+    }
+
+    //  Difference of two doubles
+    inline double two_diff(double a, double b, double &err) {
+        double s = a - b;
+        double bb = s - a;
+        err = (a - (s - bb)) - (b + bb);
+        return s;
+    }
+
+#ifndef FP_FAST_FMA
+    //  Split a double into two halves of 26 bits each (Dekker)
+    inline void split(double a, double &hi, double &lo) {
+        const double splitter = 134217729.0;            // 2^27 + 1
+        double t = splitter * a;
+        hi = t - (t - a);
+        lo = a - hi;
+    }
+#endif
+
+    //  Product of two doubles
+    inline double two_prod(double a, double b, double &err) {
+        double p = a * b;
+#ifdef FP_FAST_FMA
+        err = std::fma(a, b, -p);
+#else
+        double a_hi, a_lo, b_hi, b_lo;
+        split(a, a_hi, a_lo);
+        split(b, b_hi, b_lo);
+        err = ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+#endif
+        return p;
+    }
+
+    //  Square of a double
+    inline double two_sqr(double a, double &err) {
+        double p = a * a;
+#ifdef FP_FAST_FMA
+        err = std::fma(a, a, -p);
+#else
+        double hi, lo;
+        split(a, hi, lo);
+        err = ((hi * hi - p) + 2.0 * hi * lo) + lo * lo;
+#endif
+        return p;
+    }
+
+    /*  Constants, each given as an expansion of four doubles,
+        of which a ddreal uses the first two.  These were
+        computed with exact rational arithmetic.  */
+
+    static const double pi_2[4] = {             // pi / 2
+        1.57079632679489656e+00, 6.12323399573676604e-17,
+        -1.49738490485916983e-33, 5.56227110431682641e-50
+    };
+
+    static const int n_inv_fact = 47;
+    static const double inv_fact[n_inv_fact][4] = {
+        { 1.66666666666666657e-01, 9.25185853854297066e-18, 5.13581318503262866e-34, 2.85094902409834186e-50 },  // 1/3!
+        { 4.16666666666666644e-02, 2.31296463463574266e-18, 1.28395329625815716e-34, 7.12737256024585466e-51 },  // 1/4!
+        { 8.33333333333333322e-03, 1.15648231731787138e-19, 1.60494162032269652e-36, 2.22730392507682967e-53 },  // 1/5!
+        { 1.38888888888888894e-03, -5.30054395437357706e-20, -1.73868675534958776e-36, -1.63335621172300840e-52 },  // 1/6!
+        { 1.98412698412698413e-04, 1.72095582934207053e-22, 1.49269123913941271e-40, 1.29470326746002471e-58 },  // 1/7!
+        { 2.48015873015873016e-05, 2.15119478667758816e-23, 1.86586404892426588e-41, 1.61837908432503088e-59 },  // 1/8!
+        { 2.75573192239858925e-06, -1.85839327404647208e-22, 8.49175460488199287e-39, -5.72661640789429621e-55 },  // 1/9!
+        { 2.75573192239858883e-07, 2.37677146222502973e-23, -3.26318890334088294e-40, 1.61435111860404415e-56 },  // 1/10!
+        { 2.50521083854417202e-08, -1.44881407093591197e-24, 2.04267351467144546e-41, -8.49632672007163175e-58 },  // 1/11!
+        { 2.08767569878681002e-09, -1.20734505911325997e-25, 1.70222792889287100e-42, 1.41609532150396700e-58 },  // 1/12!
+        { 1.60590438368216133e-10, 1.25852945887520981e-26, -5.31334602762985031e-43, 3.54021472597605528e-59 },  // 1/13!
+        { 1.14707455977297245e-11, 2.06555127528307454e-28, 6.88907923246664603e-45, 5.72920002655109095e-61 },  // 1/14!
+        { 7.64716373181981641e-13, 7.03872877733453001e-30, -7.82753927716258345e-48, 1.92138649443790242e-64 },  // 1/15!
+        { 4.77947733238738525e-14, 4.39920548583408126e-31, -4.89221204822661465e-49, 1.20086655902368901e-65 },  // 1/16!
+        { 2.81145725434552060e-15, 1.65088427308614326e-31, -2.87777179307447918e-50, 4.27110689256293549e-67 },  // 1/17!
+        { 1.56192069685862253e-16, 1.19106796602737540e-32, -4.57750605962998323e-49, 2.87494142340899603e-67 },  // 1/18!
+        { 8.22063524662432950e-18, 2.21418941196042654e-34, -1.50891402377419897e-50, 1.40072951514781548e-67 },  // 1/19!
+        { 4.11031762331216484e-19, 1.44129733786595271e-36, -5.28562754878981208e-53, -4.14764725635765685e-70 },  // 1/20!
+        { 1.95729410633912626e-20, -1.36435038300879085e-36, 1.33923482511250642e-53, -6.82108942414933122e-70 },  // 1/21!
+        { 8.89679139245057408e-22, -7.91140261487237622e-38, -3.18779767905709333e-54, 1.27057810175205662e-70 },  // 1/22!
+        { 3.86817017063068413e-23, -8.84317765548234385e-40, 3.87181571061732467e-56, -1.95652575315225570e-72 },  // 1/23!
+        { 1.61173757109611839e-24, -3.68465735645097660e-41, 1.61325654609055195e-57, -8.15219063813439928e-74 },  // 1/24!
+        { 6.44695028438447359e-26, -1.93304042337034648e-42, -1.52130238070391442e-58, 6.64377273721295753e-75 },  // 1/25!
+        { 2.47959626322479759e-27, -1.29537309647652288e-43, 6.40339015984996241e-60, -8.46024562770674585e-77 },  // 1/26!
+        { 9.18368986379554601e-29, 1.43031503967873220e-45, -8.55122677465050480e-62, 8.38146710023453832e-78 },  // 1/27!
+        { 3.27988923706983776e-30, 1.51175427440298787e-46, 8.05851771951971593e-63, -9.09648053071092885e-81 },  // 1/28!
+        { 1.13099628864477159e-31, 1.04980154129595060e-47, -4.34615092939779518e-64, -4.96677980014005581e-81 },  // 1/29!
+        { 3.76998762881590539e-33, 2.58703478327503238e-49, 3.23789002742563999e-66, 2.56128591057885727e-82 },  // 1/30!
+        { 1.21612504155351789e-34, 5.58629056788880577e-51, 6.61594857808279193e-68, -3.16204422895208591e-84 },  // 1/31!
+        { 3.80039075485474342e-36, 1.74571580246525180e-52, 2.06748393065087248e-69, -9.88138821547526846e-86 },  // 1/32!
+        { 1.15163356207719509e-37, -6.09957445788453978e-54, -5.34474961965941048e-70, 2.62531262385000815e-86 },  // 1/33!
+        { 3.38715753552116180e-39, 5.09056148151084995e-56, 3.98956734903634403e-72, -1.14951294479092623e-88 },  // 1/34!
+        { 9.67759295863189067e-41, 3.20229554864556196e-57, 6.54750720501810104e-74, -5.91334284153607619e-91 },  // 1/35!
+        { 2.68822026628663633e-42, 5.35506116594333401e-59, -1.12906019874498676e-75, -7.09714352853527274e-92 },  // 1/36!
+        { 7.26546017915307136e-44, -4.36409714935444569e-61, 2.55032501210183748e-77, 3.62259693228430960e-94 },  // 1/37!
+        { 1.91196320504028195e-45, -2.78608221768831261e-62, 2.03474372241013280e-78, -9.13939362246162657e-95 },  // 1/38!
+        { 4.90246975651354352e-47, -1.21301910051792795e-63, -4.47071800113765855e-80, 5.37597340717858998e-97 },  // 1/39!
+        { 1.22561743912838585e-48, 6.03392734831560539e-68, 4.07624961245823730e-84, -1.59820353307989972e-102 },  // 1/40!
+        { 2.98931082714240461e-50, -1.04072477030331555e-66, -1.37613197137759057e-83, -5.01838323088147032e-100 },  // 1/41!
+        { 7.11740673129143899e-52, 3.17420753842055730e-68, 1.24112898646225877e-84, -1.09918879326293741e-100 },  // 1/42!
+        { 1.65521086774219515e-53, 4.14710519049482419e-70, 4.32187417758181306e-88, 1.61954498080637494e-104 },  // 1/43!
+        { 3.76184288123226157e-55, 2.25971359112361835e-71, -1.45255187387709499e-87, -1.23159968713973769e-104 },  // 1/44!
+        { 8.35965084718280449e-57, -5.04027988508830642e-73, -1.97116512594399311e-89, -1.18661232656178291e-106 },  // 1/45!
+        { 1.81731540156147899e-58, 1.36506933987936603e-74, 2.54490150401424344e-91, -2.39064169520447011e-107 },  // 1/46!
+        { 3.86662851396059404e-60, -1.56435500578638898e-76, -1.28638554473548469e-92, -4.72409213107264703e-109 },  // 1/47!
+        { 8.05547607075123644e-62, 8.25581847807094913e-78, -2.67996988486559310e-94, -9.84185860640134798e-111 },  // 1/48!
+        { 1.64397470831657907e-63, -4.08088098184429381e-80, -3.32913139064192010e-96, 1.47073743046046679e-112 },  // 1/49!
+    };
+
+    class ddreal {
+    public:
+        double hi, lo;
+
+        //  Constructors
+        ddreal() : hi(0.0), lo(0.0) { }
+        ddreal(double h) : hi(h), lo(0.0) { }
+        ddreal(double h, double l) : hi(h), lo(l) { }
+
+        //  Machine epsilon: 2^-104
+        static double eps() { return 4.93038065763132e-32; }
+
+        //  Nearest double
+        double toDouble(void) const { return hi; }
+
+        //  Edit to a string with a printf-like "%w.pf" format
+        std::string toString(const char *format) const;
+
+        ddreal operator-() const { return ddreal(-hi, -lo); }
+
+        ddreal &operator+=(const ddreal &b);
+        ddreal &operator-=(const ddreal &b);
+        ddreal &operator*=(const ddreal &b);
+        ddreal &operator/=(const ddreal &b);
+    };
+
+    //  Arithmetic
+
+    inline ddreal operator+(const ddreal &a, const ddreal &b) {
+        double s1, s2, t1, t2;
+        s1 = two_sum(a.hi, b.hi, s2);
+        t1 = two_sum(a.lo, b.lo, t2);
+        s2 += t1;
+        s1 = quick_two_sum(s1, s2, s2);
+        s2 += t2;
+        s1 = quick_two_sum(s1, s2, s2);
+        return ddreal(s1, s2);
+    }
+
+    inline ddreal operator+(const ddreal &a, double b) {
+        double s1, s2;
+        s1 = two_sum(a.hi, b, s2);
+        s2 += a.lo;
+        s1 = quick_two_sum(s1, s2, s2);
+        return ddreal(s1, s2);
+    }
+
+    inline ddreal operator+(double a, const ddreal &b) {
+        return b + a;
+    }
+
+    inline ddreal operator-(const ddreal &a, const ddreal &b) {
+        double s1, s2, t1, t2;
+        s1 = two_diff(a.hi, b.hi, s2);
+        t1 = two_diff(a.lo, b.lo, t2);
+        s2 += t1;
+        s1 = quick_two_sum(s1, s2, s2);
+        s2 += t2;
+        s1 = quick_two_sum(s1, s2, s2);
+        return ddreal(s1, s2);
+    }
+
+    inline ddreal operator-(const ddreal &a, double b) {
+        double s1, s2;
+        s1 = two_diff(a.hi, b, s2);
+        s2 += a.lo;
+        s1 = quick_two_sum(s1, s2, s2);
+        return ddreal(s1, s2);
+    }
+
+    inline ddreal operator-(double a, const ddreal &b) {
+        double s1, s2;
+        s1 = two_diff(a, b.hi, s2);
+        s2 -= b.lo;
+        s1 = quick_two_sum(s1, s2, s2);
+        return ddreal(s1, s2);
+    }
+
+    inline ddreal operator*(const ddreal &a, const ddreal &b) {
+        double p1, p2;
+        p1 = two_prod(a.hi, b.hi, p2);
+        p2 += (a.hi * b.lo + a.lo * b.hi);
+        p1 = quick_two_sum(p1, p2, p2);
+        return ddreal(p1, p2);
+    }
+
+    inline ddreal operator*(const ddreal &a, double b) {
+        double p1, p2;
+        p1 = two_prod(a.hi, b, p2);
+        p2 += (a.lo * b);
+        p1 = quick_two_sum(p1, p2, p2);
+        return ddreal(p1, p2);
+    }
+
+    inline ddreal operator*(double a, const ddreal &b) {
+        return b * a;
+    }
+
+    inline ddreal sqr(const ddreal &a) {
+        double p1, p2;
+        p1 = two_sqr(a.hi, p2);
+        p2 += 2.0 * a.hi * a.lo;
+        p1 = quick_two_sum(p1, p2, p2);
+        return ddreal(p1, p2);
+    }
+
+    inline ddreal operator/(const ddreal &a, const ddreal &b) {
+        double q1, q2, q3;
+        ddreal r;
+
+        q1 = a.hi / b.hi;               // Approximate quotient
+        r = a - b * q1;
+        q2 = r.hi / b.hi;
+        r -= b * q2;
+        q3 = r.hi / b.hi;
+        q1 = quick_two_sum(q1, q2, q2);
+        return ddreal(q1, q2) + q3;
+    }
+
+    inline ddreal operator/(const ddreal &a, double b) {
+        double p1, p2, s, e;
+        ddreal q;
+
+        q.hi = a.hi / b;
+        p1 = two_prod(q.hi, b, p2);
+        s = two_diff(a.hi, p1, e);
+        e += a.lo;
+        e -= p2;
+        q.lo = (s + e) / b;
+        q.hi = quick_two_sum(q.hi, q.lo, q.lo);
+        return q;
+    }
+
+    inline ddreal operator/(double a, const ddreal &b) {
+        return ddreal(a) / b;
+    }
+
+    inline ddreal &ddreal::operator+=(const ddreal &b) {
+        return *this = *this + b;
+    }
+
+    inline ddreal &ddreal::operator-=(const ddreal &b) {
+        return *this = *this - b;
+    }
+
+    inline ddreal &ddreal::operator*=(const ddreal &b) {
+        return *this = *this * b;
+    }
+
+    inline ddreal &ddreal::operator/=(const ddreal &b) {
+        return *this = *this / b;
+    }
+
+    //  Comparison
+
+    inline bool operator==(const ddreal &a, const ddreal &b) {
+        return a.hi == b.hi && a.lo == b.lo;
+    }
+    inline bool operator==(const ddreal &a, double b) {
+        return a.hi == b && a.lo == 0.0;
+    }
+    inline bool operator!=(const ddreal &a, const ddreal &b) {
+        return !(a == b);
+    }
+    inline bool operator!=(const ddreal &a, double b) {
+        return !(a == b);
+    }
+    inline bool operator<(const ddreal &a, const ddreal &b) {
+        return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo);
+    }
+    inline bool operator<(const ddreal &a, double b) {
+        return a.hi < b || (a.hi == b && a.lo < 0.0);
+    }
+    inline bool operator>(const ddreal &a, const ddreal &b) {
+        return a.hi > b.hi || (a.hi == b.hi && a.lo > b.lo);
+    }
+    inline bool operator>(const ddreal &a, double b) {
+        return a.hi > b || (a.hi == b && a.lo > 0.0);
+    }
+    inline bool operator<=(const ddreal &a, const ddreal &b) {
+        return !(a > b);
+    }
+    inline bool operator<=(const ddreal &a, double b) {
+        return !(a > b);
+    }
+    inline bool operator>=(const ddreal &a, const ddreal &b) {
+        return !(a < b);
+    }
+    inline bool operator>=(const ddreal &a, double b) {
+        return !(a < b);
+    }
+
+    //  Mathematical functions
+
+    inline ddreal fabs(const ddreal &a) {
+        return (a.hi < 0.0) ? -a : a;
+    }
+
+    inline ddreal sqrt(const ddreal &a) {
+        /*  One Newton step on the double approximation of
+            1 / sqrt(a) (Karp and Markstein).  */
+        if (a.hi <= 0.0) {
+            return (a.hi == 0.0) ? ddreal(0.0) :
+                ddreal(std::numeric_limits<double>::quiet_NaN());
+        }
+        double x = 1.0 / std::sqrt(a.hi);
+        double ax = a.hi * x;
+        return ddreal(ax) + (a - sqr(ddreal(ax))).hi * (x * 0.5);
+    }
+
+    /*  Reduce a to r = a - j * (pi / 2) with |r| <= pi / 4,
+        returning r and the quadrant j modulo 4.  */
+    inline ddreal reduce_pi_2(const ddreal &a, int &j) {
+        double q = std::floor(a.hi / pi_2[0] + 0.5);
+        j = 0;
+        if (q == 0.0) {
+            return a;
+        }
+        j = ((int) std::fmod(q, 4.0) + 4) & 3;
+        return (a - ddreal(pi_2[0], pi_2[1]) * q) - pi_2[2] * q;
+    }
+
+    //  Sine by Taylor series, |a| <= pi / 4
+    inline ddreal sin_taylor(const ddreal &a) {
+        if (a.hi == 0.0) {
+            return a;
+        }
+        const double thresh = 0.5 * std::fabs(a.hi) * ddreal::eps();
+        const ddreal x2 = -sqr(a);
+        ddreal s = a, p = a, t;
+        int i = 0;
+        do {
+            p *= x2;
+            t = p * ddreal(inv_fact[i][0], inv_fact[i][1]);
+            s += t;
+            i += 2;
+        } while (i < n_inv_fact && std::fabs(t.hi) > thresh);
+        return s;
+    }
+
+    //  Cosine by Taylor series, |a| <= pi / 4
+    inline ddreal cos_taylor(const ddreal &a) {
+        if (a.hi == 0.0) {
+            return ddreal(1.0);
+        }
+        const double thresh = 0.5 * ddreal::eps();
+        const ddreal x2 = -sqr(a);
+        ddreal s = 1.0 + x2 * 0.5, p = x2, t;
+        int i = 1;
+        do {
+            p *= x2;
+            t = p * ddreal(inv_fact[i][0], inv_fact[i][1]);
+            s += t;
+            i += 2;
+        } while (i < n_inv_fact && std::fabs(t.hi) > thresh);
+        return s;
+    }
+
+    //  Sine and cosine together
+    inline void sincos(const ddreal &a, ddreal &sin_a, ddreal &cos_a) {
+        int j;
+        const ddreal r = reduce_pi_2(a, j);
+        const ddreal s = sin_taylor(r);
+        const ddreal c = sqrt(1.0 - sqr(s));    // cos(r) >= 1 / sqrt(2)
+
+        switch (j) {
+            case 0:     sin_a = s;      cos_a = c;      break;
+            case 1:     sin_a = c;      cos_a = -s;     break;
+            case 2:     sin_a = -s;     cos_a = -c;     break;
+            default:    sin_a = -c;     cos_a = s;      break;
+        }
+    }
+
+    inline ddreal sin(const ddreal &a) {
+        int j;
+        const ddreal r = reduce_pi_2(a, j);
+
+        switch (j) {
+            case 0:     return sin_taylor(r);
+            case 1:     return cos_taylor(r);
+            case 2:     return -sin_taylor(r);
+            default:    return -cos_taylor(r);
+        }
+    }
+
+    inline ddreal cos(const ddreal &a) {
+        int j;
+        const ddreal r = reduce_pi_2(a, j);
+
+        switch (j) {
+            case 0:     return cos_taylor(r);
+            case 1:     return -sin_taylor(r);
+            case 2:     return -cos_taylor(r);
+            default:    return sin_taylor(r);
+        }
+    }
+
+    inline ddreal tan(const ddreal &a) {
+        ddreal s, c;
+        sincos(a, s, c);
+        return s / c;
+    }
+
+    inline ddreal cot(const ddreal &a) {
+        ddreal s, c;
+        sincos(a, s, c);
+        return c / s;
+    }
+
+    inline ddreal asin(const ddreal &a) {
+        /*  Start from the double arc sine and take one Newton
+            step on sin(z) = a, which doubles the number of
+            correct bits.  */
+        const double aa = std::fabs(a.hi);
+        if (aa >= 1.0) {
+            if (fabs(a) == 1.0) {
+                return (a.hi > 0.0) ? ddreal(pi_2[0], pi_2[1]) :
+                                      -ddreal(pi_2[0], pi_2[1]);
+            }
+            return ddreal(std::numeric_limits<double>::quiet_NaN());
+        }
+        ddreal z = std::asin(a.hi), s, c;
+        sincos(z, s, c);
+        return z + (a - s) / c;
+    }
+
+    inline std::string ddreal::toString(const char *format) const {
+        int width, places;
+        realedit::parseFormat(format, width, places);
+        return realedit::edit(*this, width, places);
+    }
+
+    inline std::ostream &operator<<(std::ostream &os, const ddreal &a) {
+        return os << a.toString("%16.11f");
+    }
+}
+
+#endif
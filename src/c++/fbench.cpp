@@ -29,6 +29,57 @@
 #include <cmath>
 #include <cstring>
 #include <cstdlib>
+#include <chrono>
+#include <ctime>
+#include <vector>
+#include <limits>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+#ifdef __linux__
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+#include "intrig.h"
+#include "taskpool.h"
+#include "timestats.h"
+#include "perfcount.h"
+#include "results.h"
+
+    /*  Phase timers, compiled in only when PHASE_TIMERS is defined,
+        so the benchmark itself is unchanged.  PHASE(p) times the
+        rest of the enclosing block as phase p.  The FLOAT_COUNTED
+        build uses the same scopes to tally the operations of each
+        phase.  */
+#if PHASE_TIMERS
+#   if FLOAT_COUNTED
+#       error "PHASE_TIMERS cannot be used with FLOAT_COUNTED, which uses the phases to count"
+#   endif
+#include "phasetimer.h"
+#   define PHASE(p)     phasetimer::Scope phaseScope(phasetimer::p)
+#elif FLOAT_COUNTED
+#include "opcount.h"
+#   define PHASE(p)     opcount::Scope phaseScope(phasetimer::p)
+#else
+#   define PHASE(p)
+#endif
+
+    /*  The FLOAT_SHADOW build attributes the error of each operation
+        to the ray and surface being traced, which SHADOW_RAY(i) and
+        SHADOW_SURFACE(n, od, sa) set for the rest of the enclosing
+        block; the latter then measures the error of the object
+        distance od and slope angle sa leaving surface n.  */
+#if FLOAT_SHADOW
+#   define SHADOW_RAY(i)                shadow::RayScope shadowRay(i)
+#   define SHADOW_SURFACE(n, od, sa)    shadow::SurfaceScope<Real> shadowSurface(n, od, sa)
+#else
+#   define SHADOW_RAY(i)
+#   define SHADOW_SURFACE(n, od, sa)
+#endif
 
     using namespace std;
 
@@ -43,9 +94,25 @@
         symbols to be 1.
             (none)          C++ "double"
             LONG_DOUBLE     C++ "long double"
-            FLOAT128        GCC's 128 bit floating point type
+            FLOAT128        GCC's 128 bit floating point type:
+                            QUAD_TRIG defaults to fast trigonometric functions
             FLOAT_MPFR      MPFR multiple-precision package:
                             MPFR_PRECISION sets mantissa precision in bits
+            FLOAT_DD        Double-double (106 bit) software arithmetic
+            FLOAT_QD        Quad-double (212 bit) software arithmetic
+            FLOAT_MPN       Fixed precision on the GMP mpn layer:
+                            MPN_LIMBS sets mantissa size in 64 bit limbs
+            FLOAT_COUNTED   C++ "double", counting every operation
+                            (see opcount.h)
+            FLOAT_SHADOW    C++ "double", measuring the error of every
+                            operation against a quad-double shadow
+                            (see shadow.h)
+        The trigonometric functions may be selected when the
+        program is run with the -trig option (see TrigBackend
+        below).  Independently of the type, defining INTRIG to be
+        1 makes the default the internal functions in intrig.h,
+        which are computed with the type's arithmetic operators,
+        as in the C version.
         Note that the meaning of these symbols is dependent upon
         the compiler and the architecture on which it is running.
         With GCC 4.10.0 on an X86_64 machine, all precisions
@@ -54,10 +121,14 @@
 #if FLOAT128
 #include <quadmath.h>
     typedef __float128 Real;
+#include "quadtrig.h"
+#   define Uses_minimax
+#include "minimax.h"                //  Before the macros below
 #define sin(x)  sinq(x)
 #define asin(x) asinq(x)
 #define cos(x)  cosq(x)
 #define tan(x)  tanq(x)
+#define sqrt(x) sqrtq(x)
     //  Implement printing __float128 for debug output
     ostream& operator<<(ostream &os, Real t) {
         char s[80];
@@ -76,15 +147,73 @@
     using namespace mpfr;
     typedef mpreal Real;
 #   define Provides_cot
+#   define Real_Is_Class
+#   define Uses_GMP
 #   ifndef MPFR_PRECISION
 #       define MPFR_PRECISION 128
 #   endif
+#elif FLOAT_DD
+#include "ddreal.h"
+    using namespace ddqd;
+    typedef ddreal Real;
+#   define Provides_cot
+#   define Real_Is_Class
+#   define Uses_minimax
+#elif FLOAT_QD
+#include "qdreal.h"
+    using namespace ddqd;
+    typedef qdreal Real;
+#   define Provides_cot
+#   define Real_Is_Class
+#elif FLOAT_MPN
+#include "mpnreal.h"
+#   ifndef MPN_LIMBS
+#       define MPN_LIMBS 2
+#   endif
+    typedef fixedmp::mpnreal<MPN_LIMBS> Real;
+#   define Provides_cot
+#   define Real_Is_Class
+#   define Uses_GMP
+#elif FLOAT_COUNTED
+    typedef opcount::Counted<double> Real;
+#   define Provides_cot
+#   define Real_Is_Class
+#elif FLOAT_SHADOW
+#include "qdreal.h"
+#include "shadow.h"
+    typedef shadow::Shadowed<ddqd::qdreal> Real;
+#   define Provides_cot
+#   define Real_Is_Class
 #elif LONG_DOUBLE
     typedef long double Real;
 #   define RealFormat "Lf"
+#   define Uses_tabletrig
+#   define Uses_minimax
 #else
     typedef double Real;
 #   define RealFormat "f"
+#   define Uses_tabletrig
+#   define Uses_minimax
+#   if defined(__x86_64__) && defined(__linux__)
+#       define Uses_libmvec
+#   endif
+#endif
+
+#ifdef Uses_tabletrig
+#include "tabletrig.h"
+#endif
+
+#ifdef Uses_minimax
+#include "minimax.h"
+#endif
+
+#ifdef Uses_libmvec
+#include <dlfcn.h>
+#include <emmintrin.h>
+#endif
+
+#ifdef Uses_GMP
+#include "mppool.h"
 #endif
 
 #ifndef Provides_cot
@@ -92,6 +221,188 @@
 #   define cot(x) (1.0 / tan(x))
 #endif
 
+    /*  Trigonometric function backends
+
+        The ray tracer calls sin, asin, cos, cot, and sqrt through
+        the TrigBackend trig, which main() chooses by name from
+        those returned by trigBackends(), so one program can
+        compare the functions available for its type without
+        being rebuilt.  "library" is the type's own functions,
+        and "intrig" the functions in intrig.h, computed with the
+        type's arithmetic alone.  The double and long double
+        builds add "table", the table-driven functions of
+        tabletrig.h, and these and the __float128 and
+        double-double builds add "minimax", the kernels of
+        minimax.h with polynomials generated for the type.  A new
+        backend needs only functions with the TrigFunction
+        signature and an entry in trigBackends().
+
+        The MPFR_SCRATCH build calls MPFR's functions directly in
+        transitSurface(), so it offers only the library.  So does
+        the FLOAT_SHADOW build, in which the shadow of the intrig.h
+        functions would follow the approximations made for the
+        double, rather than computing the functions themselves.  */
+
+#if INTRIG
+#   if FLOAT_MPFR && MPFR_SCRATCH
+#       error "INTRIG cannot be used with MPFR_SCRATCH, which calls MPFR's functions directly"
+#   endif
+#   define DefaultTrig  "intrig"
+#elif FLOAT128 && QUAD_TRIG
+#   define DefaultTrig  "quadtrig"
+#else
+#   define DefaultTrig  "library"
+#endif
+
+    typedef Real (*TrigFunction)(const Real &);
+
+    struct TrigBackend {
+        const char *name;
+        const char *description;
+        TrigFunction sin, asin, cos, cot, sqrt;
+        int bits;                   // Precision of the functions if less than the type's
+    };
+
+    //  The type's own functions
+    static Real librarySin(const Real &x) { return sin(x); }
+    static Real libraryAsin(const Real &x) { return asin(x); }
+    static Real libraryCos(const Real &x) { return cos(x); }
+    static Real libraryCot(const Real &x) { return cot(x); }
+    static Real librarySqrt(const Real &x) { return sqrt(x); }
+
+#if FLOAT128
+    //  The fast __float128 functions in quadtrig.h
+    static Real quadtrigSin(const Real &x) { return (quadtrig::sin)(x); }
+    static Real quadtrigAsin(const Real &x) { return (quadtrig::asin)(x); }
+    static Real quadtrigCos(const Real &x) { return (quadtrig::cos)(x); }
+    static Real quadtrigCot(const Real &x) { return (quadtrig::cot)(x); }
+#endif
+
+#ifdef Uses_tabletrig
+    //  The table-driven functions in tabletrig.h
+    static Real tableSin(const Real &x) { return (tabletrig::sin)(x); }
+    static Real tableAsin(const Real &x) { return (tabletrig::asin)(x); }
+    static Real tableCos(const Real &x) { return (tabletrig::cos)(x); }
+    static Real tableCot(const Real &x) { return (tabletrig::cot)(x); }
+#endif
+
+#ifdef Uses_minimax
+    //  The generated minimax polynomials in minimax.h
+    static Real minimaxSin(const Real &x) { return (minimax::sin)(x); }
+    static Real minimaxAsin(const Real &x) { return (minimax::asin)(x); }
+    static Real minimaxCos(const Real &x) { return (minimax::cos)(x); }
+    static Real minimaxCot(const Real &x) { return (minimax::cot)(x); }
+#endif
+
+#ifdef Uses_libmvec
+    /*  The vector functions in glibc's libmvec, which the
+        compiler calls when it vectorises loops containing the
+        scalar functions.  We call the two lane SSE2 versions
+        with the argument in both lanes.  They are looked up when
+        the program starts, so the program runs on systems whose
+        glibc lacks them (asin and tan arrived in 2.35).  */
+
+    namespace libmvec {
+        typedef __m128d (*VectorFunction)(__m128d);
+
+        VectorFunction vsin, vasin, vcos, vtan;
+
+        bool load(void) {
+            void *h = dlopen("libmvec.so.1", RTLD_NOW);
+            if (h == NULL) {
+                return false;
+            }
+            vsin = (VectorFunction) dlsym(h, "_ZGVbN2v_sin");
+            vasin = (VectorFunction) dlsym(h, "_ZGVbN2v_asin");
+            vcos = (VectorFunction) dlsym(h, "_ZGVbN2v_cos");
+            vtan = (VectorFunction) dlsym(h, "_ZGVbN2v_tan");
+            return vsin != NULL && vasin != NULL && vcos != NULL && vtan != NULL;
+        }
+    }
+
+    static Real mvecSin(const Real &x) { return _mm_cvtsd_f64(libmvec::vsin(_mm_set1_pd(x))); }
+    static Real mvecAsin(const Real &x) { return _mm_cvtsd_f64(libmvec::vasin(_mm_set1_pd(x))); }
+    static Real mvecCos(const Real &x) { return _mm_cvtsd_f64(libmvec::vcos(_mm_set1_pd(x))); }
+    static Real mvecCot(const Real &x) { return 1.0 / _mm_cvtsd_f64(libmvec::vtan(_mm_set1_pd(x))); }
+#endif
+
+    //  Backends available in this build
+    static vector<TrigBackend> trigBackends(void) {
+        vector<TrigBackend> b;
+
+        b.push_back({ "library",
+#if FLOAT128
+            "libquadmath",
+#elif FLOAT_MPFR
+            "MPFR",
+#elif FLOAT_DD
+            "ddreal.h",
+#elif FLOAT_QD
+            "qdreal.h",
+#elif FLOAT_MPN
+            "mpnreal.h",
+#elif FLOAT_COUNTED
+            "C library <cmath>, counted",
+#elif FLOAT_SHADOW
+            "C library <cmath>, shadowed by qdreal.h",
+#else
+            "C library <cmath>",
+#endif
+            librarySin, libraryAsin, libraryCos, libraryCot, librarySqrt, 0 });
+#if !(FLOAT_MPFR && MPFR_SCRATCH) && !FLOAT_SHADOW
+        typedef intrig::Math<Real> IntrigMath;
+        b.push_back({ "intrig", "Internal functions in intrig.h",
+            IntrigMath::sin, IntrigMath::asin, IntrigMath::cos, IntrigMath::cot,
+            IntrigMath::sqrt, 53 });
+#endif
+#if FLOAT128
+        b.push_back({ "quadtrig", "Fast __float128 functions in quadtrig.h",
+            quadtrigSin, quadtrigAsin, quadtrigCos, quadtrigCot, librarySqrt, 0 });
+#endif
+#ifdef Uses_tabletrig
+        b.push_back({ "table", "Table-driven functions in tabletrig.h",
+            tableSin, tableAsin, tableCos, tableCot, librarySqrt, 0 });
+#endif
+#ifdef Uses_minimax
+        b.push_back({ "minimax", "Generated minimax polynomials in minimax.h",
+            minimaxSin, minimaxAsin, minimaxCos, minimaxCot, librarySqrt, 0 });
+#endif
+#ifdef Uses_libmvec
+        if (libmvec::load()) {
+            b.push_back({ "libmvec", "glibc libmvec SSE2 vector functions",
+                mvecSin, mvecAsin, mvecCos, mvecCot, librarySqrt, 53 });
+        }
+#endif
+        return b;
+    }
+
+    //  Find a backend by name, returning false if there's none
+    static bool findTrig(const char *name, TrigBackend &t) {
+        const vector<TrigBackend> b = trigBackends();
+        for (unsigned int i = 0; i < b.size(); i++) {
+            if (strcmp(b[i].name, name) == 0) {
+                t = b[i];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //  The functions used by the ray tracer
+    static TrigBackend trig;
+
+#undef sin
+#undef asin
+#undef cos
+#undef tan
+#undef cot
+#undef sqrt
+#define sin(x)  trig.sin(x)
+#define asin(x) trig.asin(x)
+#define cos(x)  trig.cos(x)
+#define cot(x)  trig.cot(x)
+#define sqrt(x) trig.sqrt(x)
+
     /*  Wavelengths of standard spectral lines in Angstroms
               (Not all are used in this program)  */
 
@@ -99,8 +410,8 @@
 
     class SpectralLine {
     public:
-#if !FLOAT_MPFR
-        const static Wavelength A = 7621.0,
+#ifndef Real_Is_Class
+        constexpr static Wavelength A = 7621.0,
                                 B = 6869.955,
                                 C = 6562.816,
                                 D = 5895.944,
@@ -109,11 +420,12 @@
                                 Gprime = 4340.477,
                                 H = 3968.494;
 #else
-        //  MPFR doesn't allow us to initialise these in the class
+        /*  MPFR and the other class types don't allow us to
+            initialise these in the class  */
         static Wavelength A, B, C, D, E, F, Gprime, H;
 #endif
     };
-#if FLOAT_MPFR
+#ifdef Real_Is_Class
     Wavelength SpectralLine::A = 7621.0,
                SpectralLine::B = 6869.955,
                SpectralLine::C = 6562.816,
@@ -151,6 +463,16 @@
         }
     };
 
+    /*  The prescription of a surface, as constants known when the
+        program is compiled, for FixedDesign below.  */
+
+    struct SurfacePrescription {
+        double curvature_Radius,
+               index_Of_Refraction,
+               dispersion,
+               edge_Thickness;
+    };
+
     /*  A Design is the specification of the optical assembly
         to be evaluated.  */
 
@@ -205,8 +527,12 @@
 
     enum AxialIncidence { Marginal_Ray, Paraxial_Ray };
 
+    template <const SurfacePrescription &... S> class FixedDesign;
+
     class TraceContext {
     private:
+        template <const SurfacePrescription &... S> friend class FixedDesign;
+
         Design *d;
         AxialIncidence axial_incidence;
         Wavelength line;
@@ -218,17 +544,67 @@
              from_index,
              to_index;
 
+        //  Sine and cosine of axis_slope_angle, for transitSurfaceReduced()
+        Real sin_axis_slope_angle,
+             cos_axis_slope_angle;
+
         /*  Transit a surface.  Returns true if this was the last
             surface in the design.  */
         bool transitSurface(void);
 
+        //  Transit a surface with fewer trigonometric functions
+        bool transitSurfaceReduced(void);
+
+#if FLOAT_MPFR && MPFR_SCRATCH
+        /*  Scratch registers for transitSurface().  Evaluating its
+            expressions with mpreal operators creates a temporary,
+            with its mantissa allocated on the heap, for every
+            intermediate result.  Instead, we evaluate them with
+            in-place mpfr_* calls into these registers, allocated
+            once when the TraceContext is created.  */
+        enum {
+            sT0, sT1,                   // Intermediate results
+            sAsaPrime,                  // asaprime
+            sIangSin, sIang,            // iangsin, iang
+            sRangSin, sRang,            // rangsin, rang
+            sAsaDoublePrime,            // asadoubleprime
+            sSagitta,                   // sagitta
+            nScratch
+        };
+        mpfr_t scratch[nScratch];
+
+        //  A TraceContext owns its registers and may not be copied
+        TraceContext(const TraceContext &);
+        TraceContext &operator=(const TraceContext &);
+#endif
+
     public:
+        //  Trace with transitSurfaceReduced()?
+        static bool reduced;
+
+        /*  If not NULL, trace with this function, generated by
+            FixedDesign for a design known when the program is
+            compiled, instead of transitSurface().  */
+        static void (*fixed)(TraceContext &tc);
 
         //  Constructor
         TraceContext(Design &des, Wavelength w, AxialIncidence ai) {
+#if FLOAT_MPFR && MPFR_SCRATCH
+            for (int i = 0; i < nScratch; i++) {
+                mpfr_init2(scratch[i], mpreal::get_default_prec());
+            }
+#endif
             set(des, w, ai);
         }
 
+#if FLOAT_MPFR && MPFR_SCRATCH
+        ~TraceContext() {
+            for (int i = 0; i < nScratch; i++) {
+                mpfr_clear(scratch[i]);
+            }
+        }
+#endif
+
         //  Reset a TraceContext to new values as by the constructor
         void set(Design &des, Wavelength w, AxialIncidence ai) {
             d = &des;
@@ -239,6 +615,8 @@
                 axis_slope_angle = to_index = 0;
             ray_height = d->clearAperture / 2;
             from_index = 1;
+            sin_axis_slope_angle = 0;
+            cos_axis_slope_angle = 1;
         }
 
         //  Trace a spectral line through the design
@@ -305,7 +683,10 @@
     */
 
 
+#if !(FLOAT_MPFR && MPFR_SCRATCH)
     bool TraceContext::transitSurface(void) {
+        PHASE(Transit);
+        SHADOW_SURFACE(cSurf + 1, object_distance, axis_slope_angle);
 
         //  Set context variables from current surface
 
@@ -325,6 +706,7 @@
 
                 //  Curved surface
 
+                PHASE(ParaxialCurved);
                 const bool odz = object_distance == 0;
                 const Real asaprime = odz ? 0 : axis_slope_angle;
                 const Real iangsin = odz ? ray_height / radius_of_curvature :
@@ -344,6 +726,7 @@
 
                 //  Flat surface
 
+                PHASE(ParaxialFlat);
                 object_distance = object_distance * (to_index / from_index);
                 axis_slope_angle = axis_slope_angle * (from_index / to_index);
             }
@@ -355,6 +738,7 @@
 
                 //  Curved surface
 
+                PHASE(MarginalCurved);
                 const bool odz = object_distance == 0;
                 const Real asaprime = odz ? 0 : axis_slope_angle;
                 const Real iangsin = odz ? ray_height / radius_of_curvature :
@@ -379,6 +763,7 @@
 
                 //  Flat surface
 
+                PHASE(MarginalFlat);
                 const Real rang = -(asin((from_index / to_index))) *
                               sin(axis_slope_angle);
 
@@ -395,34 +780,631 @@
 
         return cSurf >= d->nSurfaces;
     }
+#endif
+
+#if FLOAT_MPFR && MPFR_SCRATCH
+    /*  This is the same computation as the general transitSurface()
+        above, written as a sequence of in-place MPFR operations on
+        the members of the TraceContext and its scratch registers,
+        so no mpreal temporaries are created.  Operations are
+        performed in the same order as in the expressions above, but
+        every intermediate result is rounded to the working
+        precision, while mpreal rounds each to the larger precision
+        of its operands.  */
+
+#   define P(x) ((x).mpfr_ptr())
+#   define S(x) ((x).mpfr_srcptr())
+#   define RN   MPFR_RNDN
+
+    bool TraceContext::transitSurface(void) {
+        PHASE(Transit);
+        const Surface *s = d->surf[cSurf];
+        mpfr_ptr roc = P(radius_of_curvature),
+                 od = P(object_distance),
+                 rh = P(ray_height),
+                 asa = P(axis_slope_angle),
+                 fi = P(from_index),
+                 ti = P(to_index);
+        mpfr_ptr t0 = scratch[sT0],
+                 t1 = scratch[sT1],
+                 asaprime = scratch[sAsaPrime],
+                 iangsin = scratch[sIangSin],
+                 iang = scratch[sIang],
+                 rangsin = scratch[sRangSin],
+                 rang = scratch[sRang],
+                 asadoubleprime = scratch[sAsaDoublePrime],
+                 sagitta = scratch[sSagitta];
+
+        //  Set context variables from current surface
+
+        mpfr_set(roc, S(s->curvature_Radius), RN);
+        mpfr_set(ti, S(s->index_Of_Refraction), RN);
+        if (mpfr_cmp_ui(ti, 1) > 0) {
+            mpfr_sub(t0, S(SpectralLine::D), S(line), RN);
+            mpfr_sub(t1, S(SpectralLine::C), S(SpectralLine::F), RN);
+            mpfr_div(t0, t0, t1, RN);
+            mpfr_sub_ui(t1, S(s->index_Of_Refraction), 1, RN);
+            mpfr_div(t1, t1, S(s->dispersion), RN);
+            mpfr_mul(t0, t0, t1, RN);
+            mpfr_add(ti, ti, t0, RN);
+        }
+
+        if (axial_incidence == Paraxial_Ray) {
+
+            //  Paraxial ray
+
+            if (!mpfr_zero_p(roc)) {
+
+                //  Curved surface
+
+                PHASE(ParaxialCurved);
+                const bool odz = mpfr_zero_p(od);
+                if (odz) {
+                    mpfr_set_zero(asaprime, 1);
+                    mpfr_div(iangsin, rh, roc, RN);
+                } else {
+                    mpfr_set(asaprime, asa, RN);
+                    mpfr_sub(iangsin, od, roc, RN);
+                    mpfr_div(iangsin, iangsin, roc, RN);
+                    mpfr_mul(iangsin, iangsin, asa, RN);
+                }
+                mpfr_div(rangsin, fi, ti, RN);
+                mpfr_mul(rangsin, rangsin, iangsin, RN);
+                mpfr_add(asadoubleprime, asaprime, iangsin, RN);
+                mpfr_sub(asadoubleprime, asadoubleprime, rangsin, RN);
+                if (!odz) {
+                    mpfr_mul(rh, od, asaprime, RN);
+                }
+                mpfr_div(od, rh, asadoubleprime, RN);
+                mpfr_set(asa, asadoubleprime, RN);
+
+            } else {
+
+                //  Flat surface
+
+                PHASE(ParaxialFlat);
+                mpfr_div(t0, ti, fi, RN);
+                mpfr_mul(od, od, t0, RN);
+                mpfr_div(t0, fi, ti, RN);
+                mpfr_mul(asa, asa, t0, RN);
+            }
+         } else {
+
+            //  Marginal ray
+
+            if (!mpfr_zero_p(roc)) {
+
+                //  Curved surface
+
+                PHASE(MarginalCurved);
+                const bool odz = mpfr_zero_p(od);
+                if (odz) {
+                    mpfr_set_zero(asaprime, 1);
+                    mpfr_div(iangsin, rh, roc, RN);
+                } else {
+                    mpfr_set(asaprime, asa, RN);
+                    mpfr_sub(iangsin, od, roc, RN);
+                    mpfr_div(iangsin, iangsin, roc, RN);
+                    mpfr_sin(t0, asa, RN);
+                    mpfr_mul(iangsin, iangsin, t0, RN);
+                }
+                mpfr_asin(iang, iangsin, RN);
+                mpfr_div(rangsin, fi, ti, RN);
+                mpfr_mul(rangsin, rangsin, iangsin, RN);
+                mpfr_add(asadoubleprime, asaprime, iang, RN);
+                mpfr_asin(t0, rangsin, RN);
+                mpfr_sub(asadoubleprime, asadoubleprime, t0, RN);
+                mpfr_add(t1, asaprime, iang, RN);           // asaprime + iang
+                mpfr_div_ui(t0, t1, 2, RN);
+                mpfr_sin(t0, t0, RN);                       // sinasaiang
+                mpfr_mul_ui(sagitta, roc, 2, RN);
+                mpfr_mul(sagitta, sagitta, t0, RN);
+                mpfr_mul(sagitta, sagitta, t0, RN);
+                if (!odz) {
+                    mpfr_mul(rh, od, asaprime, RN);
+                }
+                mpfr_sin(t1, t1, RN);
+                mpfr_mul(t1, roc, t1, RN);
+                mpfr_cot(t0, asadoubleprime, RN);
+                mpfr_mul(t1, t1, t0, RN);
+                mpfr_add(od, t1, sagitta, RN);
+                mpfr_set(asa, asadoubleprime, RN);
+
+            } else {
+
+                //  Flat surface
+
+                PHASE(MarginalFlat);
+                mpfr_div(t0, fi, ti, RN);
+                mpfr_asin(t0, t0, RN);
+                mpfr_neg(t0, t0, RN);
+                mpfr_sin(t1, asa, RN);
+                mpfr_mul(rang, t0, t1, RN);
+
+                mpfr_neg(t0, rang, RN);
+                mpfr_cos(t0, t0, RN);
+                mpfr_mul(t0, ti, t0, RN);
+                mpfr_cos(t1, asa, RN);
+                mpfr_mul(t1, fi, t1, RN);
+                mpfr_div(t0, t0, t1, RN);
+                mpfr_mul(od, od, t0, RN);
+                mpfr_neg(asa, rang, RN);
+            }
+        }
+
+        mpfr_set(fi, ti, RN);
+        mpfr_sub(od, od, S(s->edge_Thickness), RN);
+        cSurf++;
+
+        return cSurf >= d->nSurfaces;
+    }
+
+#   undef P
+#   undef S
+#   undef RN
+#endif
+
+    bool TraceContext::reduced = false;
+    void (*TraceContext::fixed)(TraceContext &tc) = NULL;
+
+    /*  Transit a surface, as transitSurface() does, with fewer
+        calls on the trigonometric functions.  The sine and
+        cosine of the axis slope angle are carried from one
+        surface to the next, and those of the angles computed
+        from it are found with the sum identities from the sines
+        and cosines of their parts.  The sines of the angles of
+        incidence and refraction, iangsin and rangsin, are known
+        before their arc sines are taken, and their cosines are
+        the square roots of one less their squares.  A marginal
+        ray crossing a curved surface then costs two arc sines
+        and two square roots, where transitSurface() calls four
+        sines, two arc sines, and a cotangent.
+
+        The sagitta, 2 r sin^2(theta / 2), is computed from the
+        identity 2 sin^2(theta / 2) = sin^2(theta) / (1 + cos(theta)),
+        which, unlike 1 - cos(theta), suffers no cancellation for
+        small theta.
+
+        Paraxial rays involve no trigonometry and are traced by
+        transitSurface().  */
+
+    bool TraceContext::transitSurfaceReduced(void) {
+
+        if (axial_incidence == Paraxial_Ray) {
+            return transitSurface();
+        }
+        PHASE(Transit);
+        SHADOW_SURFACE(cSurf + 1, object_distance, axis_slope_angle);
+
+        //  Set context variables from current surface
+
+        radius_of_curvature = d->surf[cSurf]->curvature_Radius;
+        to_index = d->surf[cSurf]->index_Of_Refraction;
+        if (to_index > 1) {
+            to_index += ((SpectralLine::D - line) /
+                (SpectralLine::C - SpectralLine::F)) *
+                ((d->surf[cSurf]->index_Of_Refraction - 1) / d->surf[cSurf]->dispersion);
+        }
+
+        if (radius_of_curvature != 0) {
+
+            //  Curved surface
+
+            PHASE(MarginalCurved);
+            const bool odz = object_distance == 0;
+            const Real asaprime = odz ? 0 : axis_slope_angle;
+            const Real sinasaprime = odz ? 0 : sin_axis_slope_angle;
+            const Real cosasaprime = odz ? 1 : cos_axis_slope_angle;
+            const Real iangsin = odz ? ray_height / radius_of_curvature :
+                            ((object_distance - radius_of_curvature) /
+                             radius_of_curvature) * sin_axis_slope_angle;
+            const Real iangcos = sqrt(1 - iangsin * iangsin);
+            const Real iang = asin(iangsin);
+            const Real rangsin = (from_index / to_index) * iangsin;
+            const Real rangcos = sqrt(1 - rangsin * rangsin);
+            const Real asadoubleprime = asaprime + iang - asin(rangsin);
+
+            //  theta = asaprime + iang
+            const Real sintheta = sinasaprime * iangcos + cosasaprime * iangsin;
+            const Real costheta = cosasaprime * iangcos - sinasaprime * iangsin;
+            const Real sagitta = (radius_of_curvature * sintheta * sintheta) /
+                                 (1 + costheta);
+
+            //  asadoubleprime = theta - rang
+            const Real sinasadoubleprime = sintheta * rangcos - costheta * rangsin;
+            const Real cosasadoubleprime = costheta * rangcos + sintheta * rangsin;
+
+            const Real rayheightprime = odz ? ray_height :
+                                    object_distance * asaprime;
+            const Real objectdistanceprime = ((radius_of_curvature *
+                                      sintheta) *
+                                      (cosasadoubleprime / sinasadoubleprime)) + sagitta;
+
+            object_distance = objectdistanceprime;
+            ray_height = rayheightprime;
+            axis_slope_angle = asadoubleprime;
+            sin_axis_slope_angle = sinasadoubleprime;
+            cos_axis_slope_angle = cosasadoubleprime;
+
+        } else {
+
+            //  Flat surface
+
+            PHASE(MarginalFlat);
+            const Real rang = -(asin((from_index / to_index))) *
+                          sin_axis_slope_angle;
+            const Real cosrang = cos(rang);
+
+            object_distance = object_distance * ((to_index *
+                        cosrang) / (from_index *
+                        cos_axis_slope_angle));
+            axis_slope_angle = -rang;
+            sin_axis_slope_angle = sin(axis_slope_angle);
+            cos_axis_slope_angle = cosrang;
+        }
+
+        from_index = to_index;
+        object_distance -= d->surf[cSurf]->edge_Thickness;
+        cSurf++;
+
+        return cSurf >= d->nSurfaces;
+    }
 
     void TraceContext::traceLine(Real &od, Real &sa) {
-        do {
-        } while (!transitSurface());
+        PHASE(TraceLine);
+        if (fixed != NULL) {
+            fixed(*this);
+        } else {
+            do {
+            } while (!(reduced ? transitSurfaceReduced() : transitSurface()));
+        }
         od = object_distance;
         sa = axis_slope_angle;
     }
 
     void TraceContext::traceLine(Real &od) {
-        do {
-        } while (!transitSurface());
+        PHASE(TraceLine);
+        if (fixed != NULL) {
+            fixed(*this);
+        } else {
+            do {
+            } while (!(reduced ? transitSurfaceReduced() : transitSurface()));
+        }
         od = object_distance;
     }
 
+    /*  A FixedDesign traces rays through a design whose surfaces
+        are known when the program is compiled, given as a list of
+        SurfacePrescriptions.  Its trace() does what the loop on
+        transitSurface() in traceLine() does, with the same
+        expressions evaluated in the same order, but the loop is
+        unrolled by recursion on the list of surfaces, and every
+        test which depends only upon the design is made by the
+        compiler: whether the ray is paraxial (tested once per
+        trace rather than once per surface), whether each surface
+        is curved or flat, whether its medium disperses, and
+        whether the incoming ray is parallel to the axis (the
+        "odz" case, object_distance == 0).  The last holds for the
+        first surface, which the ray enters from infinity, and for
+        each one after a flat surface of zero thickness that the
+        ray entered parallel to the axis; transitSurface() would
+        differ only if a computed object distance happened to be
+        exactly zero.  Only the wavelength and incidence of the
+        ray, and the clear aperture, which sets the initial ray
+        height, vary at run time.
+
+        The results are identical to those of transitSurface().  */
+
+    /*  The constants of a surface as Reals.  The class types
+        convert a double operand on every operation in which it
+        appears, so for them each is converted once, when first
+        used.  */
+
+    template <const SurfacePrescription &P> struct SurfaceReals {
+        Real curvature_Radius, index_Less_One, dispersion, edge_Thickness;
+
+        SurfaceReals(void) : curvature_Radius(P.curvature_Radius),
+            index_Less_One(Real(P.index_Of_Refraction) - 1),
+            dispersion(P.dispersion), edge_Thickness(P.edge_Thickness) {
+        }
+
+        static const SurfaceReals &get(void) {
+            static const SurfaceReals r;
+            return r;
+        }
+    };
+
+    template <const SurfacePrescription &... S> class FixedDesign {
+    public:
+        static const unsigned int nSurfaces = sizeof...(S);
+
+        //  Does the run-time design d have these surfaces?
+        static bool matches(const Design &d) {
+            const SurfacePrescription *p[] = { &S... };
+            if (d.nSurfaces != nSurfaces) {
+                return false;
+            }
+            for (unsigned int i = 0; i < nSurfaces; i++) {
+                const Surface &s = *d.surf[i];
+                if (s.curvature_Radius != p[i]->curvature_Radius ||
+                    s.index_Of_Refraction != p[i]->index_Of_Refraction ||
+                    s.dispersion != p[i]->dispersion ||
+                    s.edge_Thickness != p[i]->edge_Thickness) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //  Trace the ray set up in tc through the design
+        static void trace(TraceContext &tc) {
+            if (tc.axial_incidence == Paraxial_Ray) {
+                transit<Paraxial_Ray, true, S...>(tc);
+            } else {
+                transit<Marginal_Ray, true, S...>(tc);
+            }
+            tc.cSurf = nSurfaces;
+        }
+
+    private:
+        //  After the last surface
+        template <AxialIncidence AI, bool Parallel> static void transit(TraceContext &) {
+        }
+
+        /*  Transit surface P, then the Rest.  Parallel is true if
+            the incoming ray is parallel to the axis.  */
+        template <AxialIncidence AI, bool Parallel, const SurfacePrescription &P,
+                  const SurfacePrescription &... Rest>
+        static void transit(TraceContext &tc) {
+#ifdef Real_Is_Class
+            const SurfaceReals<P> &surf = SurfaceReals<P>::get();
+            const Real &radius_of_curvature = surf.curvature_Radius;
+#else
+            constexpr Real radius_of_curvature = P.curvature_Radius;
+#endif
+            Real &object_distance = tc.object_distance,
+                 &ray_height = tc.ray_height,
+                 &axis_slope_angle = tc.axis_slope_angle,
+                 &from_index = tc.from_index,
+                 &to_index = tc.to_index;
+
+            to_index = P.index_Of_Refraction;
+            if constexpr (P.index_Of_Refraction > 1) {
+                to_index += ((SpectralLine::D - tc.line) /
+                    (SpectralLine::C - SpectralLine::F)) *
+#ifdef Real_Is_Class
+                    (surf.index_Less_One / surf.dispersion);
+#else
+                    ((Real(P.index_Of_Refraction) - 1) / P.dispersion);
+#endif
+            }
+
+            if constexpr (AI == Paraxial_Ray) {
+
+                //  Paraxial ray
+
+                if constexpr (P.curvature_Radius != 0) {
+
+                    //  Curved surface
+
+                    if constexpr (Parallel) {
+                        const Real iangsin = ray_height / radius_of_curvature;
+                        const Real rangsin = (from_index / to_index) * iangsin;
+                        const Real asadoubleprime = iangsin - rangsin;
+
+                        object_distance = ray_height / asadoubleprime;
+                        axis_slope_angle = asadoubleprime;
+                    } else {
+                        const Real iangsin = ((object_distance - radius_of_curvature) /
+                                              radius_of_curvature) * axis_slope_angle;
+                        const Real rangsin = (from_index / to_index) * iangsin;
+                        const Real asadoubleprime = axis_slope_angle + iangsin - rangsin;
+                        const Real rayheightprime = object_distance * axis_slope_angle;
+
+                        object_distance = rayheightprime / asadoubleprime;
+                        ray_height = rayheightprime;
+                        axis_slope_angle = asadoubleprime;
+                    }
+
+                } else {
+
+                    //  Flat surface
+
+                    object_distance = object_distance * (to_index / from_index);
+                    axis_slope_angle = axis_slope_angle * (from_index / to_index);
+                }
+            } else {
+
+                //  Marginal ray
+
+                if constexpr (P.curvature_Radius != 0) {
+
+                    //  Curved surface
+
+                    if constexpr (Parallel) {
+                        const Real iangsin = ray_height / radius_of_curvature;
+                        const Real iang = asin(iangsin);
+                        const Real rangsin = (from_index / to_index) * iangsin;
+                        const Real asadoubleprime = iang - asin(rangsin);
+                        const Real sinasaiang = sin(iang / 2);
+                        const Real sagitta = 2 * radius_of_curvature * sinasaiang * sinasaiang;
+
+                        object_distance = ((radius_of_curvature * sin(iang)) *
+                                           cot(asadoubleprime)) + sagitta;
+                        axis_slope_angle = asadoubleprime;
+                    } else {
+                        const Real iangsin = ((object_distance - radius_of_curvature) /
+                                              radius_of_curvature) * sin(axis_slope_angle);
+                        const Real iang = asin(iangsin);
+                        const Real rangsin = (from_index / to_index) * iangsin;
+                        const Real asadoubleprime = axis_slope_angle + iang - asin(rangsin);
+                        const Real sinasaiang = sin((axis_slope_angle + iang) / 2);
+                        const Real sagitta = 2 * radius_of_curvature * sinasaiang * sinasaiang;
+                        const Real objectdistanceprime = ((radius_of_curvature *
+                                                  sin(axis_slope_angle + iang)) *
+                                                  cot(asadoubleprime)) + sagitta;
+
+                        ray_height = object_distance * axis_slope_angle;
+                        object_distance = objectdistanceprime;
+                        axis_slope_angle = asadoubleprime;
+                    }
+
+                } else {
+
+                    //  Flat surface
+
+                    const Real rang = -(asin((from_index / to_index))) *
+                                  sin(axis_slope_angle);
+
+                    object_distance = object_distance * ((to_index *
+                                cos(-rang)) / (from_index *
+                                cos(axis_slope_angle)));
+                    axis_slope_angle = -rang;
+                }
+            }
+
+            from_index = to_index;
+            if constexpr (P.edge_Thickness != 0) {
+#ifdef Real_Is_Class
+                object_distance -= surf.edge_Thickness;
+#else
+                object_distance -= P.edge_Thickness;
+#endif
+            }
+
+            transit<AI, Parallel && P.curvature_Radius == 0 && P.edge_Thickness == 0,
+                    Rest...>(tc);
+        }
+    };
+
+    //  The quantities computed by evaluate(), for validation and comparisons
+    const int nQuantities = 8;
+    const char *quantityNames[nQuantities] = {
+        "D marginal ray object distance",
+        "D marginal ray axis slope angle",
+        "D paraxial ray object distance",
+        "D paraxial ray axis slope angle",
+        "Longitudinal spherical aberration",
+        "Offense against sine condition",
+        "Axial chromatic aberration",
+        "Maximum spherical aberration"
+    };
+
+    /*  Reference values of the quantities, computed with MPFR at
+        4096 bits.  Each is the sum of six doubles, the first the
+        value rounded to double and each of the rest the remainder
+        rounded, so it is exact to about 318 bits, and may be
+        converted to any Real with the type's own arithmetic.  The
+        first eleven decimal places agree with the results of the
+        original Microsoft Quick BASIC run on the IBM PC/AT, which
+        validate() compared as strings before.  */
+    const int ReferenceTerms = 6;
+    const int ReferenceBits = 318;
+    const double referenceTerms[nQuantities][ReferenceTerms] = {
+        {  0x1.78c221e4bb969p+5,  -0x1.e028f5bb1df88p-49, -0x1.e4c9f59edb23bp-103,
+           0x1.f350d5be73abdp-158, -0x1.74231dbbaeap-216,  -0x1.cf6b820dd4986p-270 },
+        {  0x1.564cec665b17bp-5,  -0x1.52252f9d5391bp-59,  0x1.347953779a4b6p-114,
+           0x1.c92f9bd843041p-170, 0x1.0f4aef6b1e199p-224,  0x1.a5ba5309e09a2p-278 },
+        {  0x1.78ab763b4534ap+5,  -0x1.f322560973d86p-51, -0x1.ee31b7c2a23bap-106,
+           0x1.e14fbc6378dadp-162, 0x1.1fe3378a28e24p-216,  0x1.17641512a7dc5p-270 },
+        {  0x1.56402cf6d0886p-5,   0x1.de225ace6509bp-59,  0x1.83619183fc75bp-114,
+          -0x1.301adda5e274ep-168, -0x1.8406e980b7114p-222, -0x1.6dd85958b718dp-276 },
+        { -0x1.6aba97661ea72p-7,  -0x1.f9fc73efd9164p-61,  0x1.df53436e1c2acp-118,
+           0x1.0981f0f877694p-172, 0x1.955175e092e6dp-230, -0x1.a37e0e2d5a094p-288 },
+        {  0x1.779702747dddbp-14, -0x1.15642409c76bdp-68, -0x1.80e9610ffafedp-127,
+          -0x1.720bbe8e83b91p-181, -0x1.d26da9712b8d6p-236, -0x1.3d9afe618bcc6p-292 },
+        {  0x1.25c05a55b492ap-8,  -0x1.0a9939325b53ep-68, -0x1.99e4ef36f7a55p-122,
+          -0x1.5748d2a304295p-176, -0x1.f25cbaecc6b67p-231, -0x1.b6015ff188938p-285 },
+        {  0x1.b2ba9c9f38a5p-5,   -0x1.52c132a3e8ba7p-64, -0x1.bec720a83ddb8p-118,
+           0x1.bbc6ecea7c2f2p-174, -0x1.6ebd6d28fa2bfp-228, -0x1.cb30da4445b11p-284 }
+    };
+
+    /*  Half a unit in the last of the eleven decimal places to
+        which the original benchmark's results were published.  */
+    const double PublishedTolerance = 0.5e-11;
+
+    //  Reference value of quantity i, summed smallest term first
+    static Real referenceValue(int i) {
+        Real r = referenceTerms[i][ReferenceTerms - 1];
+        for (int j = ReferenceTerms - 2; j >= 0; j--) {
+            r = r + referenceTerms[i][j];
+        }
+        return r;
+    }
+
+    //  Bits in the mantissa of a Real at the working precision
+    static int realBits(void) {
+#if FLOAT128
+        return FLT128_MANT_DIG;
+#elif FLOAT_MPFR
+        return (int) mpreal::get_default_prec();
+#elif FLOAT_DD
+        return 106;
+#elif FLOAT_QD
+        return 212;
+#elif FLOAT_MPN
+        return Real::Bits;
+#elif FLOAT_COUNTED
+        return numeric_limits<Real::value_type>::digits;
+#elif FLOAT_SHADOW
+        return numeric_limits<double>::digits;
+#else
+        return numeric_limits<Real>::digits;
+#endif
+    }
+
+    //  Name of the Real type, for the record of a run
+    static string realName(void) {
+#if FLOAT128
+        return "__float128";
+#elif FLOAT_MPFR
+        return "mpreal";
+#elif FLOAT_DD
+        return "ddreal";
+#elif FLOAT_QD
+        return "qdreal";
+#elif FLOAT_MPN
+        return "mpnreal<" + to_string(MPN_LIMBS) + ">";
+#elif FLOAT_COUNTED
+        return "Counted<double>";
+#elif FLOAT_SHADOW
+        return "Shadowed<qdreal>";
+#elif LONG_DOUBLE
+        return "long double";
+#else
+        return "double";
+#endif
+    }
+
     /*  A DesignEvaluation provides tools to analyse designs.  It
         takes a design, traces rays through it in various wavelengths
         and axial incidences, and computes its aberrations compared to
         acceptable standards.  */
 
     class DesignEvaluation {
+    public:
+        //  Rays traced by an evaluation: D marginal, D paraxial, C and F marginal
+        static const int nTraces = 4;
+
+        /*  If not NULL, trace the rays of each evaluation as
+            parallel tasks on this pool, each in its own context.  */
+        static taskpool::Pool *parallel;
+
     private:
         Design *d;
+        TraceContext tc[nTraces];   // Reused by every evaluate()
+#if FLOAT_MPFR
+        mp_prec_t precision;        // Working precision, for the tasks
+#endif
 
         Real cMarginalOD;           // C marginal ray
         Real fMarginalOD;           // F marginal ray
 
         char received[8][80];       // Edited results of evaluation
 
+        //  Reference values at the working precision
+        Real expected[nQuantities];
+
     public:
         Real dMarginalOD;           // D Marginal ray
         Real dMarginalSA;
@@ -440,12 +1422,28 @@
         Real maxOffenseAgainstSineCondition;
         Real maxAxialChromaticAberration;
 
+        //  The members holding each of the quantities
+        static Real DesignEvaluation::*const quantity[nQuantities];
+
         //  Construct a DesignEvaluation
-        DesignEvaluation(Design &des) {
+        DesignEvaluation(Design &des) :
+            tc{ TraceContext(des, SpectralLine::D, Marginal_Ray),
+                TraceContext(des, SpectralLine::D, Paraxial_Ray),
+                TraceContext(des, SpectralLine::C, Marginal_Ray),
+                TraceContext(des, SpectralLine::F, Marginal_Ray) } {
             d = &des;
             maxOffenseAgainstSineCondition = 0.0025;
+            for (int i = 0; i < nQuantities; i++) {
+                expected[i] = referenceValue(i);
+            }
         }
 
+        //  Trace ray i of an evaluation in the context c
+        void trace(int i, TraceContext &c);
+
+        //  Trace ray i in its own context, as a task on the pool
+        static void traceTask(void *de, int i);
+
         //  Evaluate the design
         void evaluate(void);
 
@@ -459,27 +1457,95 @@
             }
         }
 
-        //  Validate the report
-        unsigned int validate(ostream &os);
-    };
+        /*  Tolerance of each quantity, given an absolute
+            tolerance or, if 0, that for the precision of the
+            type and trigonometric functions.  */
+        void tolerances(double tol[nQuantities], double absolute = 0);
+
+        /*  Count the quantities whose difference from the
+            reference exceeds their tolerance, without editing
+            anything, cheaply enough to call after every
+            evaluation.  */
+        unsigned int check(const double tol[nQuantities]);
+        unsigned int check(double absolute = 0) {
+            double tol[nQuantities];
+            tolerances(tol, absolute);
+            return check(tol);
+        }
 
-    void DesignEvaluation::evaluate(void) {
+        //  Check the results and report those in error
+        unsigned int validate(ostream &os);
 
-        //  D marginal ray
-        TraceContext tc(*d, SpectralLine::D, Marginal_Ray);
-        tc.traceLine(dMarginalOD, dMarginalSA);
+        //  Report the error of every quantity in ULPs and digits
+        void accuracy(ostream &os);
+    };
 
-        //  D paraxial ray
-        tc.set(*d, SpectralLine::D, Paraxial_Ray);
-        tc.traceLine(dParaxialOD, dParaxialSA);
+    Real DesignEvaluation::*const DesignEvaluation::quantity[nQuantities] = {
+        &DesignEvaluation::dMarginalOD,
+        &DesignEvaluation::dMarginalSA,
+        &DesignEvaluation::dParaxialOD,
+        &DesignEvaluation::dParaxialSA,
+        &DesignEvaluation::longitudinalSphericalAberration,
+        &DesignEvaluation::offenseAgainstSineCondition,
+        &DesignEvaluation::axialChromaticAberration,
+        &DesignEvaluation::maxLongitudinalSphericalAberration
+    };
 
-        //  C marginal ray
-        tc.set(*d, SpectralLine::C, Marginal_Ray);
-        tc.traceLine(cMarginalOD);
+    taskpool::Pool *DesignEvaluation::parallel = NULL;
+
+    void DesignEvaluation::trace(int i, TraceContext &c) {
+        SHADOW_RAY(i);
+        switch (i) {
+            case 0:                     //  D marginal ray
+                c.set(*d, SpectralLine::D, Marginal_Ray);
+                c.traceLine(dMarginalOD, dMarginalSA);
+                break;
+
+            case 1:                     //  D paraxial ray
+                c.set(*d, SpectralLine::D, Paraxial_Ray);
+                c.traceLine(dParaxialOD, dParaxialSA);
+                break;
+
+            case 2:                     //  C marginal ray
+                c.set(*d, SpectralLine::C, Marginal_Ray);
+                c.traceLine(cMarginalOD);
+                break;
+
+            default:                    //  F marginal ray
+                c.set(*d, SpectralLine::F, Marginal_Ray);
+                c.traceLine(fMarginalOD);
+                break;
+        }
+    }
 
-        //  F marginal ray
-        tc.set(*d, SpectralLine::F, Marginal_Ray);
-        tc.traceLine(fMarginalOD);
+    /*  The traces share only the design and the spectral lines,
+        which they read, and write disjoint results.  MPFR's default
+        precision is kept for each thread, so a worker must be given
+        that of the thread which started the evaluation before it
+        creates any temporaries.  */
+    void DesignEvaluation::traceTask(void *de, int i) {
+        DesignEvaluation &e = *(DesignEvaluation *) de;
+#if FLOAT_MPFR
+        mpreal::set_default_prec(e.precision);
+#endif
+        e.trace(i, e.tc[i]);
+    }
+
+    void DesignEvaluation::evaluate(void) {
+        PHASE(Evaluate);
+        SHADOW_RAY(nTraces);            // The aberrations, after the rays
+
+        //  Trace the rays, then join them for the aberrations
+        if (parallel != NULL) {
+#if FLOAT_MPFR
+            precision = mpreal::get_default_prec();
+#endif
+            parallel->run(traceTask, this, nTraces);
+        } else {
+            for (int i = 0; i < nTraces; i++) {
+                trace(i, tc[0]);
+            }
+        }
 
         //  Compute aberrations of the design
 
@@ -493,8 +1559,9 @@
             as the lateral distance in the focal plane between
             where a paraxial ray and marginal ray in the D line
             come to focus.  */
+        const Real sin_marginal = sin(dMarginalSA);
         offenseAgainstSineCondition = 1 - (dParaxialOD * dParaxialSA) /
-            (sin(dMarginalSA) * dMarginalOD);
+            (sin_marginal * dMarginalOD);
 
         /*  The axial chromatic aberration is the distance between
             where marginal rays in the C and F lines come to focus.  */
@@ -504,13 +1571,16 @@
 
         /*  Maximum longitudinal spherical aberration, which is
             also the maximum for axial chromatic aberration.  This
-            is computed for the D line.  */
-        const Real sin_dm_sa = sin(dMarginalSA);
+            is computed for the D line.  The standard kernel
+            computes the sine again, as every other version of the
+            benchmark does; -reduce uses the one above.  */
+        const Real sin_dm_sa = TraceContext::reduced ? sin_marginal : Real(sin(dMarginalSA));
         maxLongitudinalSphericalAberration = 0.0000926 / (sin_dm_sa * sin_dm_sa);
         maxAxialChromaticAberration = maxLongitudinalSphericalAberration; // Same criterion
     }
 
     void DesignEvaluation::report(void) {
+        PHASE(Report);
 #if FLOAT128
         /*  The libquadmath installation on the system with which I
             developed this code does not provide XXprintf variants
@@ -523,7 +1593,7 @@
                           ry[] = "%15s   %s  %s",
                           qf[] =
             "%16.11Qf";
-        char b1[80], b2[80];
+        char b1[24], b2[24];        // The widest field is 21 characters
         quadmath_snprintf(b1, sizeof b1, "%21.11Qf", dMarginalOD);
         quadmath_snprintf(b2, sizeof b2, "%14.11Qf", dMarginalSA);
         snprintf(received[0], 80, ry, "Marginal ray", b1, b2);
@@ -544,12 +1614,14 @@
            Qe(axialChromaticAberration));
         snprintf(received[7], 80, mp, Qe(maxAxialChromaticAberration));
 #       undef  Qe
-#elif FLOAT_MPFR
+#elif FLOAT_MPFR || FLOAT_DD || FLOAT_QD || FLOAT_MPN || FLOAT_COUNTED || FLOAT_SHADOW
         /*  The MPFR C++ package does not allow its mpreal values to be
             edited by XXprintf functions, but provides a toString method
             which accepts XXprintf-like format codes.  The following code
             uses this method to format the output of the evaluation into
-            the received[] array.  */
+            the received[] array.  The ddreal, qdreal, mpnreal, Counted,
+            and Shadowed types provide a toString method which accepts
+            the same format codes.  */
         const static char mp[] =
             "    (Maximum permissible):              %s",
                           ry[] = "%15s   %s  %s";
@@ -596,71 +1668,1972 @@
 #endif
     }
 
+    /*  Numeric validation
+
+        Each quantity is compared with its reference value, and is
+        in error if the difference exceeds a tolerance in units in
+        the last place (ULPs) of the reference at the precision to
+        which the results can be expected to be correct: that of
+        the type, or of the trigonometric functions if they are
+        less precise (the intrig functions' coefficients are
+        double), or of the references if they are less precise
+        than both.  The tolerance of the ray trace results allows
+        for the rounding errors accumulated by the trace.  The
+        aberrations are small differences of nearly equal results,
+        so their tolerance is multiplied by the ratio of the
+        operands to the difference.  The maximum for spherical
+        aberration is inversely proportional to the square of the
+        sine of the D marginal axis slope angle, which doubles its
+        error.  Allowance and condition were chosen from the largest
+        errors measured in each build and backend, with a margin of
+        a factor of eight or more.  */
+
+    const double Allowance = 256;
+    const double condition[nQuantities] = {
+        1, 1, 1, 1,
+        47.09 / 0.01107,                    //  dParaxialOD - dMarginalOD
+        1 / 0.00008955,                     //  1 - (dParaxialOD * ...)
+        47.09 / 0.004482,                   //  fMarginalOD - cMarginalOD
+        2                                   //  0.0000926 / sin^2(dMarginalSA)
+    };
+
+    void DesignEvaluation::tolerances(double tol[nQuantities], double absolute) {
+        int bits = realBits();
+        if (trig.bits != 0 && trig.bits < bits) {
+            bits = trig.bits;
+        }
+        if (bits > ReferenceBits) {
+            bits = ReferenceBits;
+        }
+        for (int i = 0; i < nQuantities; i++) {
+            tol[i] = (absolute != 0) ? absolute :
+                Allowance * condition[i] * ldexp(1.0, ilogb(referenceTerms[i][0]) - bits + 1);
+        }
+    }
+
+    unsigned int DesignEvaluation::check(const double tol[nQuantities]) {
+        unsigned int errors = 0;
+        for (int i = 0; i < nQuantities; i++) {
+            const Real e = this->*quantity[i] - expected[i];
+            if (e > tol[i] || e < -tol[i]) {
+                errors++;
+            }
+        }
+        return errors;
+    }
+
+    /*  A difference from the reference for quantity i in ULPs of
+        the type, or 0 if the type is more precise than the
+        reference.  */
+    static double ulps(double e, int i) {
+        const int bits = realBits();
+        return (bits > ReferenceBits) ? 0 :
+            ldexp(fabs(e), bits - 1 - ilogb(referenceTerms[i][0]));
+    }
+
+    /*  Error of x compared with the reference for quantity i, in
+        ULPs and in correct significant digits, which are limited
+        by the precision of the type or of the reference, whichever
+        is less.  */
+    static void error(const Real &x, const Real &ref, int i, double &u, double &digits) {
+        const double e = fabs(intrig::approx(Real(x - ref), 0)),
+                     r = fabs(referenceTerms[i][0]),
+                     best = min(realBits(), ReferenceBits) * log10(2.0);
+        u = ulps(e, i);
+        digits = (e == 0) ? best : min(best, -log10(e / r));
+    }
+
     unsigned int DesignEvaluation::validate(ostream &os) {
+        PHASE(Validate);
+        double tol[nQuantities];
+        tolerances(tol);
+        char line[100];
         unsigned int errors = 0;
-        /*  Reference results.  These happen to be derived from
-            a run on Microsoft Quick BASIC on the IBM PC/AT.  */
-        const static char * const expected[] = {
-            "   Marginal ray          47.09479120920   0.04178472683",
-            "   Paraxial ray          47.08372160249   0.04177864821",
-            "Longitudinal spherical aberration:        -0.01106960671",
-            "    (Maximum permissible):                 0.05306749907",
-            "Offense against sine condition (coma):     0.00008954761",
-            "    (Maximum permissible):                 0.00250000000",
-            "Axial chromatic aberration:                0.00448229032",
-            "    (Maximum permissible):                 0.05306749907"
+        for (int i = 0; i < nQuantities; i++) {
+            const Real &x = this->*quantity[i];
+            const Real e = x - expected[i];
+            if (e > tol[i] || e < -tol[i]) {
+                double u, digits;
+                error(x, expected[i], i, u, digits);
+                snprintf(line, sizeof line, "%.17g", intrig::approx(expected[i], 0));
+                os << "Error in " << quantityNames[i] << "..." << endl;
+                os << "Expected:  " << line << endl;
+                snprintf(line, sizeof line, "%.17g", intrig::approx(x, 0));
+                os << "Received:  " << line << endl;
+                snprintf(line, sizeof line, "(Error)    %.4g ULPs, %.1f digits, tolerance %.4g ULPs",
+                    u, digits, ulps(tol[i], i));
+                os << line << endl;
+                errors++;
+            }
+        }
+        return errors;
+    }
+
+    void DesignEvaluation::accuracy(ostream &os) {
+        double tol[nQuantities];
+        tolerances(tol);
+        char line[100];
+        os << "Quantity                         Error (ULPs)  Digits  Tolerance" << endl;
+        for (int i = 0; i < nQuantities; i++) {
+            const Real &x = this->*quantity[i];
+            const Real e = x - expected[i];
+            double u, digits;
+            error(x, expected[i], i, u, digits);
+            if (realBits() > ReferenceBits) {
+                snprintf(line, sizeof line, "%-32s %12s %7.1f %10s%s",
+                    quantityNames[i], "-", digits, "-",
+                    (e > tol[i] || e < -tol[i]) ? "  Error" : "");
+            } else {
+                snprintf(line, sizeof line, "%-32s %12.4g %7.1f %10.4g%s",
+                    quantityNames[i], u, digits, ulps(tol[i], i),
+                    (e > tol[i] || e < -tol[i]) ? "  Error" : "");
+            }
+            os << line << endl;
+        }
+    }
+
+#ifdef Uses_GMP
+    /*  MPFR caches the memory functions in effect when it first
+        allocates.  Release its caches before installing new ones
+        so it picks them up.  */
+    static void releaseCaches(void) {
+#if FLOAT_MPFR && MPFR_VERSION_MAJOR >= 4
+        mpfr_mp_memory_cleanup();
+#endif
+    }
+
+    /*  Install the pooled allocator, with size classes up to eight
+        times the block holding a number at the working precision.
+        MPFR stores a mantissa of n limbs in a block of n + 1, and
+        its transcendental functions request blocks of up to five
+        times that size for their temporaries.  */
+    static void installPool(void) {
+#if FLOAT_MPFR
+        const size_t limbs = (MPFR_PRECISION + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS;
+#else
+        const size_t limbs = MPN_LIMBS;
+#endif
+        releaseCaches();
+        mppool::install(4 * 1024 * 1024, 8 * (limbs + 1) * sizeof(mp_limb_t));
+    }
+
+    /*  Memory functions which count the allocations GMP and MPFR
+        make on behalf of our multiple precision arithmetic, passing
+        them on to the functions in effect when they were installed.
+        They are installed by the -alloc and -poolcompare options.  */
+
+    namespace allocCount {
+        unsigned long allocs = 0, reallocs = 0, frees = 0;
+        unsigned long long bytes = 0;
+        bool pooled = false;
+
+        void *(*nextAlloc)(size_t);
+        void *(*nextRealloc)(void *, size_t, size_t);
+        void (*nextFree)(void *, size_t);
+
+        void *countAlloc(size_t n) {
+            allocs++;
+            bytes += n;
+            return nextAlloc(n);
+        }
+
+        void *countRealloc(void *p, size_t o, size_t n) {
+            reallocs++;
+            if (n > o) {
+                bytes += n - o;
+            }
+            return nextRealloc(p, o, n);
+        }
+
+        void countFree(void *p, size_t n) {
+            frees++;
+            nextFree(p, n);
+        }
+
+        void install(void) {
+            releaseCaches();
+            mp_get_memory_functions(&nextAlloc, &nextRealloc, &nextFree);
+            pooled = nextAlloc == mppool::gmpAlloc;
+            mp_set_memory_functions(countAlloc, countRealloc, countFree);
+        }
+
+        void reset(void) {
+            allocs = reallocs = frees = 0;
+            bytes = 0;
+            mppool::statistics() = mppool::Statistics();
+        }
+
+        void report(const char *label, long iterations, double elapsed) {
+            const double n = iterations;
+            if (label != NULL) {
+                printf("%s:\n", label);
+            }
+            printf("Allocations per evaluate():   %.2f (%.1f bytes)\n",
+                allocs / n, bytes / n);
+            printf("Reallocations per evaluate(): %.2f\n", reallocs / n);
+            printf("Frees per evaluate():         %.2f\n", frees / n);
+            if (pooled) {
+                const mppool::Statistics &ps = mppool::statistics();
+                printf("Pool per evaluate():          %.2f recycled, "
+                       "%.2f carved, %.2f to malloc\n",
+                    ps.recycled / n, ps.carved / n,
+                    (ps.large + ps.overflow) / n);
+            }
+            printf("Time per evaluate():          %.4f usec\n",
+                (elapsed * 1e6) / n);
+        }
+    }
+
+#endif
+
+    //  Hardware performance counters, if requested by -perf
+    static perfcount::Counters *counters = NULL;
+
+    //  Run the benchmark, returning the elapsed time in seconds
+    static double timeEvaluations(DesignEvaluation &de, long iterations) {
+#ifdef Uses_GMP
+        allocCount::reset();
+#endif
+        if (counters != NULL) {
+            counters->start();
+        }
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (long l = 0; l < iterations; l++) {
+            de.evaluate();
+        }
+        const double elapsed = chrono::duration<double>(
+            chrono::steady_clock::now() - start).count();
+        if (counters != NULL) {
+            counters->stop(iterations);
+        }
+        return elapsed;
+    }
+
+    /*  Timing harness.  Run warmup evaluations, untimed, to bring
+        the caches, branch predictors, memory allocator, and
+        processor clock to a steady state, then time repetitions of
+        the given number of iterations with the monotonic clock and
+        report the statistics of the time per iteration.  Returns
+        the elapsed time of the last repetition, and stores the
+        statistics through summary if it isn't NULL.  */
+    static double timeRepetitions(ostream &os, DesignEvaluation &de, long iterations,
+                                  int repetitions, long warmup,
+                                  timestats::Summary *summary = NULL) {
+        for (long l = 0; l < warmup; l++) {
+            de.evaluate();
+        }
+        vector<double> usec;
+        double elapsed = 0;
+        for (int k = 0; k < repetitions; k++) {
+            elapsed = timeEvaluations(de, iterations);
+            usec.push_back((elapsed * 1e6) / iterations);
+        }
+
+        const timestats::Summary s = timestats::summarise(usec);
+        char line[100];
+        snprintf(line, sizeof line, "%d repetitions of %ld iterations after %ld warmup",
+            repetitions, iterations, warmup);
+        os << line << endl;
+        snprintf(line, sizeof line, "    Mean     %12.4f usec/iteration", s.mean);
+        os << line << endl;
+        snprintf(line, sizeof line, "    Median   %12.4f", s.median);
+        os << line << endl;
+        snprintf(line, sizeof line, "    Std dev  %12.4f  (%.2f%%)", s.stddev,
+            (100 * s.stddev) / s.mean);
+        os << line << endl;
+        snprintf(line, sizeof line, "    95%% CI   %12.4f to %.4f", s.mean - s.ci95,
+            s.mean + s.ci95);
+        os << line << endl;
+        snprintf(line, sizeof line, "    Range    %12.4f to %.4f", s.min, s.max);
+        os << line << endl;
+        if (summary != NULL) {
+            *summary = s;
+        }
+        return elapsed;
+    }
+
+    /*  Calibration.  Rather than a fixed iteration count, which
+        runs for seconds on one machine and hours on another, run
+        for a requested time.  A probe doubles the iteration count
+        from one until a run takes at least ProbeTime (or a tenth of
+        the requested time, if that's less), which also warms up the
+        machine, and its rate predicts the iterations needed.  The
+        benchmark then runs in chunks of about a twentieth of the
+        requested time, and the rate measured by each chunk sizes
+        the next, so a processor whose clock changes during the run
+        still stops close to the requested time.  The last chunk
+        takes whatever time remains, unless that's less than half
+        an iteration.  */
+
+    static const double ProbeTime = 0.2;        // Minimum probe, seconds
+    static const int Chunks = 20;               // Chunks in a calibrated run
+
+    //  Iterations per second found by the probe
+    static double probeRate(DesignEvaluation &de, double seconds) {
+        const double target = min(ProbeTime, seconds / 10);
+        long n = 1;
+        double t;
+        while ((t = timeEvaluations(de, n)) < target) {
+            n *= 2;
+        }
+        return n / t;
+    }
+
+    /*  Run the benchmark for the given number of seconds, after
+        the probe, and report the time per iteration.  Returns the
+        number of iterations run, and stores the time they took
+        through timed if it isn't NULL.  */
+    static long timeDuration(ostream &os, DesignEvaluation &de, double seconds,
+                             double *timed = NULL) {
+        double rate = probeRate(de, seconds);
+        const double chunk = seconds / Chunks;
+        double elapsed = 0, fastest = 0, slowest = 0;
+        long iterations = 0;
+        int nChunks = 0;
+
+        while (elapsed < seconds) {
+            const double want = seconds - elapsed;
+            const bool last = want <= 1.5 * chunk;
+            long n = (long) ((last ? want : chunk) * rate + 0.5);
+            if (n < 1) {
+                if (last && iterations > 0) {
+                    break;              // Stopping is closer to the duration
+                }
+                n = 1;
+            }
+            const double t = timeEvaluations(de, n);
+            elapsed += t;
+            iterations += n;
+            nChunks++;
+            rate = n / t;
+            if (nChunks == 1 || rate > fastest) {
+                fastest = rate;
+            }
+            if (nChunks == 1 || rate < slowest) {
+                slowest = rate;
+            }
+        }
+
+        char line[100];
+        snprintf(line, sizeof line, "%ld iterations in %.3f seconds, %d chunks",
+            iterations, elapsed, nChunks);
+        os << line << endl;
+        snprintf(line, sizeof line, "    Mean     %12.4f usec/iteration",
+            (elapsed * 1e6) / iterations);
+        os << line << endl;
+        snprintf(line, sizeof line, "    Chunks   %12.4f to %.4f  (%.2f%%)",
+            1e6 / fastest, 1e6 / slowest, 100 * (fastest - slowest) / slowest);
+        os << line << endl;
+        if (timed != NULL) {
+            *timed = elapsed;
+        }
+        return iterations;
+    }
+
+    /*  Iterations to make each of a number of repetitions take
+        the given time.  */
+    static long calibrateIterations(DesignEvaluation &de, double seconds) {
+        return max(1L, (long) (seconds * probeRate(de, seconds) + 0.5));
+    }
+
+    /*  The record of a run written by -json and -csv: what was
+        run, how long it took, whether its results were valid, and
+        the provenance of the build and machine.  Every record has
+        the same fields; those which don't apply to the run, such
+        as the statistics of a run without -repeat, are null.
+        Times are in seconds for the whole run and microseconds
+        per iteration.  */
+    static results::Record runRecord(int argc, char *argv[], const char *mode,
+                                     long iterations, int repetitions, double seconds,
+                                     const timestats::Summary *stats, unsigned int errors) {
+        results::Record r;
+        string arguments;
+        for (int i = 1; i < argc; i++) {
+            arguments += (i > 1 ? " " : "") + string(argv[i]);
+        }
+        r.addString("benchmark", "fbench");
+        r.addString("language", "C++");
+        r.addString("real_type", realName());
+        r.addInteger("real_bits", realBits());
+        r.addString("trig", trig.name);
+        r.addString("arguments", arguments);
+        r.addString("mode", mode);
+        r.addInteger("iterations", iterations);
+        r.addInteger("repetitions", max(repetitions, 1));
+        const char *statNames[] = {
+            "usec_mean", "usec_median", "usec_stddev", "usec_ci95", "usec_min", "usec_max"
         };
+        if (seconds >= 0) {
+            r.addNumber("seconds", seconds, "%.6f");
+            r.addNumber("usec_per_iteration", (seconds * 1e6) / (iterations * max(repetitions, 1)),
+                "%.6f");
+        } else {
+            r.addNull("seconds");
+            r.addNull("usec_per_iteration");
+        }
+        if (stats != NULL) {
+            const double v[] = {
+                stats->mean, stats->median, stats->stddev, stats->ci95, stats->min, stats->max
+            };
+            for (int i = 0; i < 6; i++) {
+                r.addNumber(statNames[i], v[i], "%.6f");
+            }
+        } else {
+            for (int i = 0; i < 6; i++) {
+                r.addNull(statNames[i]);
+            }
+        }
+        r.addInteger("errors", errors);
+        r.addBoolean("valid", errors == 0);
+        results::provenance(r);
+        return r;
+    }
 
-        for (int i = 0; i < 8; i++) {
-           if (strcmp(received[i], expected[i]) != 0) {
-              os << "Error in results on line " << i + 1 << "..." << endl;
-              os << "Expected:  \"" << expected[i] << "\"" << endl;
-              os << "Received:  \"" << received[i] << "\"" << endl;
-              os << "(Errors)    ";
-              int k = strlen(expected[i]);
-              for (int j = 0; j < k; j++) {
-                 os << ((expected[i][j] == received[i][j]) ? ' ' : '^');
-                 if (expected[i][j] != received[i][j]) {
-                    errors++;
-                 }
-              }
-              os << endl;
-           }
+    /*  Run the benchmark checking the results of every
+        evaluation, returning the number in error.  */
+    static long verifyEvaluations(DesignEvaluation &de, long iterations) {
+        double tol[nQuantities];
+        de.tolerances(tol);
+        long failures = 0;
+        for (long l = 0; l < iterations; l++) {
+            de.evaluate();
+            if (de.check(tol) != 0) {
+                failures++;
+            }
+        }
+        return failures;
+    }
+
+    //  List the trigonometric function backends
+    static void listTrig(ostream &os) {
+        const vector<TrigBackend> b = trigBackends();
+        for (unsigned int i = 0; i < b.size(); i++) {
+            os << "                  " << setw(10) << left << b[i].name << right <<
+                b[i].description <<
+                ((strcmp(b[i].name, DefaultTrig) == 0) ? " (default)" : "") << endl;
         }
+    }
 
-        return errors;
+    /*  Time and validate the benchmark with each of the
+        trigonometric function backends.  */
+    static void compareTrig(ostream &os, DesignEvaluation &de, long iterations) {
+        const vector<TrigBackend> b = trigBackends();
+        char line[80];
+
+        os << "Backend     Time (usec)  Errors  Relative" << endl;
+        double base = 0;
+        for (unsigned int i = 0; i < b.size(); i++) {
+            trig = b[i];
+            const double t = (timeEvaluations(de, iterations) * 1e6) / iterations;
+            const unsigned int errors = de.check();
+            if (i == 0) {
+                base = t;
+            }
+            snprintf(line, sizeof line, "%-10s %12.4f  %6u  %8.3f",
+                b[i].name, t, errors, t / base);
+            os << line << endl;
+        }
+    }
+
+    /*  Call counters.  The -count option wraps the functions of
+        the selected backend in ones which count their calls, and
+        reports the calls per evaluate() at the end of the run.  */
+
+    namespace trigCount {
+        const int nFunctions = 5;
+        const char *names[nFunctions] = { "sin", "asin", "cos", "cot", "sqrt" };
+        unsigned long calls[nFunctions];
+        TrigBackend counted;            // Functions being counted
+
+        Real countSin(const Real &x) { calls[0]++; return (counted.sin)(x); }
+        Real countAsin(const Real &x) { calls[1]++; return (counted.asin)(x); }
+        Real countCos(const Real &x) { calls[2]++; return (counted.cos)(x); }
+        Real countCot(const Real &x) { calls[3]++; return (counted.cot)(x); }
+        Real countSqrt(const Real &x) { calls[4]++; return (counted.sqrt)(x); }
+
+        void reset(void) {
+            for (int i = 0; i < nFunctions; i++) {
+                calls[i] = 0;
+            }
+        }
+
+        //  Wrap the functions of the selected backend
+        void install(void) {
+            counted = trig;
+            trig.sin = countSin;
+            trig.asin = countAsin;
+            trig.cos = countCos;
+            trig.cot = countCot;
+            trig.sqrt = countSqrt;
+            reset();
+        }
+
+        //  Remove the wrappers
+        void remove(void) {
+            trig = counted;
+        }
+
+        //  Total calls per evaluate()
+        double total(long iterations) {
+            unsigned long t = 0;
+            for (int i = 0; i < nFunctions; i++) {
+                t += calls[i];
+            }
+            return ((double) t) / iterations;
+        }
+
+        void report(ostream &os, long iterations) {
+            char line[80];
+
+            os << "Calls per evaluate():";
+            for (int i = 0; i < nFunctions; i++) {
+                snprintf(line, sizeof line, "  %s %.1f", names[i],
+                    ((double) calls[i]) / iterations);
+                os << line;
+            }
+            snprintf(line, sizeof line, "  total %.1f", total(iterations));
+            os << line << endl;
+        }
+    }
+
+#if PHASE_TIMERS
+    /*  Phase timing of the trigonometric functions.  -phases and
+        -phasetrace wrap the functions of the selected backend, as
+        -count does, in ones which time each call, so their time
+        is separated from that of the arithmetic around them.  */
+
+    namespace trigPhase {
+        TrigBackend timed;              // Functions being timed
+
+        Real timeSin(const Real &x) { PHASE(Trig); return (timed.sin)(x); }
+        Real timeAsin(const Real &x) { PHASE(Trig); return (timed.asin)(x); }
+        Real timeCos(const Real &x) { PHASE(Trig); return (timed.cos)(x); }
+        Real timeCot(const Real &x) { PHASE(Trig); return (timed.cot)(x); }
+        Real timeSqrt(const Real &x) { PHASE(Trig); return (timed.sqrt)(x); }
+
+        void install(void) {
+            timed = trig;
+            trig.sin = timeSin;
+            trig.asin = timeAsin;
+            trig.cos = timeCos;
+            trig.cot = timeCot;
+            trig.sqrt = timeSqrt;
+        }
+    }
+
+    //  Events recorded for -phasetrace: a few hundred evaluations
+    static const size_t PhaseTraceEvents = 100000;
+#endif
+
+    /*  Accuracy audit of transitSurfaceReduced().  Evaluate the
+        design with transitSurface() and transitSurfaceReduced(),
+        and report the relative difference between the quantities
+        each computes, the calls each makes on the trigonometric
+        functions, and the time each takes.  */
+
+    static void quantities(const DesignEvaluation &de, Real q[nQuantities]) {
+        for (int i = 0; i < nQuantities; i++) {
+            q[i] = de.*DesignEvaluation::quantity[i];
+        }
+    }
+
+    //  Relative difference of x from ref, as a double
+    static double relativeDifference(const Real &x, const Real &ref) {
+        const double diff = intrig::approx(Real(x - ref), 0);
+        return (diff == 0) ? 0.0 : fabs(diff / intrig::approx(ref, 0));
+    }
+
+    //  Largest relative difference of the quantities q from ref
+    static double largestDifference(const Real q[nQuantities], const Real ref[nQuantities]) {
+        double worst = 0;
+        for (int i = 0; i < nQuantities; i++) {
+            const double r = relativeDifference(q[i], ref[i]);
+            if (r > worst) {
+                worst = r;
+            }
+        }
+        return worst;
+    }
+
+    static void auditReduced(ostream &os, DesignEvaluation &de, long iterations) {
+        Real results[2][nQuantities];
+        double time[2], calls[2][trigCount::nFunctions], total[2];
+        unsigned int errors[2];
+        char line[100];
+
+        for (int k = 0; k < 2; k++) {
+            TraceContext::reduced = k == 1;
+
+            trigCount::install();
+            de.evaluate();
+            for (int i = 0; i < trigCount::nFunctions; i++) {
+                calls[k][i] = trigCount::calls[i];
+            }
+            total[k] = trigCount::total(1);
+            trigCount::remove();
+
+            time[k] = (timeEvaluations(de, iterations) * 1e6) / iterations;
+            errors[k] = de.check();
+
+            quantities(de, results[k]);
+        }
+        TraceContext::reduced = false;
+
+        os << "Quantity                            Relative difference" << endl;
+        for (int i = 0; i < nQuantities; i++) {
+            snprintf(line, sizeof line, "%-36s %10.2e", quantityNames[i],
+                relativeDifference(results[1][i], results[0][i]));
+            os << line << endl;
+        }
+        os << endl << "Kernel     ";
+        for (int i = 0; i < trigCount::nFunctions; i++) {
+            snprintf(line, sizeof line, "%6s", trigCount::names[i]);
+            os << line;
+        }
+        os << "  Total  Time (usec)  Errors" << endl;
+        for (int k = 0; k < 2; k++) {
+            snprintf(line, sizeof line, "%-10s ", (k == 0) ? "standard" : "reduced");
+            os << line;
+            for (int i = 0; i < trigCount::nFunctions; i++) {
+                snprintf(line, sizeof line, "%6.0f", calls[k][i]);
+                os << line;
+            }
+            snprintf(line, sizeof line, "  %5.0f  %11.4f  %6u", total[k], time[k], errors[k]);
+            os << line << endl;
+        }
+    }
+
+    /*  Compare the ray trace through a design compiled into the
+        program, by the function fixed generated by its FixedDesign,
+        with that through the run-time design:
+        the time of each, its validation, and the largest relative
+        difference between the quantities they compute.  */
+
+    static void compareFixed(ostream &os, DesignEvaluation &de, long iterations,
+                             void (*fixed)(TraceContext &tc)) {
+        Real results[2][nQuantities];
+        double time[2];
+        char line[100];
+
+        os << "Design      Time (usec)  Errors  Relative" << endl;
+        for (int k = 0; k < 2; k++) {
+            TraceContext::fixed = (k == 1) ? fixed : NULL;
+            time[k] = (timeEvaluations(de, iterations) * 1e6) / iterations;
+            const unsigned int errors = de.check();
+            quantities(de, results[k]);
+            snprintf(line, sizeof line, "%-10s %12.4f  %6u  %8.3f",
+                (k == 0) ? "run-time" : "fixed", time[k], errors, time[k] / time[0]);
+            os << line << endl;
+        }
+        TraceContext::fixed = NULL;
+
+        snprintf(line, sizeof line, "Largest relative difference in results: %.2e",
+            largestDifference(results[1], results[0]));
+        os << line << endl;
+    }
+
+    /*  Compare evaluations whose rays are traced as parallel tasks
+        on pool with those traced one after another: the time of
+        each, which is the latency of a single evaluation, its
+        validation, and the largest relative difference between
+        the quantities they compute, which should be zero, since
+        each trace does the same arithmetic wherever it runs.  */
+
+    static void compareParallel(ostream &os, DesignEvaluation &de, long iterations,
+                                taskpool::Pool *pool) {
+        Real results[2][nQuantities];
+        double time[2];
+        char line[100];
+
+        os << "Traces      Time (usec)  Errors  Relative" << endl;
+        for (int k = 0; k < 2; k++) {
+            DesignEvaluation::parallel = (k == 1) ? pool : NULL;
+            time[k] = (timeEvaluations(de, iterations) * 1e6) / iterations;
+            const unsigned int errors = de.check();
+            quantities(de, results[k]);
+            snprintf(line, sizeof line, "%-10s %12.4f  %6u  %8.3f",
+                (k == 0) ? "sequential" : "tasks", time[k], errors, time[k] / time[0]);
+            os << line << endl;
+        }
+        DesignEvaluation::parallel = NULL;
+
+        snprintf(line, sizeof line, "Largest relative difference in results: %.2e",
+            largestDifference(results[1], results[0]));
+        os << line << endl;
+    }
+
+#ifdef Uses_tabletrig
+    /*  Accuracy guard.  The -guard option wraps the functions of
+        the selected backend in ones which compare a sample of
+        their results with the library functions, and reports the
+        largest difference in units in the last place of the
+        library result.  Every Interval'th call is checked; the
+        interval is prime, so successive iterations of the
+        benchmark check different calls.  */
+
+    namespace trigGuard {
+        const unsigned long Interval = 17;
+
+        struct Check {
+            const char *name;
+            TrigFunction f, lib;
+            unsigned long calls, checked, differ;
+            double maxUlp;
+            Real worst;             // Argument with largest difference
+        };
+
+        Check checks[4];            // sin, asin, cos, cot
+
+        Real check(Check &c, const Real &x) {
+            const Real y = c.f(x);
+            if ((++c.calls % Interval) == 0) {
+                const Real l = c.lib(x);
+                c.checked++;
+                if (y != l) {
+                    const double ulp = (double) (fabs(y - l) /
+                        ldexp(Real(1), ilogb(l) - (numeric_limits<Real>::digits - 1)));
+                    c.differ++;
+                    if (ulp > c.maxUlp) {
+                        c.maxUlp = ulp;
+                        c.worst = x;
+                    }
+                }
+            }
+            return y;
+        }
+
+        Real guardSin(const Real &x) { return check(checks[0], x); }
+        Real guardAsin(const Real &x) { return check(checks[1], x); }
+        Real guardCos(const Real &x) { return check(checks[2], x); }
+        Real guardCot(const Real &x) { return check(checks[3], x); }
+
+        //  Wrap the functions of the selected backend
+        void install(void) {
+            checks[0] = { "sin", trig.sin, librarySin, 0, 0, 0, 0, 0 };
+            checks[1] = { "asin", trig.asin, libraryAsin, 0, 0, 0, 0, 0 };
+            checks[2] = { "cos", trig.cos, libraryCos, 0, 0, 0, 0, 0 };
+            checks[3] = { "cot", trig.cot, libraryCot, 0, 0, 0, 0, 0 };
+            trig.sin = guardSin;
+            trig.asin = guardAsin;
+            trig.cos = guardCos;
+            trig.cot = guardCot;
+        }
+
+        void report(ostream &os) {
+            char line[100];
+
+            os << "Accuracy guard for " << trig.name << ", checking one call in " <<
+                Interval << ":" << endl;
+            os << "Function       Calls   Checked  Differ  Max ulp  At argument" << endl;
+            for (int i = 0; i < 4; i++) {
+                const Check &c = checks[i];
+                snprintf(line, sizeof line, "%-8s %11lu %9lu %7lu %8.2f  %.17g",
+                    c.name, c.calls, c.checked, c.differ, c.maxUlp,
+                    (double) c.worst);
+                os << line << endl;
+            }
+        }
+    }
+#endif
+
+    /*  The test case used in this program is the design
+        for a 4 inch f/12 achromatic telescope objective
+        used as the example in Wyld's classic work on ray
+        tracing by hand, given in Amateur Telescope Making,
+        Volume 3 (Volume 2 in the 1996 reprint edition).  */
+
+    namespace wyld {
+        const double ClearAperture = 4.0;
+                                        //  CurRad  Index   Disp  Edge
+        constexpr SurfacePrescription s0 = {  27.05, 1.5137, 63.6, 0.52  },
+                                      s1 = { -16.68, 1.0,     0.0, 0.138 },
+                                      s2 = { -16.68, 1.6164, 36.7, 0.38  },
+                                      s3 = { -78.1,  1.0,     0.0, 0.0   };
+    }
+
+    static Surface *newSurface(const SurfacePrescription &p) {
+        return new Surface(p.curvature_Radius, p.index_Of_Refraction,
+                           p.dispersion, p.edge_Thickness);
+    }
+
+    static Design *wyldLens(void) {
+        Design *d = new Design(wyld::ClearAperture, 4);
+        d->setSurf(0, newSurface(wyld::s0));
+        d->setSurf(1, newSurface(wyld::s1));
+        d->setSurf(2, newSurface(wyld::s2));
+        d->setSurf(3, newSurface(wyld::s3));
+        return d;
+    }
+
+    //  The same design, compiled into the ray tracer
+    typedef FixedDesign<wyld::s0, wyld::s1, wyld::s2, wyld::s3> WyldFixed;
+
+#if FLOAT_MPFR
+    /*  Precision sweep.  Evaluate the design at a range of
+        precisions, reporting the time per iteration, the number of
+        correct significant digits in the least accurate of the
+        computed results, and the number of them which differ from
+        the reference by more than half a unit in the eleventh
+        decimal place, then search for the smallest precision at
+        which none does.
+
+        The spectral lines are static, and were created with the
+        precision of a double before the default precision was set.
+        For each precision we round them from their original values
+        to the precision being tested, and create the design and its
+        evaluation anew, so all of the numbers they contain have
+        that precision.  Correct digits are measured against an
+        evaluation at twice the highest precision in the sweep.  */
+
+    class PrecisionSweep {
+    private:
+        static const int nResults = 7;
+        Wavelength *lines[8];
+        Wavelength original[8];
+
+        //  Time each precision for at least this many seconds
+        static constexpr double MinimumTime = 0.25;
+
+        //  Set working precision to the given number of bits
+        void setPrecision(int bits) {
+            mpreal::set_default_prec(bits);
+            for (int i = 0; i < 8; i++) {
+                *lines[i] = original[i];
+                lines[i]->setPrecision(bits);
+            }
+        }
+
+        //  Extract the results of an evaluation
+        static void results(const DesignEvaluation &de, Real r[nResults]) {
+            r[0] = de.dMarginalOD;
+            r[1] = de.dMarginalSA;
+            r[2] = de.dParaxialOD;
+            r[3] = de.dParaxialSA;
+            r[4] = de.longitudinalSphericalAberration;
+            r[5] = de.offenseAgainstSineCondition;
+            r[6] = de.axialChromaticAberration;
+        }
+
+        //  Evaluate once at a precision and return quantities in error
+        unsigned int validateAt(int bits, Real r[nResults] = NULL) {
+            setPrecision(bits);
+            Design *d = wyldLens();
+            unsigned int errors;
+            {
+                DesignEvaluation de(*d);
+                de.evaluate();
+                errors = de.check(PublishedTolerance);
+                if (r != NULL) {
+                    results(de, r);
+                }
+            }
+            delete d;
+            return errors;
+        }
+
+        //  Time evaluations at a precision, returning usec per iteration
+        double timeAt(int bits) {
+            setPrecision(bits);
+            Design *d = wyldLens();
+            double usec;
+            {
+                DesignEvaluation de(*d);
+                long n = 1;
+                while (true) {
+                    chrono::steady_clock::time_point start =
+                        chrono::steady_clock::now();
+                    for (long l = 0; l < n; l++) {
+                        de.evaluate();
+                    }
+                    const double elapsed = chrono::duration<double>(
+                        chrono::steady_clock::now() - start).count();
+                    if (elapsed >= MinimumTime) {
+                        usec = (elapsed * 1e6) / n;
+                        break;
+                    }
+                    n *= 2;
+                }
+            }
+            delete d;
+            return usec;
+        }
+
+        //  Correct significant decimal digits in x compared to ref
+        static double digits(const Real &x, const Real &ref) {
+            const Real err = fabs(x - ref);
+            if (err == 0) {
+                return ref.getPrecision() * log10(2.0);
+            }
+            return -log10(err / fabs(ref)).toDouble();
+        }
+
+    public:
+        PrecisionSweep() {
+            Wavelength *l[8] = {
+                &SpectralLine::A, &SpectralLine::B, &SpectralLine::C,
+                &SpectralLine::D, &SpectralLine::E, &SpectralLine::F,
+                &SpectralLine::Gprime, &SpectralLine::H
+            };
+            for (int i = 0; i < 8; i++) {
+                lines[i] = l[i];
+                original[i] = *l[i];
+            }
+        }
+
+        ~PrecisionSweep() {
+            for (int i = 0; i < 8; i++) {
+                *lines[i] = original[i];
+            }
+        }
+
+        void run(ostream &os) {
+            const static int bits[] = {
+                24, 32, 40, 48, 53, 64, 80, 96, 113, 128, 160, 192,
+                256, 384, 512, 768, 1024, 2048, 4096
+            };
+            const int nBits = sizeof bits / sizeof bits[0];
+
+            Real ref[nResults];
+            validateAt(bits[nBits - 1] * 2, ref);
+
+            os << "  Bits    usec/iter   Digits  Errors" << endl;
+            int firstPass = 0;
+            bool monotonic = true;
+            char line[80];
+            for (int i = 0; i < nBits; i++) {
+                Real r[nResults];
+                const unsigned int errors = validateAt(bits[i], r);
+                double dmin = 1e9;
+                for (int j = 0; j < nResults; j++) {
+                    const double dj = digits(r[j], ref[j]);
+                    dmin = dj < dmin ? dj : dmin;
+                }
+                const double usec = timeAt(bits[i]);
+                snprintf(line, sizeof line, "%6d %12.4f %8.1f %7u",
+                    bits[i], usec, dmin, errors);
+                os << line << endl;
+                if (errors == 0) {
+                    if (firstPass == 0) {
+                        firstPass = bits[i];
+                    }
+                } else if (firstPass != 0) {
+                    monotonic = false;
+                }
+            }
+
+            if (firstPass == 0) {
+                os << "Validation failed at all precisions." << endl;
+                return;
+            }
+
+            /*  Binary search for the smallest precision which
+                passes, between the smallest precision MPFR allows,
+                which we presume fails, and the smallest precision
+                in the sweep which passed.  This assumes that once
+                validation passes, it passes at all higher
+                precisions, which the sweep has checked at the
+                precisions it tested.  */
+
+            int lo = MPFR_PREC_MIN, hi = firstPass;
+            while (hi - lo > 1) {
+                const int mid = lo + (hi - lo) / 2;
+                if (validateAt(mid) == 0) {
+                    hi = mid;
+                } else {
+                    lo = mid;
+                }
+            }
+            os << "Minimum precision for eleven decimal places: " << hi <<
+                  " bits" << endl;
+            if (!monotonic) {
+                os << "Warning: validation failed at some precision above " <<
+                      firstPass << " bits in the sweep." << endl;
+            }
+        }
+    };
+#endif
+
+    /*  Processors the process may use, which is all of them
+        unless its affinity has been restricted.  */
+    static int processorCount(void) {
+#ifdef __linux__
+        cpu_set_t allowed;
+        if (sched_getaffinity(0, sizeof allowed, &allowed) == 0 && CPU_COUNT(&allowed) > 0) {
+            return CPU_COUNT(&allowed);
+        }
+#endif
+        const int n = (int) thread::hardware_concurrency();
+        return (n > 0) ? n : 1;
+    }
+
+    /*  Bind the calling thread to the n'th processor the process
+        may use, if the system allows it, returning the number of
+        the processor, or -1 if it isn't bound.  */
+    static int bindToProcessor(int n) {
+#ifdef __linux__
+        cpu_set_t allowed, one;
+        if (sched_getaffinity(0, sizeof allowed, &allowed) != 0) {
+            return -1;
+        }
+        for (int cpu = 0, k = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed) && k++ == n) {
+                CPU_ZERO(&one);
+                CPU_SET(cpu, &one);
+                return (pthread_setaffinity_np(pthread_self(), sizeof one, &one) == 0) ? cpu : -1;
+            }
+        }
+#else
+        (void) n;
+#endif
+        return -1;
+    }
+
+    /*  What the soak test and the throughput rate share: a baseline
+        evaluation, validated before their threads start, whose
+        results every evaluation of every thread must reproduce bit
+        for bit, and, for MPFR, the precision of the main thread,
+        which each thread must set for itself.  */
+
+    class Baseline {
+    protected:
+        Real baseline[nQuantities];
+#if FLOAT_MPFR
+        mp_prec_t precision;
+#endif
+
+        Baseline() {
+#if FLOAT_MPFR
+            precision = mpreal::get_default_prec();
+#endif
+        }
+
+        //  Prepare the calling thread to evaluate as the baseline did
+        void startThread(void) const {
+#if FLOAT_MPFR
+            mpreal::set_default_prec(precision);
+#endif
+        }
+
+        //  Evaluate and validate the baseline, returning false if it's in error
+        bool evaluateBaseline(ostream &os) {
+            Design *d = wyldLens();
+            bool valid;
+            {
+                DesignEvaluation de(*d);
+                de.evaluate();
+                valid = de.validate(os) == 0;
+                if (valid) {
+                    quantities(de, baseline);
+                } else {
+                    os << "The baseline evaluation is in error." << endl;
+                }
+            }
+            delete d;
+            return valid;
+        }
+
+        //  Are the results bit for bit those of the baseline?
+        bool same(const DesignEvaluation &de) const {
+            for (int i = 0; i < nQuantities; i++) {
+                if (!(de.*DesignEvaluation::quantity[i] == baseline[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    /*  Accuracy soak test.  Like the ACCURACY build of the C
+        version, this runs the benchmark indefinitely and checks
+        its results, but it runs a copy at once on every processor
+        the process may use, which taskset or a cpuset may restrict,
+        each thread bound to its own processor where the system
+        allows, to find machines which compute wrongly only under
+        load, or only on some of their cores.  The results of a
+        correct machine are exactly the same at every evaluation,
+        so rather than allowing a tolerance, each thread compares
+        every Interval'th evaluation with a baseline evaluated and
+        validated before the threads start, and any difference, even
+        in the last bit, is an error.  Between checks the threads
+        run the benchmark undisturbed, and share nothing they
+        write, so the test runs at the speed of the benchmark.  The
+        first mismatch is reported with the processor, thread,
+        evaluation, and time at which it was found, and stops the
+        test.  */
+
+    class Soak : private Baseline {
+    private:
+        long interval;                  // Evaluations between checks
+        long iterations;                // Per thread, or 0 to run forever
+        int nThreads;
+
+        //  Progress of each thread, on its own cache line
+        struct alignas(64) Progress {
+            atomic<long> checked;
+        };
+        vector<Progress> progress;
+        atomic<bool> stop;
+
+        //  The first mismatch, guarded by lock
+        mutex lock;
+        condition_variable finished;
+        int running;
+        bool failed;
+        string failure;
+
+        //  Local time with milliseconds, for reports
+        static string timestamp(void) {
+            const chrono::system_clock::time_point now = chrono::system_clock::now();
+            const time_t t = chrono::system_clock::to_time_t(now);
+            const long ms = (long) (chrono::duration_cast<chrono::milliseconds>(
+                now.time_since_epoch()).count() % 1000);
+            struct tm lt;
+            char b[40], s[48];
+            localtime_r(&t, &lt);
+            strftime(b, sizeof b, "%Y-%m-%d %H:%M:%S", &lt);
+            snprintf(s, sizeof s, "%s.%03ld", b, ms);
+            return s;
+        }
+
+        //  The processor on which the calling thread is running
+        static int currentCpu(void) {
+#ifdef __linux__
+            return sched_getcpu();
+#else
+            return -1;
+#endif
+        }
+
+        //  Record a mismatch, if it's the first
+        void fail(int thread, long evaluation, const DesignEvaluation &de) {
+            const string when = timestamp();
+            const int cpu = currentCpu();
+            lock_guard<mutex> l(lock);
+            if (failed) {
+                return;
+            }
+            failed = true;
+            ostringstream os;
+            os << "Mismatch on processor " << cpu << " (thread " << thread <<
+                  ") in evaluation " << evaluation << " at " << when << endl;
+            char line[120];
+            for (int i = 0; i < nQuantities; i++) {
+                const Real &x = de.*DesignEvaluation::quantity[i];
+                if (x != baseline[i]) {
+                    snprintf(line, sizeof line, "    %-34s %.17g, expected %.17g (%.4g ULPs)",
+                        quantityNames[i], intrig::approx(x, 0),
+                        intrig::approx(baseline[i], 0),
+                        ulps(intrig::approx(Real(x - baseline[i]), 0), i));
+                    os << line << endl;
+                }
+            }
+            failure = os.str();
+        }
+
+        void soak(int thread) {
+            bindToProcessor(thread);
+            startThread();
+            Design *d = wyldLens();
+            {
+                DesignEvaluation de(*d);
+                long l = 0, next = interval;
+                while (iterations == 0 || l < iterations) {
+                    de.evaluate();
+                    if (++l == next) {
+                        next += interval;
+                        if (!same(de)) {
+                            fail(thread, l, de);
+                            stop.store(true);
+                        }
+                        progress[thread].checked.store(l / interval,
+                            memory_order_relaxed);
+                        if (stop.load(memory_order_relaxed)) {
+                            break;
+                        }
+                    }
+                }
+            }
+            delete d;
+
+            lock_guard<mutex> l(lock);
+            if (--running == 0) {
+                finished.notify_one();
+            }
+        }
+
+    public:
+        Soak(long checkInterval, long iterationsPerThread) :
+            interval(checkInterval), iterations(iterationsPerThread),
+            stop(false), running(0), failed(false) {
+            nThreads = processorCount();
+        }
+
+        //  Run the test, returning the program's exit status
+        int run(ostream &os) {
+            if (!evaluateBaseline(os)) {
+                return 1;
+            }
+
+            os << timestamp() << "  Soak test on " << nThreads << " processor" <<
+                  (nThreads > 1 ? "s" : "") << ", checking every " << interval <<
+                  " evaluation" << (interval > 1 ? "s" : "");
+            if (iterations > 0) {
+                os << ", " << iterations << " evaluations each";
+            }
+            os << endl;
+
+            progress = vector<Progress>(nThreads);
+            running = nThreads;
+            vector<thread> threads;
+            for (int i = 0; i < nThreads; i++) {
+                threads.push_back(thread(&Soak::soak, this, i));
+            }
+
+            //  Report progress every minute until the threads finish
+            {
+                unique_lock<mutex> l(lock);
+                while (!finished.wait_for(l, chrono::seconds(60),
+                                          [&] { return running == 0; })) {
+                    long checks = 0;
+                    for (int i = 0; i < nThreads; i++) {
+                        checks += progress[i].checked.load(memory_order_relaxed);
+                    }
+                    os << timestamp() << "  " << checks * interval <<
+                          " evaluations, " << checks << " checked" << endl;
+                }
+            }
+            for (int i = 0; i < nThreads; i++) {
+                threads[i].join();
+            }
+
+            if (failed) {
+                os << failure;
+                return 1;
+            }
+            os << timestamp() << "  No errors in " << nThreads * (iterations / interval) <<
+                  " checked evaluations." << endl;
+            return 0;
+        }
+    };
+
+    /*  Throughput rate.  A single copy of the benchmark measures
+        the speed of one core with the rest of the machine idle, but
+        a machine's capacity is what all its cores deliver at once,
+        while they share caches, memory bandwidth, power, and
+        clock frequency.  This runs 1, 2, 4, ... copies of the
+        evaluation loop, up to the number of processors asked for,
+        each in its own thread bound to its own processor (in turn,
+        if there are more copies than processors), for the
+        same time at each step, and reports the aggregate evaluations
+        per second, the mean rate of a copy, the speedup and
+        efficiency relative to the single copy, and the slowdown of
+        the mean and the slowest copy relative to it.  The copies
+        share nothing they write: each evaluates its own Design,
+        warms up before the step starts, and counts and times its
+        own evaluations, so the threads start together and the only
+        interference among them is that of the machine.  The last
+        evaluation of every copy is compared with a validated
+        baseline, as in the soak test, so a machine which computes
+        faster by computing wrongly doesn't go unnoticed.  */
+
+    class Rate : private Baseline {
+    private:
+        int maxCopies, processors;
+        double seconds;                 // Duration of each step
+
+        //  Results of each copy, on its own cache line
+        struct alignas(64) Copy {
+            long evaluations;
+            double seconds;
+            int cpu;
+            bool correct;
+        };
+        vector<Copy> copies;
+        atomic<int> ready;
+        atomic<bool> go, stop;
+
+        void copy(int n) {
+            Copy &c = copies[n];
+            c.cpu = bindToProcessor(n % processors);
+            startThread();
+            Design *d = wyldLens();
+            {
+                DesignEvaluation de(*d);
+
+                //  Warm up while the other copies start
+                const chrono::steady_clock::time_point warm =
+                    chrono::steady_clock::now() + chrono::milliseconds(100);
+                do {
+                    de.evaluate();
+                } while (chrono::steady_clock::now() < warm);
+                ready.fetch_add(1);
+                while (!go.load(memory_order_acquire)) {
+                    this_thread::yield();
+                }
+
+                const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                long l = 0;
+                do {
+                    de.evaluate();
+                    l++;
+                } while (!stop.load(memory_order_relaxed));
+                c.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                c.evaluations = l;
+                c.correct = same(de);
+            }
+            delete d;
+        }
+
+        //  Run n copies for the duration of a step
+        void step(int n) {
+            copies = vector<Copy>(n);
+            ready.store(0);
+            go.store(false);
+            stop.store(false);
+            vector<thread> threads;
+            for (int i = 0; i < n; i++) {
+                threads.push_back(thread(&Rate::copy, this, i));
+            }
+            while (ready.load() < n) {
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+            go.store(true, memory_order_release);
+            this_thread::sleep_for(chrono::duration<double>(seconds));
+            stop.store(true);
+            for (int i = 0; i < n; i++) {
+                threads[i].join();
+            }
+        }
+
+    public:
+        //  Up to n copies, or one per processor if n is zero
+        Rate(int n, double stepSeconds) : seconds(stepSeconds), ready(0), go(false), stop(false) {
+            processors = processorCount();
+            maxCopies = (n > 0) ? n : processors;
+        }
+
+        //  Run the steps, returning the program's exit status
+        int run(ostream &os) {
+            if (!evaluateBaseline(os)) {
+                return 1;
+            }
+
+            vector<int> steps;
+            for (int n = 1; n < maxCopies; n *= 2) {
+                steps.push_back(n);
+            }
+            steps.push_back(maxCopies);
+
+            char line[120];
+            snprintf(line, sizeof line, "Throughput of up to %d cop%s on %d processor%s, %g second%s each",
+                maxCopies, (maxCopies > 1) ? "ies" : "y",
+                processors, (processors > 1) ? "s" : "", seconds, (seconds != 1) ? "s" : "");
+            os << line << endl << endl;
+            os << "Copies  Evaluations/s    Per copy/s  Speedup  Efficiency  Slowdown  Slowest" << endl;
+
+            double solo = 0;
+            int errors = 0;
+            bool unbound = false;
+            for (size_t s = 0; s < steps.size(); s++) {
+                const int n = steps[s];
+                step(n);
+                double total = 0, slowest = 0;
+                for (int i = 0; i < n; i++) {
+                    const double r = copies[i].evaluations / copies[i].seconds;
+                    total += r;
+                    if (i == 0 || r < slowest) {
+                        slowest = r;
+                    }
+                    if (!copies[i].correct) {
+                        errors++;
+                    }
+                    if (copies[i].cpu < 0) {
+                        unbound = true;
+                    }
+                }
+                const double perCopy = total / n;
+                if (n == 1) {
+                    solo = total;
+                }
+                snprintf(line, sizeof line, "%6d  %13.1f  %12.1f  %7.2f  %9.1f%%  %8.2f  %7.2f",
+                    n, total, perCopy, total / solo, 100 * total / (solo * n),
+                    solo / perCopy, solo / slowest);
+                os << line << endl;
+            }
+
+            if (maxCopies > processors) {
+                os << endl << "More copies than processors: the copies share processors." << endl;
+            } else if (unbound) {
+                os << endl << "Copies could not be bound to processors." << endl;
+            }
+            if (errors > 0) {
+                os << endl << errors << " cop" << (errors > 1 ? "ies" : "y") <<
+                      " computed results different from the baseline." << endl;
+                return 1;
+            }
+            return 0;
+        }
+    };
+
+#if FLOAT128
+    /*  Compare the fast trigonometric functions in quadtrig.h with
+        those in libquadmath, at pseudorandom arguments uniformly
+        distributed over the ranges each is designed for, reporting
+        the largest and mean difference in units in the last place
+        of the libquadmath result, and the fraction of arguments for
+        which the results are identical.  libquadmath's functions
+        are not correctly rounded either, so a difference of one
+        unit does not indicate which is in error.  */
+
+    static __float128 libCot(__float128 x) {
+        return 1 / tanq(x);
+    }
+
+    static void ulpReport(ostream &os) {
+        const static struct {
+            const char *name;
+            __float128 (*fast)(__float128);
+            __float128 (*lib)(__float128);
+            double lo, hi;
+        } tests[] = {
+            { "sin",  quadtrig::sin,  sinq,   -0.25, 0.25 },
+            { "sin",  quadtrig::sin,  sinq,   -M_PI_4, M_PI_4 },
+            { "sin",  quadtrig::sin,  sinq,   -8, 8 },
+            { "cos",  quadtrig::cos,  cosq,   -0.25, 0.25 },
+            { "cos",  quadtrig::cos,  cosq,   -M_PI_4, M_PI_4 },
+            { "cos",  quadtrig::cos,  cosq,   -8, 8 },
+            { "tan",  quadtrig::tan,  tanq,   -0.25, 0.25 },
+            { "tan",  quadtrig::tan,  tanq,   -1.5, 1.5 },
+            { "cot",  quadtrig::cot,  libCot, -0.25, 0.25 },
+            { "cot",  quadtrig::cot,  libCot, -1.5, 1.5 },
+            { "asin", quadtrig::asin, asinq,  -0.75, 0.75 },
+            { "asin", quadtrig::asin, asinq,  -1, 1 }
+        };
+        const int samples = 100000;
+        char line[80];
+
+        os << "Function  Range               Max ulp  Mean ulp  Identical" << endl;
+        for (unsigned int i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+            srand48(1);
+            double maxUlp = 0, sumUlp = 0;
+            int same = 0;
+            for (int j = 0; j < samples; j++) {
+                const __float128 u = drand48() + ldexp(drand48(), -53),
+                                 x = tests[i].lo + (tests[i].hi - tests[i].lo) * u;
+                const __float128 f = tests[i].fast(x),
+                                 l = tests[i].lib(x);
+                if (f == l) {
+                    same++;
+                    continue;
+                }
+                const double ulp = (double) (fabsq(f - l) /
+                    scalbnq(1, ilogbq(l) - (FLT128_MANT_DIG - 1)));
+                maxUlp = ulp > maxUlp ? ulp : maxUlp;
+                sumUlp += ulp;
+            }
+            snprintf(line, sizeof line, "%-8s [%7.4f, %7.4f] %8.2f  %8.3f  %8.1f%%",
+                tests[i].name, tests[i].lo, tests[i].hi, maxUlp,
+                sumUlp / samples, (100.0 * same) / samples);
+            os << line << endl;
+        }
+    }
+#endif
+
+    static void usage(void) {
+        cerr << "Usage: fbench [options] [iterations]" << endl <<
+                "Options:" << endl <<
+#ifdef Uses_GMP
+                "    -alloc        Report allocations and time per evaluate()" << endl <<
+                "    -pool         Use pooled allocator for GMP and MPFR" << endl <<
+                "    -poolcompare  Compare pooled allocator with malloc" << endl <<
+#endif
+#if FLOAT_MPFR
+                "    -sweep        Time and validate a range of precisions" << endl <<
+#endif
+#if FLOAT128
+                "    -ulp          Compare trigonometric functions with libquadmath" << endl <<
+#endif
+                "    -trig name    Use the named trigonometric functions:" << endl;
+        listTrig(cerr);
+        cerr << "    -trigcompare  Time and validate all trigonometric functions" << endl <<
+                "    -count        Count calls on trigonometric functions" << endl <<
+                "    -reduce       Trace with fewer trigonometric functions" << endl <<
+                "    -reduceaudit  Compare -reduce with the standard ray trace" << endl <<
+                "    -fixed        Trace with the design compiled into the program" << endl <<
+                "    -fixedcompare Compare -fixed with the run-time design" << endl <<
+                "    -accuracy     Report the error of each result in ULPs and digits" << endl <<
+                "    -verify       Check the results of every evaluation" << endl <<
+                "    -soak n       Run on every processor, checking every n'th evaluation" << endl <<
+                "    -rate n       Throughput of 1, 2, 4, ... n copies (0: all processors)" << endl <<
+                "    -repeat k     Time k repetitions and report their statistics" << endl <<
+                "    -warmup n     Evaluations before timing -repeat (iterations / 10)" << endl <<
+                "    -duration s   Calibrate iterations to run for s seconds (-rate: per step)" << endl <<
+                "    -perf         Report hardware performance counters" << endl <<
+                "    -json f       Append the results and their provenance to f as JSON" << endl <<
+                "    -csv f        Append the results and their provenance to f as CSV" << endl <<
+                "    -tasks        Trace the rays of each evaluation in parallel" << endl <<
+                "    -taskcompare  Compare -tasks with tracing in sequence" << endl <<
+#ifdef Uses_tabletrig
+                "    -guard        Check trigonometric functions against library" << endl <<
+#endif
+#if PHASE_TIMERS
+                "    -phases       Report the time spent in each phase" << endl <<
+                "    -phasetrace f Write phases of first evaluations as Chrome trace f" << endl <<
+#endif
+#if FLOAT_COUNTED
+                "    -ops          Report the operations of each phase per evaluate()" << endl <<
+                "    -opstime us   With -ops, report MFLOPS at us usec per evaluate()" << endl <<
+#endif
+#if FLOAT_SHADOW
+                "    -shadow       Report the error of each surface and operation" << endl <<
+#endif
+                "    -help         Print this message" << endl;
     }
 
     int main(int argc, char *argv[]) {
 
         long iterations = 1000000;
+#ifdef Uses_GMP
+        bool countAllocations = false, usePool = false, comparePool = false;
+#endif
+#if FLOAT_MPFR
+        bool sweepPrecision = false;
+#endif
+        const char *trigName = DefaultTrig;
+        bool compareTrigFunctions = false, countTrig = false, auditReduce = false,
+             useFixed = false, compareFixedDesign = false,
+             useTasks = false, compareTasks = false, reportAccuracy = false,
+             verifyEach = false, iterationsGiven = false, perf = false;
+        long soakInterval = 0, warmup = -1;
+        int rateCopies = -1;
+        const char *jsonFile = NULL, *csvFile = NULL;
+        double duration = 0;
+        int repetitions = 0;
+#ifdef Uses_tabletrig
+        bool guardTrig = false;
+#endif
+#if PHASE_TIMERS
+        bool reportPhases = false;
+        const char *phaseTrace = NULL;
+#endif
+#if FLOAT_COUNTED
+        bool reportOps = false;
+        double opsTime = 0;
+#endif
+#if FLOAT_SHADOW
+        bool reportShadow = false;
+#endif
 
-        if (argc > 1) {
-            iterations = atol(argv[1]);
+        for (int i = 1; i < argc; i++) {
+            if (argv[i][0] == '-') {
+                if (strcmp(argv[i], "-trig") == 0 && i + 1 < argc) {
+                    trigName = argv[++i];
+                    continue;
+                }
+                if (strcmp(argv[i], "-trigcompare") == 0) {
+                    compareTrigFunctions = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-count") == 0) {
+                    countTrig = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-reduce") == 0) {
+                    TraceContext::reduced = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-reduceaudit") == 0) {
+                    auditReduce = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-fixed") == 0) {
+                    useFixed = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-fixedcompare") == 0) {
+                    compareFixedDesign = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-accuracy") == 0) {
+                    reportAccuracy = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-soak") == 0 && i + 1 < argc) {
+                    soakInterval = atol(argv[++i]);
+                    if (soakInterval < 1) {
+                        cerr << "fbench: -soak interval must be at least 1" << endl;
+                        return 2;
+                    }
+                    continue;
+                }
+                if (strcmp(argv[i], "-rate") == 0 && i + 1 < argc) {
+                    rateCopies = atoi(argv[++i]);
+                    if (rateCopies < 0) {
+                        cerr << "fbench: -rate copies must be zero or more" << endl;
+                        return 2;
+                    }
+                    continue;
+                }
+                if (strcmp(argv[i], "-repeat") == 0 && i + 1 < argc) {
+                    repetitions = atoi(argv[++i]);
+                    continue;
+                }
+                if (strcmp(argv[i], "-warmup") == 0 && i + 1 < argc) {
+                    warmup = atol(argv[++i]);
+                    continue;
+                }
+                if (strcmp(argv[i], "-duration") == 0 && i + 1 < argc) {
+                    duration = atof(argv[++i]);
+                    if (!(duration > 0)) {
+                        cerr << "fbench: -duration must be greater than zero" << endl;
+                        return 2;
+                    }
+                    continue;
+                }
+                if (strcmp(argv[i], "-perf") == 0) {
+                    perf = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-json") == 0 && i + 1 < argc) {
+                    jsonFile = argv[++i];
+                    continue;
+                }
+                if (strcmp(argv[i], "-csv") == 0 && i + 1 < argc) {
+                    csvFile = argv[++i];
+                    continue;
+                }
+                if (strcmp(argv[i], "-verify") == 0) {
+                    verifyEach = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-tasks") == 0) {
+                    useTasks = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-taskcompare") == 0) {
+                    compareTasks = true;
+                    continue;
+                }
+#ifdef Uses_tabletrig
+                if (strcmp(argv[i], "-guard") == 0) {
+                    guardTrig = true;
+                    continue;
+                }
+#endif
+#if PHASE_TIMERS
+                if (strcmp(argv[i], "-phases") == 0) {
+                    reportPhases = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-phasetrace") == 0 && i + 1 < argc) {
+                    phaseTrace = argv[++i];
+                    continue;
+                }
+#endif
+#if FLOAT_COUNTED
+                if (strcmp(argv[i], "-ops") == 0) {
+                    reportOps = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-opstime") == 0 && i + 1 < argc) {
+                    opsTime = atof(argv[++i]);
+                    continue;
+                }
+#endif
+#if FLOAT_SHADOW
+                if (strcmp(argv[i], "-shadow") == 0) {
+                    reportShadow = true;
+                    continue;
+                }
+#endif
+#ifdef Uses_GMP
+                if (strcmp(argv[i], "-alloc") == 0) {
+                    countAllocations = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-pool") == 0) {
+                    usePool = true;
+                    continue;
+                }
+                if (strcmp(argv[i], "-poolcompare") == 0) {
+                    comparePool = true;
+                    continue;
+                }
+#endif
+#if FLOAT_MPFR
+                if (strcmp(argv[i], "-sweep") == 0) {
+                    sweepPrecision = true;
+                    continue;
+                }
+#endif
+#if FLOAT128
+                if (strcmp(argv[i], "-ulp") == 0) {
+                    ulpReport(cout);
+                    return 0;
+                }
+#endif
+                if (strcmp(argv[i], "-help") != 0) {
+                    cerr << "fbench: unknown option " << argv[i] << endl;
+                }
+                usage();
+                return 2;
+            }
+            iterations = atol(argv[i]);
+            iterationsGiven = true;
+        }
+
+        if (!findTrig(trigName, trig)) {
+            cerr << "fbench: unknown trigonometric functions " << trigName << endl;
+            usage();
+            return 2;
+        }
+
+        /*  The counters kept by these options are not safe to
+            update from several threads at once.  */
+        bool counting = countTrig || auditReduce;
+#ifdef Uses_tabletrig
+        counting = counting || guardTrig;
+#endif
+#if PHASE_TIMERS
+        counting = counting || reportPhases || phaseTrace != NULL;
+#endif
+#if FLOAT_COUNTED || FLOAT_SHADOW
+        counting = true;            // Every operation
+#endif
+#ifdef Uses_GMP
+        counting = counting || countAllocations || comparePool;
+#endif
+        const bool rate = rateCopies >= 0;
+        if ((useTasks || compareTasks || soakInterval > 0 || rate) && counting) {
+            cerr << "fbench: -tasks, -taskcompare, -soak, and -rate cannot be used with options which count" << endl;
+            return 2;
+        }
+        if (duration > 0 && !rate && (counting || iterationsGiven || verifyEach || soakInterval > 0 ||
+                             compareFixedDesign || compareTasks || compareTrigFunctions)) {
+            cerr << "fbench: -duration replaces the iteration count, and applies only to timing runs" << endl;
+            return 2;
+        }
+        if (perf && (useTasks || verifyEach || soakInterval > 0 || compareFixedDesign ||
+                     compareTasks || compareTrigFunctions || auditReduce)) {
+            cerr << "fbench: -perf counts the evaluating thread of timing runs only" << endl;
+            return 2;
+        }
+#ifdef Uses_GMP
+        if (perf && comparePool) {
+            cerr << "fbench: -perf counts the evaluating thread of timing runs only" << endl;
+            return 2;
+        }
+#endif
+#if FLOAT_MPFR
+        if (perf && sweepPrecision) {
+            cerr << "fbench: -perf counts the evaluating thread of timing runs only" << endl;
+            return 2;
+        }
+#endif
+        const bool record = jsonFile != NULL || csvFile != NULL;
+        if (record && (soakInterval > 0 || compareFixedDesign || compareTasks ||
+                       compareTrigFunctions || auditReduce)) {
+            cerr << "fbench: -json and -csv record timing and verification runs only" << endl;
+            return 2;
+        }
+#ifdef Uses_GMP
+        if (record && comparePool) {
+            cerr << "fbench: -json and -csv record timing and verification runs only" << endl;
+            return 2;
+        }
+#endif
+#if FLOAT_MPFR
+        if (record && sweepPrecision) {
+            cerr << "fbench: -json and -csv record timing and verification runs only" << endl;
+            return 2;
+        }
+#endif
+        if ((useTasks || compareTasks) && soakInterval > 0) {
+            cerr << "fbench: -soak runs its own threads and cannot be used with -tasks" << endl;
+            return 2;
+        }
+        if (rate && (iterationsGiven || verifyEach || reportAccuracy || repetitions > 0 || perf || record ||
+                     useTasks || soakInterval > 0 || compareFixedDesign || compareTasks ||
+                     compareTrigFunctions || auditReduce)) {
+            cerr << "fbench: -rate runs its own timed copies, and takes only -duration and options which select how they trace" << endl;
+            return 2;
+        }
+
+        /*  Workers for the rays other than the one traced by the
+            thread which evaluates the design, created once for
+            all evaluations.  */
+        taskpool::Pool pool((useTasks || compareTasks) ? DesignEvaluation::nTraces - 1 : 0);
+        if (useTasks) {
+            DesignEvaluation::parallel = &pool;
+        }
+#ifdef Uses_tabletrig
+        if (guardTrig) {
+            trigGuard::install();
+        }
+#endif
+        if (countTrig) {
+            trigCount::install();
+        }
+#if PHASE_TIMERS
+        if (reportPhases || phaseTrace != NULL) {
+            trigPhase::install();
+        }
+#endif
+
+#ifdef Uses_GMP
+        if (usePool && !comparePool) {
+            installPool();
+        }
+        if (countAllocations || comparePool) {
+            allocCount::install();
         }
+#endif
 
 #if FLOAT_MPFR
+        if (sweepPrecision) {
+            PrecisionSweep().run(cout);
+            return 0;
+        }
+
         mpreal::set_default_prec(MPFR_PRECISION);
+
+        /*  The spectral lines were created with the precision of a
+            double, and the dispersion of a ray's wavelength would be
+            computed in that precision unless they're extended to
+            the working precision.  */
+        Wavelength *lines[] = {
+            &SpectralLine::A, &SpectralLine::B, &SpectralLine::C,
+            &SpectralLine::D, &SpectralLine::E, &SpectralLine::F,
+            &SpectralLine::Gprime, &SpectralLine::H
+        };
+        for (unsigned int i = 0; i < sizeof lines / sizeof lines[0]; i++) {
+            lines[i]->setPrecision(MPFR_PRECISION);
+        }
 #endif
 
-        /*  The test case used in this program is the design
-            for a 4 inch f/12 achromatic telescope objective
-            used as the example in Wyld's classic work on ray
-            tracing by hand, given in Amateur Telescope Making,
-            Volume 3 (Volume 2 in the 1996 reprint edition).  */
+        if (soakInterval > 0) {
+            return Soak(soakInterval, iterationsGiven ? iterations : 0).run(cout);
+        }
 
-        Design WyldLens(4.0, 4);
-                               //        CurRad  Index   Disp  Edge
-        WyldLens.setSurf(0, new Surface(  27.05, 1.5137, 63.6, 0.52 ));
-        WyldLens.setSurf(1, new Surface( -16.68, 1.0,     0.0, 0.138));
-        WyldLens.setSurf(2, new Surface( -16.68, 1.6164, 36.7, 0.38 ));
-        WyldLens.setSurf(3, new Surface( -78.1,  1.0,     0.0, 0.0  ));
-//WyldLens.show(cout);
+        Design *WyldLens = wyldLens();
+//WyldLens->show(cout);
 
-        DesignEvaluation de(WyldLens);
-        for (long l = 0; l < iterations; l++) {
-            de.evaluate();
+        if ((useFixed || compareFixedDesign) && !WyldFixed::matches(*WyldLens)) {
+            cerr << "fbench: the compiled design differs from the run-time design" << endl;
+            delete WyldLens;
+            return 2;
+        }
+        if (useFixed) {
+            TraceContext::fixed = WyldFixed::trace;
+        }
+        if (rate) {
+            delete WyldLens;
+            return Rate(rateCopies, (duration > 0) ? duration : 5).run(cout);
+        }
+
+        DesignEvaluation de(*WyldLens);
+        perfcount::Counters *perfCounters = perf ? new perfcount::Counters : NULL;
+        counters = perfCounters;
+        if (compareFixedDesign && iterations > 0) {
+            compareFixed(cout, de, iterations, WyldFixed::trace);
+            delete WyldLens;
+            return 0;
+        }
+        if (compareTasks && iterations > 0) {
+            compareParallel(cout, de, iterations, &pool);
+            delete WyldLens;
+            return 0;
+        }
+        if (compareTrigFunctions && iterations > 0) {
+            compareTrig(cout, de, iterations);
+            delete WyldLens;
+            return 0;
+        }
+        if (auditReduce && iterations > 0) {
+            auditReduced(cout, de, iterations);
+            delete WyldLens;
+            return 0;
+        }
+        if (duration > 0 && repetitions > 0) {
+            iterations = calibrateIterations(de, duration / repetitions);
+        }
+#if PHASE_TIMERS
+        phasetimer::reset((phaseTrace != NULL) ? PhaseTraceEvents : 0);
+#endif
+#if FLOAT_COUNTED
+        opcount::reset();
+#endif
+#if FLOAT_SHADOW
+        shadow::reset();
+#endif
+        //  Time and statistics of the run, for -json and -csv
+        double timed = -1;
+        timestats::Summary stats;
+        const timestats::Summary *runStats = NULL;
+        const char *mode = "iterations";
+        long failures = 0;
+        if (verifyEach) {
+            mode = "verify";
+            failures = verifyEvaluations(de, iterations);
+            if (failures > 0) {
+                cout << failures << " of " << iterations <<
+                    " evaluations in error.  This is VERY SERIOUS." << endl;
+            }
+        } else if (repetitions > 0 && iterations > 0) {
+            mode = "repeat";
+            const double elapsed = timeRepetitions(cout, de, iterations, repetitions,
+                (warmup >= 0) ? warmup : iterations / 10, &stats);
+            timed = (stats.mean * iterations * repetitions) / 1e6;
+            runStats = &stats;
+#ifdef Uses_GMP
+            if (countAllocations) {
+                allocCount::report(NULL, iterations, elapsed);
+            }
+#else
+            (void) elapsed;
+#endif
+        } else if (duration > 0) {
+            mode = "duration";
+            iterations = timeDuration(cout, de, duration, &timed);
+        } else {
+#ifdef Uses_GMP
+            if (comparePool && iterations > 0) {
+
+                /*  Run the benchmark with the default allocator, then
+                    install the pooled allocator beneath the counters
+                    and run it again.  */
+
+                const double tMalloc = timeEvaluations(de, iterations);
+                allocCount::report("malloc", iterations, tMalloc);
+                installPool();
+                allocCount::install();
+                const double tPool = timeEvaluations(de, iterations);
+                allocCount::report("Pooled", iterations, tPool);
+                printf("Pooled time / malloc time:    %.4f\n", tPool / tMalloc);
+            } else {
+                const double elapsed = timed = timeEvaluations(de, iterations);
+                if (countAllocations && iterations > 0) {
+                    allocCount::report(NULL, iterations, elapsed);
+                }
+            }
+#else
+            if (perf || record) {
+                timed = timeEvaluations(de, iterations);
+            } else {
+                for (long l = 0; l < iterations; l++) {
+                    de.evaluate();
+                }
+            }
+#endif
         }
+#if FLOAT_COUNTED
+        //  Operations of the evaluations, not of the report which follows
+        const opcount::Tally evaluationOps = opcount::tally();
+#endif
+#if FLOAT_SHADOW
+        //  Errors of the evaluations, not of the report which follows
+        const shadow::Tally *evaluationErrors = new shadow::Tally(shadow::tally());
+#endif
         de.report();
 //de.print(cout);
         unsigned int errors;
@@ -670,6 +3643,69 @@
         } else {
            cout << "No errors in results." << endl;
         }
+        if (reportAccuracy) {
+            de.accuracy(cout);
+        }
+#ifdef Uses_tabletrig
+        if (guardTrig) {
+            trigGuard::report(cout);
+        }
+#endif
+        if (countTrig && iterations > 0) {
+            trigCount::report(cout, iterations);
+        }
+#if PHASE_TIMERS
+        if (reportPhases) {
+            phasetimer::report(cout);
+        }
+        if (phaseTrace != NULL && !phasetimer::trace(phaseTrace)) {
+            cerr << "fbench: cannot write " << phaseTrace << endl;
+        }
+#endif
+#if FLOAT_COUNTED
+        if (reportOps && iterations > 0) {
+            opcount::report(cout, evaluationOps, iterations);
+            if (opsTime > 0) {
+                const double flops = (double) evaluationOps.flops(-1) / iterations;
+                double calls = 0;
+                for (int j = opcount::Sqrt; j < opcount::nOperations; j++) {
+                    calls += (double) evaluationOps.count(-1, j) / iterations;
+                }
+                printf("At %.4f usec per evaluate(): %.1f MFLOPS", opsTime, flops / opsTime);
+                if (calls > 0) {
+                    printf(", %.1f million function calls per second", calls / opsTime);
+                }
+                printf("\n");
+            }
+        }
+#endif
+#if FLOAT_SHADOW
+        if (reportShadow && iterations > 0) {
+            static const char *const rays[DesignEvaluation::nTraces] = {
+                "Marginal D", "Paraxial D", "Marginal C", "Marginal F"
+            };
+            shadow::report(cout, *evaluationErrors, rays, DesignEvaluation::nTraces,
+                "Aberrations");
+        }
+        delete evaluationErrors;
+#endif
+        if (perfCounters != NULL) {
+            counters = NULL;
+            perfCounters->report(cout, "transit",
+                DesignEvaluation::nTraces * WyldLens->nSurfaces);
+            delete perfCounters;
+        }
+        if (record) {
+            const results::Record r = runRecord(argc, argv, mode, iterations, repetitions,
+                timed, runStats, verifyEach ? (unsigned int) failures : errors);
+            if (jsonFile != NULL && !results::appendJSON(jsonFile, r)) {
+                cerr << "fbench: cannot write " << jsonFile << endl;
+            }
+            if (csvFile != NULL && !results::appendCSV(csvFile, r)) {
+                cerr << "fbench: cannot write " << csvFile << endl;
+            }
+        }
 
+        delete WyldLens;
         return 0;
     }
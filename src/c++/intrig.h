@@ -0,0 +1,257 @@
+/*  Internal trigonometric functions for any Real type
+
+    These are the functions the C version of the benchmark uses
+    when compiled with INTRIG defined, recast as templates which
+    may be instantiated for any of the types fbench.cpp supports.
+    They compute the sine, cosine, tangent, arc tangent, and arc
+    sine by range reduction and polynomial or rational
+    approximation, and the square root by Newton-Raphson
+    iteration, using only the four arithmetic operations and
+    comparison, so timings made with them reflect the speed of a
+    type's arithmetic rather than that of its library of
+    mathematical functions.
+
+    The constants and coefficients are those of the C version,
+    which are accurate to double precision, and they are used as
+    double in mixed arithmetic with the Real type, so the results
+    are no more accurate than double regardless of the precision
+    of the type.  (The square root, being computed by iteration
+    to convergence, is accurate to the full precision of the
+    type.)  This is sufficient to reproduce the eleven decimal
+    places the benchmark checks.
+
+    The only operations required of a type T are construction
+    from double, the arithmetic operators and comparisons with T
+    and double operands, unary minus, and conversion to double,
+    either by a cast or a toDouble() member function.
+
+    Math<T> collects the functions as static members, so a
+    choice of functions may be passed as a template argument.
+    None of the functions keeps any state, so they may be called
+    from any thread and applied independently to the elements of
+    an array.  */
+
+#ifndef INTRIG_H
+#define INTRIG_H
+
+#include <stdexcept>
+
+namespace intrig {
+
+    //  Commonly used constants
+    const double Pi = 3.1415926535897932,
+                 TwoPi = Pi * 2.0,
+                 PiOver4 = Pi / 4.0,
+                 FourOverPi = 4.0 / Pi,
+                 PiOver2 = Pi / 2.0;
+
+    //  Coefficients for atan() evaluation
+    const double atanc[] = {
+        0.0,
+        0.4636476090008061165,
+        0.7853981633974483094,
+        0.98279372324732906714,
+        1.1071487177940905022,
+        1.1902899496825317322,
+        1.2490457723982544262,
+        1.2924966677897852673,
+        1.3258176636680324644
+    };
+
+    /*  Approximate value as a double, from a toDouble() member
+        function if the type has one, and a cast otherwise.  */
+    template <class T> inline auto approx(const T &x, int) -> decltype(x.toDouble()) {
+        return x.toDouble();
+    }
+
+    template <class T> inline double approx(const T &x, long) {
+        return (double) x;
+    }
+
+    /*  Integer part of x, truncated towards zero.  The double
+        approximation may round to the next integer away from
+        zero, so we correct the result if it did.  Like the C
+        version, this cannot handle numbers beyond the range of
+        a long.  */
+    template <class T> inline long truncate(const T &x) {
+        long l = (long) approx(x, 0);
+        if (x >= 0.0) {
+            if (x < (double) l) {
+                l--;
+            }
+        } else {
+            if (x > (double) l) {
+                l++;
+            }
+        }
+        return l;
+    }
+
+    template <class T> inline T aint(const T &x) {
+        return T((double) truncate(x));
+    }
+
+    //  sin(x)        Return sine, x in radians
+    template <class T> inline T sin(T x) {
+        T y, r, z;
+
+        bool sign = x < 0.0;
+        if (sign) {
+            x = -x;
+        }
+
+        if (x > TwoPi) {
+            x -= aint(x / TwoPi) * TwoPi;
+        }
+
+        if (x > Pi) {
+            x -= Pi;
+            sign = !sign;
+        }
+
+        if (x > PiOver2) {
+            x = Pi - x;
+        }
+
+        if (x < PiOver4) {
+            y = x * FourOverPi;
+            z = y * y;
+            r = y * (((((((-0.202253129293E-13 * z + 0.69481520350522E-11) * z -
+                0.17572474176170806E-8) * z + 0.313361688917325348E-6) * z -
+                0.365762041821464001E-4) * z + 0.249039457019271628E-2) * z -
+                0.0807455121882807815) * z + 0.785398163397448310);
+        } else {
+            y = (PiOver2 - x) * FourOverPi;
+            z = y * y;
+            r = ((((((-0.38577620372E-12 * z + 0.11500497024263E-9) * z -
+                0.2461136382637005E-7) * z + 0.359086044588581953E-5) * z -
+                0.325991886926687550E-3) * z + 0.0158543442438154109) * z -
+                0.308425137534042452) * z + 1.0;
+        }
+        return sign ? T(-r) : r;
+    }
+
+    //  cos(x)        Return cosine, x in radians, by identity
+    template <class T> inline T cos(T x) {
+        if (x < 0.0) {
+            x = -x;
+        }
+        if (x > TwoPi) {                //  Do range reduction here to limit
+            x -= aint(x / TwoPi) * TwoPi;   //  roundoff on add of pi/2
+        }
+        return intrig::sin(T(x + PiOver2));
+    }
+
+    //  tan(x)        Return tangent, x in radians, by identity
+    template <class T> inline T tan(const T &x) {
+        return intrig::sin(x) / intrig::cos(x);
+    }
+
+    //  cot(x)        Return cotangent, x in radians, by identity
+    template <class T> inline T cot(const T &x) {
+        return 1.0 / intrig::tan(x);
+    }
+
+    /*  sqrt(x)       Return square root.  Initial guess, then
+                      Newton-Raphson refinement  */
+    template <class T> inline T sqrt(const T &x) {
+        T c, cl, y;
+
+        if (x == 0.0) {
+            return T(0.0);
+        }
+
+        if (x < 0.0) {
+            throw std::domain_error("intrig::sqrt: argument is negative");
+        }
+
+        y = (0.154116 + 1.893872 * x) / (1.0 + 1.047988 * x);
+
+        c = (y - x / y) / 2.0;
+        cl = 0.0;
+        for (int n = 50; c != cl && n--; ) {
+            y = y - c;
+            cl = c;
+            c = (y - x / y) / 2.0;
+        }
+        return y;
+    }
+
+    /*  atan(x)       Return arctangent in radians,
+                      range -pi/2 to pi/2  */
+    template <class T> inline T atan(T x) {
+        T a, b, z;
+        int y = 0;
+        bool inverted = false;
+
+        const bool sign = x < 0.0;
+        if (sign) {
+            x = -x;
+        }
+
+        if (x >= 4.0) {
+            inverted = true;
+            x = 1.0 / x;
+        } else if (!(x < 0.25)) {
+            y = (int) truncate(T(x / 0.5));
+            z = y * 0.5;
+            x = (x - z) / (x * z + 1.0);
+        }
+
+        z = x * x;
+        b = ((((893025.0 * z + 49116375.0) * z + 425675250.0) * z +
+            1277025750.0) * z + 1550674125.0) * z + 654729075.0;
+        a = (((13852575.0 * z + 216602100.0) * z + 891080190.0) * z +
+            1332431100.0) * z + 654729075.0;
+        a = (a / b) * x + atanc[y];
+        if (inverted) {
+            a = PiOver2 - a;
+        }
+        return sign ? T(-a) : a;
+    }
+
+    /*  atan2(y,x)    Return arctangent in radians of y/x,
+                      range -pi to pi  */
+    template <class T> inline T atan2(const T &y, const T &x) {
+        if (x == 0.0) {
+            if (y == 0.0) {         //  Special case: atan2(0,0) = 0
+                return T(0.0);
+            } else if (y > 0.0) {
+                return T(PiOver2);
+            } else {
+                return T(-PiOver2);
+            }
+        }
+        T temp = intrig::atan(T(y / x));
+        if (x < 0.0) {
+            if (y >= 0.0) {
+                temp += Pi;
+            } else {
+                temp -= Pi;
+            }
+        }
+        return temp;
+    }
+
+    //  asin(x)       Return arcsine in radians of x
+    template <class T> inline T asin(const T &x) {
+        if (x > 1.0 || x < -1.0) {
+            throw std::domain_error("intrig::asin: argument is greater than 1 in magnitude");
+        }
+        return intrig::atan2(x, intrig::sqrt(T(1.0 - x * x)));
+    }
+
+    //  The functions as a policy for the type T
+    template <class T> struct Math {
+        static T sin(const T &x) { return intrig::sin(x); }
+        static T cos(const T &x) { return intrig::cos(x); }
+        static T tan(const T &x) { return intrig::tan(x); }
+        static T cot(const T &x) { return intrig::cot(x); }
+        static T asin(const T &x) { return intrig::asin(x); }
+        static T atan(const T &x) { return intrig::atan(x); }
+        static T atan2(const T &y, const T &x) { return intrig::atan2(y, x); }
+        static T sqrt(const T &x) { return intrig::sqrt(x); }
+    };
+}
+
+#endif
@@ -0,0 +1,171 @@
+/*  Trigonometric kernels with generated minimax polynomials
+
+    These functions evaluate the sine, cosine, cotangent, arc
+    sine, and arc tangent of small arguments with polynomials
+
+        sin(x)  = x + x^3 P(x^2)
+        cos(x)  = 1 - x^2/2 + x^4 P(x^2)
+        asin(x) = x + x^3 P(x^2)
+        atan(x) = x + x^3 P(x^2)
+
+    whose coefficients are found for each type by remez.cpp and
+    kept in minimaxcoeff.h, which the Makefile generates from the
+    specifications in MINIMAX.  Each polynomial is the one of
+    lowest degree whose error, with its coefficients rounded to the
+    type, is within the number of units in the last place given
+    in its specification, so a type with more precision gets more
+    terms and no type pays for more than it needs.  For ddreal
+    and __float128, whose arithmetic is done in software, the
+    generator also moves as many of the high order terms as it
+    can, while still meeting the target, to a tail evaluated in
+    double or long double hardware arithmetic, as quadtrig.h does
+    by hand.  The cotangent is the quotient of the cosine and
+    sine.
+
+    Arguments larger in magnitude than the limit of a polynomial
+    are passed to the type's library function.  Coefficients may
+    be generated for float, double, long double, ddreal, and
+    __float128.  The last two are declared only if ddreal.h or
+    <quadmath.h> has been included before this file.  Using a
+    function for which no polynomial was generated for the type
+    is an error at compile time.  */
+
+#ifndef MINIMAX_H
+#define MINIMAX_H
+
+#include <cmath>
+#include <cstddef>
+
+namespace minimax {
+
+    /*  A polynomial in x^2, valid for |x| <= limit, whose high
+        order terms may be evaluated in a faster type U with less
+        precision.  */
+    template <class T, class U = T> struct Polynomial {
+        const T *c;                     // Coefficients, constant term first
+        int n;                          // Number of coefficients
+        const U *tail;                  // Coefficients following c in U
+        int nt;                         // Number of tail coefficients
+        double limit;                   // Largest argument magnitude
+    };
+
+    /*  Polynomials for type T, defined in minimaxcoeff.h, with
+        the type Tail in which their tails are evaluated.  */
+    template <class T> struct Coefficients;
+
+    //  x converted to the type in which tails are evaluated
+    template <class U, class T> inline U narrow(const T &x) {
+        return (U) x;
+    }
+
+#ifdef DDREAL_H
+    template <class U> inline U narrow(const ddqd::ddreal &x) {
+        return (U) x.toDouble();
+    }
+#endif
+
+    //  Library functions for arguments beyond the polynomials
+    namespace library {
+        template <class T> inline T sin(const T &x) { return std::sin(x); }
+        template <class T> inline T cos(const T &x) { return std::cos(x); }
+        template <class T> inline T tan(const T &x) { return std::tan(x); }
+        template <class T> inline T asin(const T &x) { return std::asin(x); }
+        template <class T> inline T atan(const T &x) { return std::atan(x); }
+
+#ifdef QUADMATH_H
+        inline __float128 sin(const __float128 &x) { return sinq(x); }
+        inline __float128 cos(const __float128 &x) { return cosq(x); }
+        inline __float128 tan(const __float128 &x) { return tanq(x); }
+        inline __float128 asin(const __float128 &x) { return asinq(x); }
+        inline __float128 atan(const __float128 &x) { return atanq(x); }
+#endif
+
+#ifdef DDREAL_H
+        inline ddqd::ddreal sin(const ddqd::ddreal &x) { return ddqd::sin(x); }
+        inline ddqd::ddreal cos(const ddqd::ddreal &x) { return ddqd::cos(x); }
+        inline ddqd::ddreal tan(const ddqd::ddreal &x) { return ddqd::tan(x); }
+        inline ddqd::ddreal asin(const ddqd::ddreal &x) { return ddqd::asin(x); }
+        inline ddqd::ddreal atan(const ddqd::ddreal &x) {
+            return ddqd::asin(x / ddqd::sqrt(1.0 + x * x));
+        }
+#endif
+    }
+}
+
+#include "minimaxcoeff.h"
+
+namespace minimax {
+
+    template <class T, class U> inline bool within(const T &x, const Polynomial<T, U> &p) {
+        return x <= p.limit && x >= -p.limit;
+    }
+
+    //  Evaluate p at t by Horner's rule, starting with the tail
+    template <class T, class U> inline T evaluate(const Polynomial<T, U> &p, const T &t) {
+        T s;
+        int i = p.n - 1;
+        if (p.nt > 0) {
+            const U tu = narrow<U>(t);
+            U st = p.tail[p.nt - 1];
+            for (int j = p.nt - 2; j >= 0; j--) {
+                st = st * tu + p.tail[j];
+            }
+            s = T(st);
+        } else {
+            s = p.c[i--];
+        }
+        for (; i >= 0; i--) {
+            s = s * t + p.c[i];
+        }
+        return s;
+    }
+
+    template <class T> inline T sin(const T &x) {
+        const auto &p = Coefficients<T>::Sin;
+        if (!within(x, p)) {
+            return library::sin(x);
+        }
+        const T t = x * x;
+        return x + (x * t) * evaluate(p, t);
+    }
+
+    template <class T> inline T cos(const T &x) {
+        const auto &p = Coefficients<T>::Cos;
+        if (!within(x, p)) {
+            return library::cos(x);
+        }
+        const T t = x * x;
+        return (T(1) - t * T(0.5)) + (t * t) * evaluate(p, t);
+    }
+
+    template <class T> inline T cot(const T &x) {
+        const auto &ps = Coefficients<T>::Sin;
+        const auto &pc = Coefficients<T>::Cos;
+        if (!(within(x, ps) && within(x, pc))) {
+            return T(1) / library::tan(x);
+        }
+        const T t = x * x;
+        return ((T(1) - t * T(0.5)) + (t * t) * evaluate(pc, t)) /
+               (x + (x * t) * evaluate(ps, t));
+    }
+
+    template <class T> inline T asin(const T &x) {
+        const auto &p = Coefficients<T>::Asin;
+        if (!within(x, p)) {
+            return library::asin(x);
+        }
+        const T t = x * x;
+        return x + (x * t) * evaluate(p, t);
+    }
+
+    template <class T> inline T atan(const T &x) {
+        const auto &p = Coefficients<T>::Atan;
+        if (!within(x, p)) {
+            return library::atan(x);
+        }
+        const T t = x * x;
+        return x + (x * t) * evaluate(p, t);
+    }
+}
+
+#endif
@@ -0,0 +1,419 @@
+/*  Minimax polynomial coefficients for minimax.h
+
+    Generated by remez.cpp from the specifications:
+
+        sin:float:0.25:0.25
+        cos:float:0.25:0.25
+        asin:float:0.25:0.25
+        atan:float:0.25:0.25
+        sin:double:0.25:0.25
+        cos:double:0.25:0.25
+        asin:double:0.25:0.25
+        atan:double:0.25:0.25
+        sin:longdouble:0.25:0.25
+        cos:longdouble:0.25:0.25
+        asin:longdouble:0.25:0.25
+        atan:longdouble:0.25:0.25
+        sin:dd:0.25:0.25
+        cos:dd:0.25:0.25
+        asin:dd:0.25:0.25
+        atan:dd:0.25:0.25
+        sin:float128:0.25:0.25
+        cos:float128:0.25:0.25
+        asin:float128:0.25:0.25
+        atan:float128:0.25:0.25
+
+    Do not edit: change MINIMAX in the Makefile and make
+    minimaxcoeff.h instead.  */
+
+#ifndef MINIMAXCOEFF_H
+#define MINIMAXCOEFF_H
+
+namespace minimax {
+
+    //  float
+
+    /*  sin(x) = x + x^3 P(x^2), |x| <= 0.25
+        2 terms
+        Relative error 6.26e-09 (0.105 ulp)  */
+    const float sinFloat[2] = {
+        -1.66666567e-01F,
+        8.32093880e-03F
+    };
+
+    /*  cos(x) = 1 - x^2/2 + x^4 P(x^2), |x| <= 0.25
+        2 terms
+        Relative error 5.50e-11 (0.001 ulp)  */
+    const float cosFloat[2] = {
+        4.16666530e-02F,
+        -1.38733943e-03F
+    };
+
+    /*  asin(x) = x + x^3 P(x^2), |x| <= 0.25
+        4 terms
+        Relative error 6.16e-10 (0.010 ulp)  */
+    const float asinFloat[4] = {
+        1.66666657e-01F,
+        7.50015154e-02F,
+        4.45230268e-02F,
+        3.33808064e-02F
+    };
+
+    /*  atan(x) = x + x^3 P(x^2), |x| <= 0.25
+        4 terms
+        Relative error 1.25e-09 (0.021 ulp)  */
+    const float atanFloat[4] = {
+        -3.33333313e-01F,
+        1.99995011e-01F,
+        -1.42453551e-01F,
+        1.00533135e-01F
+    };
+
+    template <> struct Coefficients<float> {
+        typedef float Tail;
+        static constexpr Polynomial<float, Tail> Sin =
+            { sinFloat, 2, NULL, 0, 0.25 };
+        static constexpr Polynomial<float, Tail> Cos =
+            { cosFloat, 2, NULL, 0, 0.25 };
+        static constexpr Polynomial<float, Tail> Asin =
+            { asinFloat, 4, NULL, 0, 0.25 };
+        static constexpr Polynomial<float, Tail> Atan =
+            { atanFloat, 4, NULL, 0, 0.25 };
+    };
+
+    //  double
+
+    /*  sin(x) = x + x^3 P(x^2), |x| <= 0.25
+        5 terms
+        Relative error 5.51e-19 (0.005 ulp)  */
+    const double sinDouble[5] = {
+        -1.6666666666666666e-01,
+        8.3333333333330938e-03,
+        -1.9841269838207255e-04,
+        2.7557305505976188e-06,
+        -2.5027024716726217e-08
+    };
+
+    /*  cos(x) = 1 - x^2/2 + x^4 P(x^2), |x| <= 0.25
+        4 terms
+        Relative error 1.01e-18 (0.009 ulp)  */
+    const double cosDouble[4] = {
+        4.1666666666666415e-02,
+        -1.3888888887614911e-03,
+        2.4801577111499192e-05,
+        -2.7531232760966786e-07
+    };
+
+    /*  asin(x) = x + x^3 P(x^2), |x| <= 0.25
+        8 terms
+        Relative error 5.88e-18 (0.053 ulp)  */
+    const double asinDouble[8] = {
+        1.6666666666666657e-01,
+        7.5000000000178715e-02,
+        4.4642857083080335e-02,
+        3.0381952049355187e-02,
+        2.2371685142171763e-02,
+        1.7368735535334200e-02,
+        1.3669229855769904e-02,
+        1.4340363339166646e-02
+    };
+
+    /*  atan(x) = x + x^3 P(x^2), |x| <= 0.25
+        8 terms
+        Relative error 1.82e-17 (0.164 ulp)  */
+    const double atanDouble[8] = {
+        -3.3333333333333304e-01,
+        1.9999999999939011e-01,
+        -1.4285714265141589e-01,
+        1.1111108462732518e-01,
+        -9.0907412155468312e-02,
+        7.6865024041207999e-02,
+        -6.5544348476230530e-02,
+        4.7268451902524794e-02
+    };
+
+    template <> struct Coefficients<double> {
+        typedef double Tail;
+        static constexpr Polynomial<double, Tail> Sin =
+            { sinDouble, 5, NULL, 0, 0.25 };
+        static constexpr Polynomial<double, Tail> Cos =
+            { cosDouble, 4, NULL, 0, 0.25 };
+        static constexpr Polynomial<double, Tail> Asin =
+            { asinDouble, 8, NULL, 0, 0.25 };
+        static constexpr Polynomial<double, Tail> Atan =
+            { atanDouble, 8, NULL, 0, 0.25 };
+    };
+
+    //  long double
+
+    /*  sin(x) = x + x^3 P(x^2), |x| <= 0.25
+        6 terms
+        Relative error 2.86e-22 (0.005 ulp)  */
+    const long double sinLongDouble[6] = {
+        -1.66666666666666666671e-01L,
+        8.33333333333333330747e-03L,
+        -1.98412698412693626631e-04L,
+        2.75573192207192683323e-06L,
+        -2.50520983067776719099e-08L,
+        1.60447098521946387028e-10L
+    };
+
+    /*  cos(x) = 1 - x^2/2 + x^4 P(x^2), |x| <= 0.25
+        5 terms
+        Relative error 8.11e-23 (0.001 ulp)  */
+    const long double cosLongDouble[5] = {
+        4.16666666666666666441e-02L,
+        -1.38888888888887179721e-03L,
+        2.48015872993999861961e-05L,
+        -2.75573094257510905100e-07L,
+        2.08588398982265107779e-09L
+    };
+
+    /*  asin(x) = x + x^3 P(x^2), |x| <= 0.25
+        10 terms
+        Relative error 1.42e-21 (0.026 ulp)  */
+    const long double asinLongDouble[10] = {
+        1.66666666666666666644e-01L,
+        7.50000000000000544161e-02L,
+        4.46428571428285138604e-02L,
+        3.03819444502816860257e-02L,
+        2.23721584872910297087e-02L,
+        1.73528002063255833291e-02L,
+        1.39635562669426907681e-02L,
+        1.15803206827186899776e-02L,
+        9.38382335908647763302e-03L,
+        1.10884488355590896249e-02L
+    };
+
+    /*  atan(x) = x + x^3 P(x^2), |x| <= 0.25
+        10 terms
+        Relative error 4.08e-21 (0.075 ulp)  */
+    const long double atanLongDouble[10] = {
+        -3.33333333333333333288e-01L,
+        1.99999999999999819158e-01L,
+        -1.42857142857047089089e-01L,
+        1.11111111091419165912e-01L,
+        -9.09090888500197058175e-02L,
+        7.69229530060848788311e-02L,
+        -6.66621120552081523376e-02L,
+        5.87193348380331703029e-02L,
+        -5.11748904472692850231e-02L,
+        3.60278439070604356001e-02L
+    };
+
+    template <> struct Coefficients<long double> {
+        typedef long double Tail;
+        static constexpr Polynomial<long double, Tail> Sin =
+            { sinLongDouble, 6, NULL, 0, 0.25 };
+        static constexpr Polynomial<long double, Tail> Cos =
+            { cosLongDouble, 5, NULL, 0, 0.25 };
+        static constexpr Polynomial<long double, Tail> Asin =
+            { asinLongDouble, 10, NULL, 0, 0.25 };
+        static constexpr Polynomial<long double, Tail> Atan =
+            { atanLongDouble, 10, NULL, 0, 0.25 };
+    };
+
+    //  ddqd::ddreal
+
+#ifdef DDREAL_H
+
+    /*  sin(x) = x + x^3 P(x^2), |x| <= 0.25
+        9 terms, the last 3 in double
+        Relative error 6.99e-35 (0.006 ulp)  */
+    const ddqd::ddreal sinDD[6] = {
+        ddqd::ddreal(-1.6666666666666666e-01, -9.2518585385429722e-18),
+        ddqd::ddreal(8.3333333333333332e-03, 1.1564823173178153e-19),
+        ddqd::ddreal(-1.9841269841269841e-04, -1.7209558053008615e-22),
+        ddqd::ddreal(2.7557319223985893e-06, -1.8583972224292658e-22),
+        ddqd::ddreal(-2.5052108385441720e-08, 1.4812984304731333e-24),
+        ddqd::ddreal(1.6059043836821463e-10, 1.0540947434726677e-26)
+    };
+    const double sinDDTail[3] = {
+        -7.6471637314122270e-13,
+        2.8114566094045157e-15,
+        -8.2151316827318475e-18
+    };
+
+    /*  cos(x) = 1 - x^2/2 + x^4 P(x^2), |x| <= 0.25
+        8 terms, the last 3 in double
+        Relative error 7.97e-35 (0.006 ulp)  */
+    const ddqd::ddreal cosDD[5] = {
+        ddqd::ddreal(4.1666666666666664e-02, 2.3129646346357400e-18),
+        ddqd::ddreal(-1.3888888888888889e-03, 5.3005439549718293e-20),
+        ddqd::ddreal(2.4801587301587302e-05, 2.1509938083190166e-23),
+        ddqd::ddreal(-2.7557319223985888e-07, -2.3510496157444320e-23),
+        ddqd::ddreal(2.0876756987867939e-09, -1.5713528848065341e-25)
+    };
+    const double cosDDTail[3] = {
+        -1.1470745597177948e-11,
+        4.7794762890604725e-14,
+        -1.5608933850259928e-16
+    };
+
+    /*  asin(x) = x + x^3 P(x^2), |x| <= 0.25
+        17 terms, the last 4 in double
+        Relative error 4.36e-34 (0.035 ulp)  */
+    const ddqd::ddreal asinDD[13] = {
+        ddqd::ddreal(1.6666666666666666e-01, 9.2518585385429722e-18),
+        ddqd::ddreal(7.4999999999999997e-02, 2.7755575615410815e-18),
+        ddqd::ddreal(4.4642857142857144e-02, -9.9127052426862554e-19),
+        ddqd::ddreal(3.0381944444444444e-02, 3.8547382559590277e-19),
+        ddqd::ddreal(2.2372159090909092e-02, -9.3974009931727040e-19),
+        ddqd::ddreal(1.7352764423076920e-02, 1.4160042003480275e-18),
+        ddqd::ddreal(1.3964843750000160e-02, -4.8786670042832216e-19),
+        ddqd::ddreal(1.1551800896125546e-02, 8.1500845023848980e-19),
+        ddqd::ddreal(9.7616095300958172e-03, -6.5799092542661190e-19),
+        ddqd::ddreal(8.3903357674341202e-03, -3.6557523425660041e-19),
+        ddqd::ddreal(7.3125273404181590e-03, -7.8808245596459823e-20),
+        ddqd::ddreal(6.4471722700176030e-03, 1.4616103427618757e-20),
+        ddqd::ddreal(5.7407694124120079e-03, -4.1727726376399598e-20)
+    };
+    const double asinDDTail[4] = {
+        5.1430436298290430e-03,
+        4.7617518693038995e-03,
+        3.5751802297529648e-03,
+        6.4005687799873028e-03
+    };
+
+    /*  atan(x) = x + x^3 P(x^2), |x| <= 0.25
+        17 terms, the last 4 in double
+        Relative error 1.97e-33 (0.160 ulp)  */
+    const ddqd::ddreal atanDD[13] = {
+        ddqd::ddreal(-3.3333333333333331e-01, -1.8503717077085938e-17),
+        ddqd::ddreal(2.0000000000000001e-01, -1.1102230246311245e-17),
+        ddqd::ddreal(-1.4285714285714285e-01, -7.9301643697934609e-18),
+        ddqd::ddreal(1.1111111111111110e-01, 6.1678497623186936e-18),
+        ddqd::ddreal(-9.0909090909090912e-02, 2.5411724589637426e-18),
+        ddqd::ddreal(7.6923076923076913e-02, 6.1158390381545863e-18),
+        ddqd::ddreal(-6.6666666666666222e-02, 3.3937496285647096e-18),
+        ddqd::ddreal(5.8823529411724654e-02, 2.3186938175980420e-18),
+        ddqd::ddreal(-5.2631578944792971e-02, 1.6176893306743278e-18),
+        ddqd::ddreal(4.7619047497130119e-02, 2.9575425171333731e-20),
+        ddqd::ddreal(-4.3478256566459879e-02, 1.6329682355125743e-18),
+        ddqd::ddreal(3.9999886232909225e-02, -1.8912607141202221e-18),
+        ddqd::ddreal(-3.7034791746135734e-02, -2.9211352013140009e-18)
+    };
+    const double atanDDTail[4] = {
+        3.4450101936737601e-02,
+        -3.1916864698242495e-02,
+        2.7856365387543960e-02,
+        -1.7482291621173665e-02
+    };
+
+    template <> struct Coefficients<ddqd::ddreal> {
+        typedef double Tail;
+        static constexpr Polynomial<ddqd::ddreal, Tail> Sin =
+            { sinDD, 6, sinDDTail, 3, 0.25 };
+        static constexpr Polynomial<ddqd::ddreal, Tail> Cos =
+            { cosDD, 5, cosDDTail, 3, 0.25 };
+        static constexpr Polynomial<ddqd::ddreal, Tail> Asin =
+            { asinDD, 13, asinDDTail, 4, 0.25 };
+        static constexpr Polynomial<ddqd::ddreal, Tail> Atan =
+            { atanDD, 13, atanDDTail, 4, 0.25 };
+    };
+#endif
+
+    //  __float128
+
+#ifdef QUADMATH_H
+
+    /*  sin(x) = x + x^3 P(x^2), |x| <= 0.25
+        9 terms, the last 4 in long double
+        Relative error 9.04e-36 (0.094 ulp)  */
+    const __float128 sinFloat128[5] = {
+        -1.66666666666666666666666666666666659e-01Q,
+        8.33333333333333333333333333332769688e-03Q,
+        -1.98412698412698412698412696008578683e-04Q,
+        2.75573192239858906525533708411921429e-06Q,
+        -2.50521083854417187425677488482203765e-08Q
+    };
+    const long double sinFloat128Tail[4] = {
+        1.60590438368214644683e-10L,
+        -7.64716373141222681870e-13L,
+        2.81145660940451557457e-15L,
+        -8.21513168273184710214e-18L
+    };
+
+    /*  cos(x) = 1 - x^2/2 + x^4 P(x^2), |x| <= 0.25
+        8 terms, the last 3 in long double
+        Relative error 1.18e-35 (0.122 ulp)  */
+    const __float128 cosFloat128[5] = {
+        4.16666666666666666666666666666637457e-02Q,
+        -1.38888888888888888888888888290636052e-03Q,
+        2.48015873015873015872995775180014336e-05Q,
+        -2.75573192239858906268354727433880193e-07Q,
+        2.08767569878679373149828167875305101e-09Q
+    };
+    const long double cosFloat128Tail[3] = {
+        -1.14707455971779482553e-11L,
+        4.77947628906047256058e-14L,
+        -1.56089338502599281950e-16L
+    };
+
+    /*  asin(x) = x + x^3 P(x^2), |x| <= 0.25
+        18 terms, the last 6 in long double
+        Relative error 4.43e-36 (0.046 ulp)  */
+    const __float128 asinFloat128[12] = {
+        1.66666666666666666666666666666666635e-01Q,
+        7.50000000000000000000000000003643715e-02Q,
+        4.46428571428571428571428565163793727e-02Q,
+        3.03819444444444444444448711993192006e-02Q,
+        2.23721590909090909089376498891273264e-02Q,
+        1.73527644230769231103977330466875306e-02Q,
+        1.39648437499999951625416191885717607e-02Q,
+        1.15518008961401939955067549297689510e-02Q,
+        9.76160952915843855617954931651781014e-03Q,
+        8.39033581154491573500265521191379698e-03Q,
+        7.31252579518332514311568856145109501e-03Q,
+        6.44721272619815109481543322050156378e-03Q
+    };
+    const long double asinFloat128Tail[6] = {
+        5.73998141230672306514e-03L,
+        5.15429363403471828453e-03L,
+        4.64746813670856606489e-03L,
+        4.35702559020187835933e-03L,
+        3.17235457096797572269e-03L,
+        6.07654892287553317583e-03L
+    };
+
+    /*  atan(x) = x + x^3 P(x^2), |x| <= 0.25
+        18 terms, the last 6 in long double
+        Relative error 2.14e-35 (0.222 ulp)  */
+    const __float128 atanFloat128[12] = {
+        -3.33333333333333333333333333333333221e-01Q,
+        1.99999999999999999999999999999037984e-01Q,
+        -1.42857142857142857142857141197401702e-01Q,
+        1.11111111111111111111109976049780649e-01Q,
+        -9.09090909090909090904996137524470513e-02Q,
+        7.69230769230769229870171421849880102e-02Q,
+        -6.66666666666666535949532322118094499e-02Q,
+        5.88235294117633774394556853556338080e-02Q,
+        -5.26315789472705938737881873140186781e-02Q,
+        4.76190476137007145052682119517245532e-02Q,
+        -4.34782606493523212894040465046053981e-02Q,
+        3.99999931120392079350414215247188192e-02Q
+    };
+    const long double atanFloat128Tail[6] = {
+        -3.70368732325238738655e-02L,
+        3.44798147281287331974e-02L,
+        -3.22186669212739949665e-02L,
+        2.99208399844943431592e-02L,
+        -2.60055328192559707038e-02L,
+        1.60419070995139280629e-02L
+    };
+
+    template <> struct Coefficients<__float128> {
+        typedef long double Tail;
+        static constexpr Polynomial<__float128, Tail> Sin =
+            { sinFloat128, 5, sinFloat128Tail, 4, 0.25 };
+        static constexpr Polynomial<__float128, Tail> Cos =
+            { cosFloat128, 5, cosFloat128Tail, 3, 0.25 };
+        static constexpr Polynomial<__float128, Tail> Asin =
+            { asinFloat128, 12, asinFloat128Tail, 6, 0.25 };
+        static constexpr Polynomial<__float128, Tail> Atan =
+            { atanFloat128, 12, atanFloat128Tail, 6, 0.25 };
+    };
+#endif
+}
+
+#endif
@@ -0,0 +1,571 @@
+/*  Fixed precision multiple-precision arithmetic on the GMP mpn layer
+
+    An mpnreal<Limbs> is a binary floating point number whose
+    mantissa of Limbs machine words (64 bits each on 64 bit
+    machines) is stored inline in the object, along with its
+    sign and exponent.  The MPFR C++ mpreal, by contrast, holds a
+    pointer to a mantissa allocated from the heap, so every
+    temporary created while evaluating an expression costs a
+    call to malloc and free.  An mpnreal temporary is just a few
+    words on the stack.
+
+    The arithmetic is done by GMP's low-level mpn functions,
+    which operate on arrays of limbs supplied by the caller and,
+    at the sizes used here, do not allocate memory.  Each result
+    is computed with one guard limb beyond the mantissa and
+    rounded to nearest on that limb, so results are faithfully
+    rounded (within one unit in the last place), but, unlike
+    MPFR, not always correctly rounded.
+
+    The mathematical functions the benchmark requires are
+    implemented natively: sqrt with mpn_sqrtrem, sin and cos by
+    reduction modulo pi/2 and a Taylor series which stops when
+    its terms drop below the precision of the number, and asin by
+    Newton iteration on sin starting from the double precision
+    library arc sine.  The value of pi is built in to 1024 bits,
+    which limits the precision to 16 limbs.
+
+    There is no representation for infinities or NaNs: the
+    benchmark never produces them, and division by zero or the
+    arc sine of an argument greater than one throws a
+    std::domain_error.  */
+
+#ifndef MPNREAL_H
+#define MPNREAL_H
+
+#include <gmp.h>
+
+#include <cmath>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#include "realedit.h"
+
+namespace fixedmp {
+
+    //  Mantissa of pi / 4, most significant limb first
+    static const mp_limb_t pi_4_limbs[16] = {
+        0xc90fdaa22168c234UL, 0xc4c6628b80dc1cd1UL,
+        0x29024e088a67cc74UL, 0x020bbea63b139b22UL,
+        0x514a08798e3404ddUL, 0xef9519b3cd3a431bUL,
+        0x302b0a6df25f1437UL, 0x4fe1356d6d51c245UL,
+        0xe485b576625e7ec6UL, 0xf44c42e9a637ed6bUL,
+        0x0bff5cb6f406b7edUL, 0xee386bfb5a899fa5UL,
+        0xae9f24117c4b1fe6UL, 0x49286651ece45b3dUL,
+        0xc2007cb8a163bf05UL, 0x98da48361c55d39aUL
+    };
+
+    template <int Limbs> class mpnreal {
+        static_assert(GMP_NUMB_BITS == 64 && GMP_NAIL_BITS == 0,
+            "mpnreal requires 64 bit limbs without nails");
+        static_assert(Limbs >= 1 && Limbs <= 16,
+            "mpnreal supports from 1 to 16 limbs");
+
+    public:
+        static const int Bits = Limbs * GMP_NUMB_BITS;
+
+        /*  The value is (-1)^neg * 0.m * 2^exp, with the mantissa
+            m normalised so the top bit of m[Limbs - 1] is set.
+            Zero has all limbs zero.  */
+        mp_limb_t m[Limbs];
+        long exp;
+        bool neg;
+
+        //  Constructors
+        mpnreal() {
+            setZero();
+        }
+
+        mpnreal(double d) {
+            int e;
+            if (d == 0.0) {
+                setZero();
+                return;
+            }
+            neg = d < 0.0;
+            const double f = std::frexp(neg ? -d : d, &e);
+            for (int i = 0; i < Limbs - 1; i++) {
+                m[i] = 0;
+            }
+            m[Limbs - 1] = (mp_limb_t) std::ldexp(f, GMP_NUMB_BITS);
+            exp = e;
+        }
+
+        bool isZero(void) const {
+            return m[Limbs - 1] == 0;
+        }
+
+        //  Nearest double (to within the rounding of the top limb)
+        double toDouble(void) const {
+            if (isZero()) {
+                return 0.0;
+            }
+            const double d = std::ldexp((double) m[Limbs - 1],
+                                        (int) (exp - GMP_NUMB_BITS));
+            return neg ? -d : d;
+        }
+
+        //  Edit to a string with a printf-like "%w.pf" format
+        std::string toString(const char *format) const {
+            int width, places;
+            realedit::parseFormat(format, width, places);
+            return realedit::edit(*this, width, places);
+        }
+
+        //  Convert from a number with a different number of limbs
+        template <int L> explicit mpnreal(const mpnreal<L> &a) {
+            mp_limb_t w[Limbs + 1];
+
+            for (int i = 0; i <= Limbs; i++) {
+                const int j = L - 1 - Limbs + i;
+                w[i] = (j >= 0) ? a.m[j] : 0;
+            }
+            neg = a.neg;
+            if (a.isZero()) {
+                setZero();
+            } else {
+                round(w, a.exp, *this);
+            }
+        }
+
+        //  pi / 2 rounded to the precision of the type
+        static const mpnreal &pi_2(void) {
+            static const mpnreal p = makePi(1);
+            return p;
+        }
+
+        //  Divide by a small unsigned integer
+        mpnreal divUI(unsigned long d) const {
+            mp_limb_t q[Limbs + 1];
+            mpnreal r;
+
+            if (isZero()) {
+                return r;
+            }
+            mpn_divrem_1(q, 1, m, Limbs, d);
+            r.neg = neg;
+            normaliseRound(q, exp, r);
+            return r;
+        }
+
+        //  Arithmetic
+
+        mpnreal operator-() const {
+            mpnreal r = *this;
+            if (!isZero()) {
+                r.neg = !r.neg;
+            }
+            return r;
+        }
+
+        friend mpnreal operator+(const mpnreal &a, const mpnreal &b) {
+            mpnreal r;
+            addSub(a, b, false, r);
+            return r;
+        }
+
+        friend mpnreal operator-(const mpnreal &a, const mpnreal &b) {
+            mpnreal r;
+            addSub(a, b, true, r);
+            return r;
+        }
+
+        friend mpnreal operator*(const mpnreal &a, const mpnreal &b) {
+            mp_limb_t p[2 * Limbs];
+            mpnreal r;
+            long e = a.exp + b.exp;
+
+            if (a.isZero() || b.isZero()) {
+                return r;
+            }
+            mpn_mul_n(p, a.m, b.m, Limbs);
+            if ((p[2 * Limbs - 1] & TopBit) == 0) {
+                mpn_lshift(p, p, 2 * Limbs, 1);
+                e--;
+            }
+            r.neg = a.neg != b.neg;
+            round(p + Limbs - 1, e, r);
+            return r;
+        }
+
+        friend mpnreal operator/(const mpnreal &a, const mpnreal &b) {
+            mp_limb_t n[2 * Limbs + 1], q[Limbs + 2], rem[Limbs];
+            mpnreal r;
+            long e = a.exp - b.exp;
+
+            if (b.isZero()) {
+                throw std::domain_error("mpnreal division by zero");
+            }
+            if (a.isZero()) {
+                return r;
+            }
+            /*  Divide a's mantissa, extended by Limbs + 1 zero
+                limbs, by b's.  The quotient lies between 2^(Bits + 63)
+                and 2^(Bits + 65), so it fills Limbs + 1 limbs, plus
+                possibly one bit in the limb above.  */
+            for (int i = 0; i <= Limbs; i++) {
+                n[i] = 0;
+            }
+            for (int i = 0; i < Limbs; i++) {
+                n[Limbs + 1 + i] = a.m[i];
+            }
+            mpn_tdiv_qr(q, rem, 0, n, 2 * Limbs + 1, b.m, Limbs);
+            if (q[Limbs + 1] != 0) {
+                mpn_rshift(q, q, Limbs + 2, 1);
+                e++;
+            }
+            r.neg = a.neg != b.neg;
+            round(q, e, r);
+            return r;
+        }
+
+        mpnreal &operator+=(const mpnreal &b) { return *this = *this + b; }
+        mpnreal &operator-=(const mpnreal &b) { return *this = *this - b; }
+        mpnreal &operator*=(const mpnreal &b) { return *this = *this * b; }
+        mpnreal &operator/=(const mpnreal &b) { return *this = *this / b; }
+
+        //  Comparison
+
+        friend int compare(const mpnreal &a, const mpnreal &b) {
+            if (a.isZero() || b.isZero()) {
+                if (a.isZero() && b.isZero()) {
+                    return 0;
+                }
+                return a.isZero() ? (b.neg ? 1 : -1) : (a.neg ? -1 : 1);
+            }
+            if (a.neg != b.neg) {
+                return a.neg ? -1 : 1;
+            }
+            const int s = a.neg ? -1 : 1;
+            if (a.exp != b.exp) {
+                return (a.exp > b.exp) ? s : -s;
+            }
+            return s * mpn_cmp(a.m, b.m, Limbs);
+        }
+
+        friend bool operator==(const mpnreal &a, const mpnreal &b) {
+            return compare(a, b) == 0;
+        }
+        friend bool operator!=(const mpnreal &a, const mpnreal &b) {
+            return compare(a, b) != 0;
+        }
+        friend bool operator<(const mpnreal &a, const mpnreal &b) {
+            return compare(a, b) < 0;
+        }
+        friend bool operator>(const mpnreal &a, const mpnreal &b) {
+            return compare(a, b) > 0;
+        }
+        friend bool operator<=(const mpnreal &a, const mpnreal &b) {
+            return compare(a, b) <= 0;
+        }
+        friend bool operator>=(const mpnreal &a, const mpnreal &b) {
+            return compare(a, b) >= 0;
+        }
+
+        //  Mathematical functions
+
+        friend mpnreal fabs(const mpnreal &a) {
+            mpnreal r = a;
+            r.neg = false;
+            return r;
+        }
+
+        friend mpnreal sqrt(const mpnreal &a) {
+            mp_limb_t n[2 * Limbs + 2], s[Limbs + 1];
+            mpnreal r;
+
+            if (a.isZero()) {
+                return r;
+            }
+            if (a.neg) {
+                throw std::domain_error("mpnreal square root of negative number");
+            }
+            /*  Place the mantissa at the top of 2 * Limbs + 2 limbs,
+                shifted right one bit if the exponent is odd, so the
+                integer square root fills Limbs + 1 limbs.  */
+            const int odd = (int) (a.exp & 1);
+            for (int i = 0; i < Limbs + 2; i++) {
+                n[i] = 0;
+            }
+            for (int i = 0; i < Limbs; i++) {
+                n[Limbs + 2 + i] = a.m[i];
+            }
+            if (odd) {
+                mpn_rshift(n, n, 2 * Limbs + 2, 1);
+            }
+            mpn_sqrtrem(s, NULL, n, 2 * Limbs + 2);
+            round(s, (a.exp + odd) / 2, r);
+            return r;
+        }
+
+        friend mpnreal sin(const mpnreal &a) {
+            int j;
+            const mpnreal r = reducePi2(a, j);
+
+            switch (j) {
+                case 0:     return sinTaylor(r);
+                case 1:     return cosTaylor(r);
+                case 2:     return -sinTaylor(r);
+                default:    return -cosTaylor(r);
+            }
+        }
+
+        friend mpnreal cos(const mpnreal &a) {
+            int j;
+            const mpnreal r = reducePi2(a, j);
+
+            switch (j) {
+                case 0:     return cosTaylor(r);
+                case 1:     return -sinTaylor(r);
+                case 2:     return -cosTaylor(r);
+                default:    return sinTaylor(r);
+            }
+        }
+
+        friend void sincos(const mpnreal &a, mpnreal &sin_a, mpnreal &cos_a) {
+            int j;
+            const mpnreal r = reducePi2(a, j);
+            const mpnreal s = sinTaylor(r);
+            const mpnreal c = sqrt(mpnreal(1.0) - s * s);
+
+            switch (j) {
+                case 0:     sin_a = s;      cos_a = c;      break;
+                case 1:     sin_a = c;      cos_a = -s;     break;
+                case 2:     sin_a = -s;     cos_a = -c;     break;
+                default:    sin_a = -c;     cos_a = s;      break;
+            }
+        }
+
+        friend mpnreal tan(const mpnreal &a) {
+            mpnreal s, c;
+            sincos(a, s, c);
+            return s / c;
+        }
+
+        friend mpnreal cot(const mpnreal &a) {
+            mpnreal s, c;
+            sincos(a, s, c);
+            return c / s;
+        }
+
+        friend mpnreal asin(const mpnreal &a) {
+            const int c = compare(fabs(a), mpnreal(1.0));
+            if (c >= 0) {
+                if (c > 0) {
+                    throw std::domain_error("mpnreal arc sine argument exceeds 1");
+                }
+                return a.neg ? -pi_2() : pi_2();
+            }
+            /*  Each Newton step doubles the number of correct bits,
+                so start from the arc sine computed with half as many
+                limbs (or, for one limb, the 53 bits of the double
+                arc sine) and take a single step at full precision.  */
+            mpnreal z = startAsin(a), s, co;
+            sincos(z, s, co);
+            return z + (a - s) / co;
+        }
+
+        friend std::ostream &operator<<(std::ostream &os, const mpnreal &a) {
+            return os << a.toString("%16.11f");
+        }
+
+    private:
+        static const mp_limb_t TopBit = ((mp_limb_t) 1) << (GMP_NUMB_BITS - 1);
+
+        void setZero(void) {
+            for (int i = 0; i < Limbs; i++) {
+                m[i] = 0;
+            }
+            exp = 0;
+            neg = false;
+        }
+
+        /*  Round the fraction 0.w * 2^e, where w is Limbs + 1
+            limbs, the first a guard limb, and the top bit is set,
+            to nearest and store the result in r.  The sign of r
+            must already be set.  */
+        static void round(const mp_limb_t *w, long e, mpnreal &r) {
+            if (w[0] & TopBit) {
+                if (mpn_add_1(r.m, w + 1, Limbs, 1) != 0) {
+                    r.m[Limbs - 1] = TopBit;
+                    e++;
+                }
+            } else {
+                for (int i = 0; i < Limbs; i++) {
+                    r.m[i] = w[i + 1];
+                }
+            }
+            r.exp = e;
+        }
+
+        /*  Normalise Limbs + 1 limbs w, whose value is the
+            fraction 0.w * 2^e, by shifting them left
+            until the top bit is set, then round into r.  The
+            limbs are modified.  */
+        static void normaliseRound(mp_limb_t *w, long e, mpnreal &r) {
+            int top = Limbs;
+            while (top >= 0 && w[top] == 0) {
+                top--;
+            }
+            if (top < 0) {
+                r.setZero();
+                return;
+            }
+            const int limbShift = Limbs - top;
+            if (limbShift > 0) {
+                for (int i = Limbs; i >= limbShift; i--) {
+                    w[i] = w[i - limbShift];
+                }
+                for (int i = limbShift - 1; i >= 0; i--) {
+                    w[i] = 0;
+                }
+            }
+            const int bitShift = __builtin_clzl(w[Limbs]);
+            if (bitShift > 0) {
+                mpn_lshift(w, w, Limbs + 1, bitShift);
+            }
+            round(w, e - (long) limbShift * GMP_NUMB_BITS - bitShift, r);
+        }
+
+        //  Add (or subtract, if sub is true) b to a, storing in r
+        static void addSub(const mpnreal &a, const mpnreal &b, bool sub,
+                           mpnreal &r) {
+            const bool bneg = b.neg != sub;
+
+            if (b.isZero()) {
+                r = a;
+                return;
+            }
+            if (a.isZero()) {
+                r = b;
+                r.neg = bneg;
+                return;
+            }
+
+            /*  Order the operands so x has the larger magnitude,
+                then align y's mantissa with x's, with a guard limb
+                below both.  */
+            const bool swap = (a.exp < b.exp) ||
+                              (a.exp == b.exp && mpn_cmp(a.m, b.m, Limbs) < 0);
+            const mpnreal &x = swap ? b : a, &y = swap ? a : b;
+            const bool xneg = swap ? bneg : a.neg,
+                       yneg = swap ? a.neg : bneg;
+            const long shift = x.exp - y.exp;
+            mp_limb_t xw[Limbs + 1], yw[Limbs + 1], w[Limbs + 1];
+
+            xw[0] = 0;
+            for (int i = 0; i < Limbs; i++) {
+                xw[i + 1] = x.m[i];
+            }
+            if (shift >= (long) (Limbs + 1) * GMP_NUMB_BITS) {
+                r = x;
+                r.neg = xneg;
+                return;
+            }
+            const int limbShift = (int) (shift / GMP_NUMB_BITS),
+                      bitShift = (int) (shift % GMP_NUMB_BITS);
+            yw[0] = 0;
+            for (int i = 0; i < Limbs; i++) {
+                yw[i + 1] = y.m[i];
+            }
+            if (limbShift > 0) {
+                for (int i = 0; i <= Limbs - limbShift; i++) {
+                    yw[i] = yw[i + limbShift];
+                }
+                for (int i = Limbs - limbShift + 1; i <= Limbs; i++) {
+                    yw[i] = 0;
+                }
+            }
+            if (bitShift > 0) {
+                mpn_rshift(yw, yw, Limbs + 1, bitShift);
+            }
+
+            r.neg = xneg;
+            if (xneg == yneg) {
+                if (mpn_add_n(w, xw, yw, Limbs + 1) != 0) {
+                    mpn_rshift(w, w, Limbs + 1, 1);
+                    w[Limbs] |= TopBit;
+                    round(w, x.exp + 1, r);
+                } else {
+                    round(w, x.exp, r);
+                }
+            } else {
+                mpn_sub_n(w, xw, yw, Limbs + 1);
+                normaliseRound(w, x.exp, r);
+                if (r.isZero()) {
+                    r.neg = false;
+                }
+            }
+        }
+
+        //  Build pi * 2^(e - 2) from the table of limbs of pi / 4
+        static mpnreal makePi(long e) {
+            mp_limb_t w[Limbs + 1];
+            mpnreal p;
+
+            for (int i = 0; i <= Limbs; i++) {
+                w[Limbs - i] = (i < 16) ? pi_4_limbs[i] : 0;
+            }
+            round(w, e, p);
+            return p;
+        }
+
+        //  Starting approximation for asin
+        static mpnreal startAsin(const mpnreal &a) {
+            if (Limbs == 1) {
+                return std::asin(a.toDouble());
+            }
+            const int Half = (Limbs + 1) / 2;
+            return mpnreal(asin(mpnreal<(Half < Limbs) ? Half : 1>(a)));
+        }
+
+        /*  Reduce a to r = a - j * (pi / 2) with |r| <= pi / 4,
+            returning r and the quadrant j modulo 4.  */
+        static mpnreal reducePi2(const mpnreal &a, int &j) {
+            const double q = std::floor(a.toDouble() / M_PI_2 + 0.5);
+            j = 0;
+            if (q == 0.0) {
+                return a;
+            }
+            j = ((int) std::fmod(q, 4.0) + 4) & 3;
+            return a - pi_2() * mpnreal(q);
+        }
+
+        //  Sine by Taylor series, |a| <= pi / 4
+        static mpnreal sinTaylor(const mpnreal &a) {
+            if (a.isZero()) {
+                return a;
+            }
+            const mpnreal x2 = -(a * a);
+            mpnreal s = a, t = a;
+            for (unsigned long n = 1; ; n += 2) {
+                t = (t * x2).divUI((n + 1) * (n + 2));
+                s += t;
+                if (t.isZero() || t.exp < s.exp - Bits) {
+                    break;
+                }
+            }
+            return s;
+        }
+
+        //  Cosine by Taylor series, |a| <= pi / 4
+        static mpnreal cosTaylor(const mpnreal &a) {
+            const mpnreal x2 = -(a * a);
+            mpnreal s = 1.0, t = 1.0;
+            if (a.isZero()) {
+                return s;
+            }
+            for (unsigned long n = 0; ; n += 2) {
+                t = (t * x2).divUI((n + 1) * (n + 2));
+                s += t;
+                if (t.isZero() || t.exp < s.exp - Bits) {
+                    break;
+                }
+            }
+            return s;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,207 @@
+/*  Pooled memory allocator for GMP and MPFR
+
+    GMP and MPFR obtain the memory for the limbs of every number
+    through functions which can be replaced by the program with
+    mp_set_memory_functions().  By default these call malloc,
+    realloc, and free.  The multiple precision builds of the
+    benchmark create and destroy a great many numbers of the same
+    few sizes, and this allocator serves those requests from free
+    lists, one for each size class, without calling malloc.
+
+    Size classes are multiples of the size of a limb, up to a
+    limit set when the pool is installed, which the caller chooses
+    from the working precision.  Since GMP passes the size of a
+    block when it is freed or reallocated, blocks need no header:
+    the size identifies the class.  Blocks are carved from a
+    region allocated when the pool is installed, which is handed
+    out to threads in slabs.  Each thread keeps its own free lists
+    and current slab, so threads never contend for a lock.  A
+    block freed by a thread other than the one which allocated it
+    simply joins the free list of the thread which frees it.
+    Memory is never returned to the region.
+
+    Requests larger than the largest class, and those made after
+    the region is exhausted, go to malloc.  Blocks are recognised
+    as belonging to the pool by their address lying within the
+    region, so blocks allocated with malloc, including those
+    allocated before the pool was installed, are returned to
+    free.  */
+
+#ifndef MPPOOL_H
+#define MPPOOL_H
+
+#include <gmp.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace mppool {
+
+    const size_t Granule = sizeof(mp_limb_t);   // Size class spacing
+    const int MaxClasses = 512;                 // Largest 4 Kb
+    const size_t SlabSize = 16384;              // Region given to a thread
+
+    //  Counts of requests, kept for each thread
+    struct Statistics {
+        unsigned long recycled;         // Served from a free list
+        unsigned long carved;           // Carved from a slab
+        unsigned long large;            // Too large for the pool
+        unsigned long overflow;         // Region exhausted
+        unsigned long slabs;            // Slabs obtained from region
+    };
+
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    //  The region shared by all threads
+    struct Region {
+        char *base;
+        size_t size;
+        std::atomic<size_t> used;
+        int classes;
+    };
+
+    //  Free lists and current slab of a thread
+    struct ThreadCache {
+        FreeBlock *freeList[MaxClasses];
+        char *slab, *slabEnd;
+        Statistics stats;
+    };
+
+    inline Region &region(void) {
+        static Region r;
+        return r;
+    }
+
+    inline ThreadCache &cache(void) {
+        static thread_local ThreadCache c;
+        return c;
+    }
+
+    //  Statistics for the calling thread
+    inline Statistics &statistics(void) {
+        return cache().stats;
+    }
+
+    //  Size class of a block of n bytes
+    inline int sizeClass(size_t n) {
+        return n == 0 ? 0 : (int) ((n - 1) / Granule);
+    }
+
+    //  Does the block belong to the pool?
+    inline bool owns(const void *p) {
+        const Region &r = region();
+        const char *b = (const char *) p;
+        return b >= r.base && b < r.base + r.size;
+    }
+
+    inline void *systemAlloc(size_t n) {
+        void *p = malloc(n);
+        if (p == NULL) {
+            fprintf(stderr, "mppool: out of memory allocating %lu bytes\n",
+                (unsigned long) n);
+            abort();
+        }
+        return p;
+    }
+
+    inline void *allocate(size_t n) {
+        ThreadCache &c = cache();
+        const int k = sizeClass(n);
+
+        if (k >= region().classes) {
+            c.stats.large++;
+            return systemAlloc(n);
+        }
+
+        FreeBlock *b = c.freeList[k];
+        if (b != NULL) {
+            c.freeList[k] = b->next;
+            c.stats.recycled++;
+            return b;
+        }
+
+        const size_t bytes = (k + 1) * Granule;
+        if (c.slab + bytes > c.slabEnd) {
+            Region &r = region();
+            const size_t o = r.used.fetch_add(SlabSize);
+            if (o + SlabSize > r.size) {
+                c.stats.overflow++;
+                return systemAlloc(n);
+            }
+            c.slab = r.base + o;
+            c.slabEnd = c.slab + SlabSize;
+            c.stats.slabs++;
+        }
+        void *p = c.slab;
+        c.slab += bytes;
+        c.stats.carved++;
+        return p;
+    }
+
+    inline void release(void *p, size_t n) {
+        if (owns(p)) {
+            ThreadCache &c = cache();
+            const int k = sizeClass(n);
+            FreeBlock *b = (FreeBlock *) p;
+            b->next = c.freeList[k];
+            c.freeList[k] = b;
+        } else {
+            free(p);
+        }
+    }
+
+    inline void *reallocate(void *p, size_t o, size_t n) {
+        if (owns(p) && (sizeClass(o) == sizeClass(n))) {
+            return p;
+        }
+        if (!owns(p) && (sizeClass(n) >= region().classes)) {
+            void *np = realloc(p, n);
+            if (np == NULL) {
+                fprintf(stderr, "mppool: out of memory reallocating %lu bytes\n",
+                    (unsigned long) n);
+                abort();
+            }
+            return np;
+        }
+        void *np = allocate(n);
+        memcpy(np, p, o < n ? o : n);
+        release(p, o);
+        return np;
+    }
+
+    //  Functions with the signatures mp_set_memory_functions() expects
+    inline void *gmpAlloc(size_t n) {
+        return allocate(n);
+    }
+
+    inline void *gmpRealloc(void *p, size_t o, size_t n) {
+        return reallocate(p, o, n);
+    }
+
+    inline void gmpFree(void *p, size_t n) {
+        release(p, n);
+    }
+
+    /*  Install the pool, with a region of regionBytes, pooling
+        blocks up to largest bytes.  Any library which caches the
+        memory functions (MPFR does) must be told to release its
+        caches before this is called.  The pool may be installed
+        only once.  */
+    inline void install(size_t regionBytes, size_t largest) {
+        Region &r = region();
+        r.base = (char *) systemAlloc(regionBytes);
+        r.size = regionBytes;
+        r.used = 0;
+        r.classes = sizeClass(largest) + 1;
+        if (r.classes > MaxClasses) {
+            r.classes = MaxClasses;
+        }
+        mp_set_memory_functions(gmpAlloc, gmpRealloc, gmpFree);
+    }
+}
+
+#endif
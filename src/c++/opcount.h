@@ -0,0 +1,247 @@
+/*  Counting of arithmetic operations
+
+    Timing tells us how long an evaluation takes, but not how much
+    work it does, so a kernel rewritten to need fewer operations
+    can't be told from one which merely runs them faster.  A
+    Counted<T> holds a value of the built-in floating point type T
+    and behaves as one, but tallies each addition or subtraction,
+    multiplication, division, and comparison it performs, and
+    each call on sqrt and the trigonometric functions.  Negation
+    and fabs change only the sign, and aren't counted.  Built as
+    the Real type of the benchmark, it gives the exact number of
+    each operation an evaluation performs; dividing the floating
+    point operations by the time of an evaluation with the plain
+    type gives its true rate in MFLOPS, rather than the rate of
+    instructions the processor's counters report.
+
+    Operations are tallied by the phase of the ray trace in which
+    they occur, using the phases of phasetimer.h, whose scopes
+    fbench.cpp places at the start of each kind of surface
+    transit.  A Scope makes its phase current for the rest of the
+    enclosing block, and operations outside any scope are tallied
+    as "other".  The tallies are kept in a single set of globals
+    and must be updated by only one thread.  */
+
+#ifndef OPCOUNT_H
+#define OPCOUNT_H
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <ostream>
+
+#include "phasetimer.h"
+
+namespace opcount {
+
+    enum Operation {
+        Add, Multiply, Divide, Compare, Sqrt, Sin, Asin, Cos, Tan, Cot, Atan,
+        nOperations
+    };
+
+    static const char *const names[nOperations] = {
+        "Add", "Mul", "Div", "Cmp", "sqrt", "sin", "asin", "cos", "tan", "cot", "atan"
+    };
+
+    //  Phases, plus one for operations outside any phase
+    const int nKinds = phasetimer::nPhases + 1;
+
+    struct Tally {
+        unsigned long long n[nKinds][nOperations];
+        int kind;                       // Current phase
+
+        void clear(void) {
+            for (int i = 0; i < nKinds; i++) {
+                for (int j = 0; j < nOperations; j++) {
+                    n[i][j] = 0;
+                }
+            }
+        }
+
+        //  Operations of a kind, or all kinds if kind < 0
+        unsigned long long count(int kind, int op) const {
+            if (kind >= 0) {
+                return n[kind][op];
+            }
+            unsigned long long t = 0;
+            for (int i = 0; i < nKinds; i++) {
+                t += n[i][op];
+            }
+            return t;
+        }
+
+        //  Floating point operations: additions, multiplications, divisions
+        unsigned long long flops(int kind) const {
+            return count(kind, Add) + count(kind, Multiply) + count(kind, Divide);
+        }
+    };
+
+    inline Tally &tally(void) {
+        static Tally t = { {}, phasetimer::nPhases };
+        return t;
+    }
+
+    inline void count(Operation op) {
+        Tally &t = tally();
+        t.n[t.kind][op]++;
+    }
+
+    //  Clear the tallies
+    inline void reset(void) {
+        tally().clear();
+    }
+
+    //  Tally operations to phase p for the rest of the enclosing block
+    class Scope {
+    private:
+        const int saved;
+
+        Scope(const Scope &);
+        Scope &operator=(const Scope &);
+
+    public:
+        explicit Scope(phasetimer::Phase p) : saved(tally().kind) {
+            tally().kind = p;
+        }
+
+        ~Scope() {
+            tally().kind = saved;
+        }
+    };
+
+    template <class T> class Counted {
+    private:
+        T v;
+
+    public:
+        typedef T value_type;
+
+        Counted() : v(0) { }
+        Counted(T x) : v(x) { }
+
+        T value(void) const { return v; }
+        double toDouble(void) const { return (double) v; }
+
+        /*  Edit with a printf format, in which the "R" length
+            modifier of MPFR's formats is replaced by "L".  */
+        std::string toString(const char *format) const {
+            std::string f;
+            for (const char *p = format; *p != 0; p++) {
+                f += (*p == 'R') ? 'L' : *p;
+            }
+            char s[80];
+            snprintf(s, sizeof s, f.c_str(), (long double) v);
+            return s;
+        }
+
+        Counted operator-() const { Counted r; r.v = -v; return r; }
+
+        Counted &operator+=(const Counted &b) { count(Add); v += b.v; return *this; }
+        Counted &operator-=(const Counted &b) { count(Add); v -= b.v; return *this; }
+        Counted &operator*=(const Counted &b) { count(Multiply); v *= b.v; return *this; }
+        Counted &operator/=(const Counted &b) { count(Divide); v /= b.v; return *this; }
+
+        //  Arithmetic, with a Counted or a double on either side
+        friend Counted operator+(Counted a, const Counted &b) { return a += b; }
+        friend Counted operator-(Counted a, const Counted &b) { return a -= b; }
+        friend Counted operator*(Counted a, const Counted &b) { return a *= b; }
+        friend Counted operator/(Counted a, const Counted &b) { return a /= b; }
+        friend Counted operator+(Counted a, double b) { return a += b; }
+        friend Counted operator-(Counted a, double b) { return a -= b; }
+        friend Counted operator*(Counted a, double b) { return a *= b; }
+        friend Counted operator/(Counted a, double b) { return a /= b; }
+        friend Counted operator+(double a, const Counted &b) { return Counted(a) += b; }
+        friend Counted operator-(double a, const Counted &b) { return Counted(a) -= b; }
+        friend Counted operator*(double a, const Counted &b) { return Counted(a) *= b; }
+        friend Counted operator/(double a, const Counted &b) { return Counted(a) /= b; }
+
+        //  Comparisons, with a Counted or a double on either side
+#define OPCOUNT_COMPARE(op) \
+        friend bool operator op(const Counted &a, const Counted &b) { count(Compare); return a.v op b.v; } \
+        friend bool operator op(const Counted &a, double b) { count(Compare); return a.v op b; } \
+        friend bool operator op(double a, const Counted &b) { count(Compare); return a op b.v; }
+        OPCOUNT_COMPARE(==)
+        OPCOUNT_COMPARE(!=)
+        OPCOUNT_COMPARE(<)
+        OPCOUNT_COMPARE(<=)
+        OPCOUNT_COMPARE(>)
+        OPCOUNT_COMPARE(>=)
+#undef OPCOUNT_COMPARE
+
+        //  Functions
+#define OPCOUNT_FUNCTION(f, op, e) \
+        friend Counted f(const Counted &x) { count(op); Counted r; r.v = e; return r; }
+        OPCOUNT_FUNCTION(sqrt, Sqrt, std::sqrt(x.v))
+        OPCOUNT_FUNCTION(sin, Sin, std::sin(x.v))
+        OPCOUNT_FUNCTION(asin, Asin, std::asin(x.v))
+        OPCOUNT_FUNCTION(cos, Cos, std::cos(x.v))
+        OPCOUNT_FUNCTION(tan, Tan, std::tan(x.v))
+        OPCOUNT_FUNCTION(cot, Cot, 1 / std::tan(x.v))
+        OPCOUNT_FUNCTION(atan, Atan, std::atan(x.v))
+#undef OPCOUNT_FUNCTION
+
+        friend Counted fabs(const Counted &x) { Counted r; r.v = std::fabs(x.v); return r; }
+
+        friend std::ostream &operator<<(std::ostream &os, const Counted &x) {
+            return os << x.v;
+        }
+    };
+
+    /*  Report the operations of each phase per iteration, showing
+        only the operations which were performed, the floating
+        point operations of each phase, and the total of each
+        operation.  */
+    inline void report(std::ostream &os, const Tally &t, long iterations) {
+        bool used[nOperations];
+        for (int j = 0; j < nOperations; j++) {
+            used[j] = t.count(-1, j) > 0;
+        }
+
+        char line[160], *p;
+        const char *const end = line + sizeof line;
+        p = line + snprintf(line, sizeof line, "%-20s", "Per evaluate()");
+        for (int j = 0; j < nOperations; j++) {
+            if (used[j]) {
+                p += snprintf(p, end - p, " %7s", names[j]);
+            }
+        }
+        snprintf(p, end - p, " %8s", "FLOPs");
+        os << line << std::endl;
+
+        for (int kind = 0; kind < nKinds; kind++) {
+            bool any = false;
+            for (int j = 0; j < nOperations; j++) {
+                any = any || t.n[kind][j] > 0;
+            }
+            if (!any) {
+                continue;
+            }
+            char name[40];
+            if (kind < phasetimer::nPhases) {
+                snprintf(name, sizeof name, "%*s%s", 2 * phasetimer::depths[kind], "",
+                    phasetimer::names[kind]);
+            } else {
+                snprintf(name, sizeof name, "other");
+            }
+            p = line + snprintf(line, sizeof line, "%-20s", name);
+            for (int j = 0; j < nOperations; j++) {
+                if (used[j]) {
+                    p += snprintf(p, end - p, " %7.6g", (double) t.n[kind][j] / iterations);
+                }
+            }
+            snprintf(p, end - p, " %8.6g", (double) t.flops(kind) / iterations);
+            os << line << std::endl;
+        }
+
+        p = line + snprintf(line, sizeof line, "%-20s", "Total");
+        for (int j = 0; j < nOperations; j++) {
+            if (used[j]) {
+                p += snprintf(p, end - p, " %7.6g", (double) t.count(-1, j) / iterations);
+            }
+        }
+        snprintf(p, end - p, " %8.6g", (double) t.flops(-1) / iterations);
+        os << line << std::endl;
+    }
+}
+
+#endif
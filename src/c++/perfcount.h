@@ -0,0 +1,346 @@
+/*  Hardware performance counters
+
+    A time per iteration says how fast the benchmark ran, but not
+    why.  Counters opens groups of counters with the Linux
+    perf_event_open system call: processor cycles, instructions,
+    and branch misses; level 1 data and last level cache misses;
+    floating point arithmetic instructions; and, from the kernel,
+    task clock, context switches, processor migrations, and page
+    faults.  The events of a group are counted together, so the
+    ratios among them, such as instructions per cycle, are exact
+    even if the kernel has to share the hardware counters among
+    groups by time, in which case each count is scaled by the
+    fraction of the time its group was counted.
+
+    start() and stop() bracket a timed region, adding the number
+    of iterations it ran, and may be called repeatedly: counts
+    accumulate over all the regions.  report() prints each count
+    per iteration and per a smaller unit of work, such as the
+    transit of a ray through a surface.  Only events of the calling
+    thread are counted: hardware events in user mode only, and
+    software events, such as context switches, which happen in
+    the kernel, including it.
+
+    Counters are often unavailable: on other systems than Linux,
+    in virtual machines which don't expose the processor's
+    counters, or when /proc/sys/kernel/perf_event_paranoid
+    forbids them.  Groups which can't be opened are listed, with
+    the reason, and the rest are reported.  Floating point
+    operations are counted with the FP_ARITH_INST_RETIRED events
+    of Intel processors from Broadwell on, in which a fused
+    multiply-add counts as two operations.  They count SSE and
+    AVX arithmetic only, not the x87 instructions of long double,
+    nor the integer arithmetic of the multiple precision types,
+    and aren't available on other processors.  */
+
+#ifndef PERFCOUNT_H
+#define PERFCOUNT_H
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace perfcount {
+
+    class Counters {
+    private:
+        struct Event {
+            const char *name;
+            int fd;
+            double count;               // Scaled count after read()
+        };
+
+        struct Group {
+            const char *name;
+            std::vector<Event> events;  // Leader first
+            std::string problem;        // Why the group isn't counted
+            double enabled, running;    // Nanoseconds, for scaling
+        };
+
+        std::vector<Group> groups;
+        long iterations;
+
+#ifdef __linux__
+        static int open(uint32_t type, uint64_t config, int leader) {
+            struct perf_event_attr a;
+            memset(&a, 0, sizeof a);
+            a.size = sizeof a;
+            a.type = type;
+            a.config = config;
+            a.disabled = leader < 0;
+            //  Software events such as context switches happen in the kernel
+            a.exclude_kernel = a.exclude_hv = type != PERF_TYPE_SOFTWARE;
+            a.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                            PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return (int) syscall(SYS_perf_event_open, &a, 0, -1, leader, 0);
+        }
+
+        static uint64_t cache(uint64_t c) {
+            return c | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+#endif
+
+        /*  Open a group of n events.  If the leader can't be opened,
+            the group isn't counted; a member which can't be opened
+            is dropped.  */
+        void add(const char *name, int n, const char *const names[],
+                 const uint32_t types[], const uint64_t configs[]) {
+            Group g;
+            g.name = name;
+            g.enabled = g.running = 0;
+#ifdef __linux__
+            for (int i = 0; i < n; i++) {
+                Event e;
+                e.name = names[i];
+                e.count = 0;
+                e.fd = open(types[i], configs[i], g.events.empty() ? -1 : g.events[0].fd);
+                if (e.fd >= 0) {
+                    g.events.push_back(e);
+                } else if (i == 0) {
+                    g.problem = strerror(errno);
+                    break;
+                }
+            }
+#else
+            (void) n; (void) names; (void) types; (void) configs;
+            g.problem = "performance counters are supported only on Linux";
+#endif
+            groups.push_back(g);
+        }
+
+        //  Does the processor have Intel's FP_ARITH_INST_RETIRED events?
+        static bool intelArith(void) {
+#if defined(__x86_64__) || defined(__i386__)
+            unsigned int eax, ebx, ecx, edx;
+            if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx)) {
+                return false;
+            }
+            const bool intel = ebx == 0x756e6547 && edx == 0x49656e69 &&
+                               ecx == 0x6c65746e;        // "GenuineIntel"
+            __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+            return intel && ((eax >> 8) & 0xF) == 6;
+#else
+            return false;
+#endif
+        }
+
+        void ioctlGroups(unsigned long request) {
+#ifdef __linux__
+            for (size_t i = 0; i < groups.size(); i++) {
+                if (!groups[i].events.empty()) {
+                    ioctl(groups[i].events[0].fd, request, PERF_IOC_FLAG_GROUP);
+                }
+            }
+#else
+            (void) request;
+#endif
+        }
+
+        //  Read the counts of every group, scaled to the time enabled
+        void read(void) {
+#ifdef __linux__
+            for (size_t i = 0; i < groups.size(); i++) {
+                Group &g = groups[i];
+                if (g.events.empty()) {
+                    continue;
+                }
+                std::vector<uint64_t> v(3 + g.events.size());
+                if (::read(g.events[0].fd, &v[0], v.size() * sizeof v[0]) <
+                    (ssize_t) (v.size() * sizeof v[0])) {
+                    g.problem = "counts could not be read";
+                    continue;
+                }
+                g.enabled = (double) v[1];
+                g.running = (double) v[2];
+                if (g.running == 0 && g.enabled > 0) {
+                    g.problem = "never scheduled on the processor's counters";
+                    continue;
+                }
+                const double scale = (g.running > 0) ? g.enabled / g.running : 0;
+                for (size_t j = 0; j < g.events.size(); j++) {
+                    g.events[j].count = v[3 + j] * scale;
+                }
+            }
+#endif
+        }
+
+        //  Count of the named event, or -1 if it wasn't counted
+        double count(const char *name) const {
+            for (size_t i = 0; i < groups.size(); i++) {
+                if (!groups[i].problem.empty()) {
+                    continue;
+                }
+                for (size_t j = 0; j < groups[i].events.size(); j++) {
+                    if (strcmp(groups[i].events[j].name, name) == 0) {
+                        return groups[i].events[j].count;
+                    }
+                }
+            }
+            return -1;
+        }
+
+        Counters(const Counters &);
+        Counters &operator=(const Counters &);
+
+    public:
+        Counters() : iterations(0) {
+#ifdef __linux__
+            static const char *const coreNames[] = {
+                "Cycles", "Instructions", "Branch misses"
+            };
+            static const uint32_t coreTypes[] = {
+                PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE
+            };
+            static const uint64_t coreConfigs[] = {
+                PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_BRANCH_MISSES
+            };
+            add("Processor", 3, coreNames, coreTypes, coreConfigs);
+
+            static const char *const cacheNames[] = {
+                "L1D read misses", "LLC read misses"
+            };
+            static const uint32_t cacheTypes[] = {
+                PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE
+            };
+            static const uint64_t cacheConfigs[] = {
+                cache(PERF_COUNT_HW_CACHE_L1D), cache(PERF_COUNT_HW_CACHE_LL)
+            };
+            add("Cache", 2, cacheNames, cacheTypes, cacheConfigs);
+
+            //  FP_ARITH_INST_RETIRED: event 0xC7, unit masks by width
+            static const char *const fpNames[] = {
+                "FP scalar double", "FP 128-bit double", "FP 256-bit double",
+                "FP 512-bit double"
+            };
+            static const uint32_t fpTypes[] = {
+                PERF_TYPE_RAW, PERF_TYPE_RAW, PERF_TYPE_RAW, PERF_TYPE_RAW
+            };
+            static const uint64_t fpConfigs[] = {
+                0x01C7, 0x04C7, 0x10C7, 0x40C7
+            };
+            if (intelArith()) {
+                add("Floating point", 4, fpNames, fpTypes, fpConfigs);
+            } else {
+                Group g;
+                g.name = "Floating point";
+                g.enabled = g.running = 0;
+                g.problem = "no arithmetic events known for this processor";
+                groups.push_back(g);
+            }
+
+            static const char *const swNames[] = {
+                "Task clock (ns)", "Context switches", "CPU migrations", "Page faults"
+            };
+            static const uint32_t swTypes[] = {
+                PERF_TYPE_SOFTWARE, PERF_TYPE_SOFTWARE, PERF_TYPE_SOFTWARE,
+                PERF_TYPE_SOFTWARE
+            };
+            static const uint64_t swConfigs[] = {
+                PERF_COUNT_SW_TASK_CLOCK, PERF_COUNT_SW_CONTEXT_SWITCHES,
+                PERF_COUNT_SW_CPU_MIGRATIONS, PERF_COUNT_SW_PAGE_FAULTS
+            };
+            add("Kernel", 4, swNames, swTypes, swConfigs);
+#else
+            add("Processor", 0, NULL, NULL, NULL);
+#endif
+        }
+
+        ~Counters() {
+#ifdef __linux__
+            for (size_t i = 0; i < groups.size(); i++) {
+                for (size_t j = 0; j < groups[i].events.size(); j++) {
+                    close(groups[i].events[j].fd);
+                }
+            }
+#endif
+        }
+
+        void start(void) {
+#ifdef __linux__
+            ioctlGroups(PERF_EVENT_IOC_ENABLE);
+#endif
+        }
+
+        void stop(long n) {
+#ifdef __linux__
+            ioctlGroups(PERF_EVENT_IOC_DISABLE);
+#endif
+            iterations += n;
+        }
+
+        /*  Report the counts per iteration and per unit of work, of
+            which there are perIteration in an iteration.  */
+        void report(std::ostream &os, const char *unit, double perIteration) {
+            read();
+            char line[100];
+            const std::string title = "Counters for " + std::to_string(iterations) +
+                                      " iterations",
+                              per = std::string("Per ") + unit;
+            snprintf(line, sizeof line, "%-32s %14s  %12s", title.c_str(), "Per iteration",
+                per.c_str());
+            os << line << std::endl;
+            if (iterations <= 0) {
+                return;
+            }
+            for (size_t i = 0; i < groups.size(); i++) {
+                const Group &g = groups[i];
+                if (!g.problem.empty()) {
+                    snprintf(line, sizeof line, "    %-16s unavailable: %s", g.name,
+                        g.problem.c_str());
+                    os << line << std::endl;
+                    continue;
+                }
+                for (size_t j = 0; j < g.events.size(); j++) {
+                    const double n = g.events[j].count / iterations;
+                    snprintf(line, sizeof line, "    %-28s %14.3f  %12.4f",
+                        g.events[j].name, n, n / perIteration);
+                    os << line << std::endl;
+                }
+                if (g.running < g.enabled) {
+                    snprintf(line, sizeof line, "    %-28s scaled, counted %.1f%% of the time",
+                        "", (100 * g.running) / g.enabled);
+                    os << line << std::endl;
+                }
+            }
+
+            const double cycles = count("Cycles"), instructions = count("Instructions");
+            if (cycles > 0 && instructions >= 0) {
+                snprintf(line, sizeof line, "    %-28s %14.3f", "Instructions per cycle",
+                    instructions / cycles);
+                os << line << std::endl;
+            }
+            const double sd = count("FP scalar double"), pd128 = count("FP 128-bit double"),
+                         pd256 = count("FP 256-bit double"), pd512 = count("FP 512-bit double");
+            if (sd >= 0) {
+                const double flops = (sd + 2 * (pd128 > 0 ? pd128 : 0) +
+                                      4 * (pd256 > 0 ? pd256 : 0) +
+                                      8 * (pd512 > 0 ? pd512 : 0)) / iterations;
+                if (flops > 0) {
+                    snprintf(line, sizeof line, "    %-28s %14.3f  %12.4f",
+                        "Double precision FLOPs", flops, flops / perIteration);
+                } else {
+                    snprintf(line, sizeof line, "    %-28s none counted", "Double precision FLOPs");
+                }
+                os << line << std::endl;
+            }
+        }
+    };
+}
+
+#endif
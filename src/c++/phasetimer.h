@@ -0,0 +1,261 @@
+/*  Scoped phase timers
+
+    A Scope measures the time from its construction to its
+    destruction, reading the processor's time stamp counter on x86
+    and the monotonic clock elsewhere, and adds it to the totals of
+    a phase.  Scopes nest: the time of a scope is its phase's total
+    time, and that time less the time of the scopes nested within
+    it is its phase's self time, so the self times of all phases add
+    up to the time measured, and each says how much was spent in
+    that phase's own code.  Phases are listed in the enumeration
+    below, with the depth at which they appear, for indenting the
+    report.
+
+    When recording is enabled, each scope is also kept as an event,
+    up to a limit, and trace() writes them in the Chrome trace event
+    format, which chrome://tracing and ui.perfetto.dev display as a
+    timeline.
+
+    Every scope reads the clock twice, which takes some tens of
+    cycles, as much as a short phase.  report() measures the cost
+    of an empty scope, both the part which falls within its own
+    measured time and the part which falls within its parent's,
+    and removes them from the self time of each phase, using the
+    number of calls on it and of scopes nested directly within it.
+    Total times include the overhead of all the scopes within
+    them, and are shown as measured.  The totals are kept for each
+    thread, and report() and trace() show those of the thread
+    which calls them.
+
+    The program is built with PHASE_TIMERS defined to include the
+    timers; otherwise fbench.cpp defines the scopes away and they
+    cost nothing.  */
+
+#ifndef PHASETIMER_H
+#define PHASETIMER_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace phasetimer {
+
+    enum Phase {
+        Evaluate, TraceLine, Transit, ParaxialCurved, ParaxialFlat,
+        MarginalCurved, MarginalFlat, Trig, Report, Validate,
+        nPhases
+    };
+
+    static const char *const names[nPhases] = {
+        "evaluate", "traceLine", "transitSurface", "Paraxial curved",
+        "Paraxial flat", "Marginal curved", "Marginal flat",
+        "Trigonometric", "report", "validate"
+    };
+
+    //  Nesting depth of each phase, for indenting the report
+    static const int depths[nPhases] = { 0, 1, 2, 3, 3, 3, 3, 4, 0, 0 };
+
+    inline uint64_t ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    struct Totals {
+        uint64_t calls, total, children;
+        uint64_t nested;                // Scopes directly within
+    };
+
+    struct Event {
+        Phase phase;
+        uint64_t start, duration;
+    };
+
+    struct State {
+        static const int MaxDepth = 32;
+
+        Totals totals[nPhases];
+        uint64_t children[MaxDepth];    // Time in scopes nested at each depth
+        uint64_t nested[MaxDepth];      // Number of them
+        int depth;
+        bool recording;
+        size_t maxEvents;
+        std::vector<Event> events;
+
+        //  Origin, for converting ticks to seconds
+        uint64_t ticks0;
+        std::chrono::steady_clock::time_point time0;
+
+        State() : depth(0), recording(false), maxEvents(0),
+                  ticks0(ticks()), time0(std::chrono::steady_clock::now()) {
+            clear();
+        }
+
+        void clear(void) {
+            for (int i = 0; i < nPhases; i++) {
+                totals[i].calls = totals[i].total = totals[i].children =
+                    totals[i].nested = 0;
+            }
+            children[0] = nested[0] = 0;
+            events.clear();
+        }
+
+        //  Ticks per second, from the time since the State was created
+        double rate(void) const {
+            const double s = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - time0).count();
+            return (s > 0) ? (ticks() - ticks0) / s : 1e9;
+        }
+    };
+
+    inline State &state(void) {
+        static thread_local State s;
+        return s;
+    }
+
+    class Scope {
+    private:
+        const Phase phase;
+        uint64_t start;
+
+        Scope(const Scope &);
+        Scope &operator=(const Scope &);
+
+    public:
+        explicit Scope(Phase p) : phase(p) {
+            State &s = state();
+            if (s.depth < State::MaxDepth - 1) {
+                s.depth++;
+                s.children[s.depth] = s.nested[s.depth] = 0;
+            }
+            start = ticks();
+        }
+
+        ~Scope() {
+            const uint64_t d = ticks() - start;
+            State &s = state();
+            Totals &t = s.totals[phase];
+            t.calls++;
+            t.total += d;
+            t.children += s.children[s.depth];
+            t.nested += s.nested[s.depth];
+            if (s.depth > 0) {
+                s.depth--;
+            }
+            s.children[s.depth] += d;
+            s.nested[s.depth]++;
+            if (s.recording && s.events.size() < s.maxEvents) {
+                const Event e = { phase, start, d };
+                s.events.push_back(e);
+            }
+        }
+    };
+
+    //  Clear the totals and record up to maxEvents events, if not zero
+    inline void reset(size_t maxEvents = 0) {
+        State &s = state();
+        s.clear();
+        s.recording = maxEvents > 0;
+        s.maxEvents = maxEvents;
+        if (s.recording) {
+            s.events.reserve(maxEvents);
+        }
+    }
+
+    /*  Average ticks of an empty scope of phase p, as seen from
+        outside it, and of these those within its own time.  */
+    inline void overhead(Phase p, double &outside, double &inside) {
+        State &s = state();
+        const Totals saved = s.totals[p];
+        const uint64_t children = s.children[s.depth], nested = s.nested[s.depth];
+        const bool recording = s.recording;
+        s.recording = false;
+        s.totals[p].calls = s.totals[p].total = 0;
+        const int n = 100000;
+        const uint64_t t0 = ticks();
+        for (int i = 0; i < n; i++) {
+            Scope empty(p);
+        }
+        outside = (double) (ticks() - t0) / n;
+        inside = (double) s.totals[p].total / n;
+        s.totals[p] = saved;
+        s.children[s.depth] = children;
+        s.nested[s.depth] = nested;
+        s.recording = recording;
+    }
+
+    /*  Report the calls, total and self time, and self time per
+        call of each phase which was entered.  */
+    inline void report(std::ostream &os) {
+        State &s = state();
+        double outside, inside;
+        overhead(Trig, outside, inside);
+        const double rate = s.rate();
+        const double ms = 1e3 / rate, ns = 1e9 / rate;
+
+        //  Self time of each phase less the timers' overhead
+        double own[nPhases], self = 0;
+        for (int i = 0; i < nPhases; i++) {
+            const Totals &t = s.totals[i];
+            own[i] = (double) (t.total - t.children) - t.calls * inside -
+                     t.nested * (outside - inside);
+            own[i] = (own[i] > 0) ? own[i] : 0;
+            self += own[i];
+        }
+
+        char line[100], name[40];
+        snprintf(line, sizeof line, "%-24s %10s %11s %11s %7s %9s", "Phase", "Calls",
+            "Total ms", "Self ms", "Self %", "ns/call");
+        os << line << std::endl;
+        for (int i = 0; i < nPhases; i++) {
+            const Totals &t = s.totals[i];
+            if (t.calls == 0) {
+                continue;
+            }
+            snprintf(name, sizeof name, "%*s%s", 2 * depths[i], "", names[i]);
+            snprintf(line, sizeof line, "%-24s %10llu %11.3f %11.3f %6.1f%% %9.1f", name,
+                (unsigned long long) t.calls, t.total * ms, own[i] * ms,
+                (self > 0) ? (100.0 * own[i]) / self : 0, (own[i] * ns) / t.calls);
+            os << line << std::endl;
+        }
+        snprintf(line, sizeof line, "Timer overhead %.1f ns per scope, %.1f within it, "
+            "removed from self times", outside * ns, inside * ns);
+        os << line << std::endl;
+    }
+
+    /*  Write the recorded events as a Chrome trace, returning false
+        if the file can't be written.  */
+    inline bool trace(const char *fileName) {
+        const State &s = state();
+        FILE *f = fopen(fileName, "w");
+        if (f == NULL) {
+            return false;
+        }
+        const double us = 1e6 / s.rate();
+        uint64_t first = s.events.empty() ? 0 : s.events[0].start;
+        for (size_t i = 0; i < s.events.size(); i++) {
+            first = (s.events[i].start < first) ? s.events[i].start : first;
+        }
+        fprintf(f, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+        for (size_t i = 0; i < s.events.size(); i++) {
+            const Event &e = s.events[i];
+            fprintf(f, "  {\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+                       "\"ts\": %.4f, \"dur\": %.4f}%s\n",
+                names[e.phase], (e.start - first) * us, e.duration * us,
+                (i + 1 < s.events.size()) ? "," : "");
+        }
+        fprintf(f, "]}\n");
+        return fclose(f) == 0;
+    }
+}
+
+#endif
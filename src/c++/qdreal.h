@@ -0,0 +1,565 @@
+/*  Quad-double arithmetic for the floating point benchmark
+
+    A qdreal represents a number as the unevaluated sum of four
+    IEEE doubles, x[0] + x[1] + x[2] + x[3], each no larger than
+    half a unit in the last place of its predecessor, giving about
+    212 bits (64 decimal digits) of mantissa.  Like ddreal, on
+    whose error-free transformations and constant tables it is
+    built, a qdreal never allocates memory.  Addition is the
+    IEEE-style accurate merge and multiplication and division
+    follow the QD library of Hida, Li, and Bailey.
+
+    The trigonometric functions use the same argument reduction
+    and self-terminating Taylor series as ddreal.  The arc sine
+    starts from the double-double arc sine, which is already
+    correct to 106 bits, and takes a single Newton step in full
+    quad-double precision.  */
+
+#ifndef QDREAL_H
+#define QDREAL_H
+
+#include "ddreal.h"
+
+namespace ddqd {
+
+    //  Three-way sums used in accumulating partial results
+
+    inline void three_sum(double &a, double &b, double &c) {
+        double t1, t2, t3;
+        t1 = two_sum(a, b, t2);
+        a = two_sum(c, t1, t3);
+        b = two_sum(t2, t3, c);
+    }
+
+    inline void three_sum2(double &a, double &b, double &c) {
+        double t1, t2, t3;
+        t1 = two_sum(a, b, t2);
+        a = two_sum(c, t1, t3);
+        b = t2 + t3;
+    }
+
+    /*  Accumulate c into the pair (a, b), returning a completed
+        component if one has been produced, else zero.  */
+    inline double quick_three_accum(double &a, double &b, double c) {
+        double s;
+        bool za, zb;
+
+        s = two_sum(b, c, b);
+        s = two_sum(a, s, a);
+
+        za = (a != 0.0);
+        zb = (b != 0.0);
+
+        if (za && zb) {
+            return s;
+        }
+        if (!zb) {
+            b = a;
+            a = s;
+        } else {
+            a = s;
+        }
+        return 0.0;
+    }
+
+    //  Renormalise five overlapping components into four
+    inline void renorm(double &c0, double &c1, double &c2, double &c3,
+                       double &c4) {
+        double s0, s1, s2 = 0.0, s3 = 0.0;
+
+        if (std::isinf(c0)) {
+            return;
+        }
+
+        s0 = quick_two_sum(c3, c4, c4);
+        s0 = quick_two_sum(c2, s0, c3);
+        s0 = quick_two_sum(c1, s0, c2);
+        c0 = quick_two_sum(c0, s0, c1);
+
+        s0 = c0;
+        s1 = c1;
+
+        if (s1 != 0.0) {
+            s1 = quick_two_sum(s1, c2, s2);
+            if (s2 != 0.0) {
+                s2 = quick_two_sum(s2, c3, s3);
+                if (s3 != 0.0) {
+                    s3 += c4;
+                } else {
+                    s2 = quick_two_sum(s2, c4, s3);
+                }
+            } else {
+                s1 = quick_two_sum(s1, c3, s2);
+                if (s2 != 0.0) {
+                    s2 = quick_two_sum(s2, c4, s3);
+                } else {
+                    s1 = quick_two_sum(s1, c4, s2);
+                }
+            }
+        } else {
+            s0 = quick_two_sum(s0, c2, s1);
+            if (s1 != 0.0) {
+                s1 = quick_two_sum(s1, c3, s2);
+                if (s2 != 0.0) {
+                    s2 = quick_two_sum(s2, c4, s3);
+                } else {
+                    s1 = quick_two_sum(s1, c4, s2);
+                }
+            } else {
+                s0 = quick_two_sum(s0, c3, s1);
+                if (s1 != 0.0) {
+                    s1 = quick_two_sum(s1, c4, s2);
+                } else {
+                    s0 = quick_two_sum(s0, c4, s1);
+                }
+            }
+        }
+
+        c0 = s0;
+        c1 = s1;
+        c2 = s2;
+        c3 = s3;
+    }
+
+    class qdreal {
+    public:
+        double x[4];
+
+        //  Constructors
+        qdreal() {
+            x[0] = x[1] = x[2] = x[3] = 0.0;
+        }
+        qdreal(double x0) {
+            x[0] = x0;
+            x[1] = x[2] = x[3] = 0.0;
+        }
+        qdreal(double x0, double x1, double x2, double x3) {
+            x[0] = x0;
+            x[1] = x1;
+            x[2] = x2;
+            x[3] = x3;
+        }
+        qdreal(const ddreal &a) {
+            x[0] = a.hi;
+            x[1] = a.lo;
+            x[2] = x[3] = 0.0;
+        }
+        explicit qdreal(const double *c) {
+            x[0] = c[0];
+            x[1] = c[1];
+            x[2] = c[2];
+            x[3] = c[3];
+        }
+
+        //  Machine epsilon: 2^-209
+        static double eps() { return 1.21543267145725e-63; }
+
+        //  Nearest double
+        double toDouble(void) const { return x[0]; }
+
+        //  Leading double-double
+        ddreal toDD(void) const { return ddreal(x[0], x[1]); }
+
+        //  Edit to a string with a printf-like "%w.pf" format
+        std::string toString(const char *format) const;
+
+        qdreal operator-() const { return qdreal(-x[0], -x[1], -x[2], -x[3]); }
+
+        qdreal &operator+=(const qdreal &b);
+        qdreal &operator-=(const qdreal &b);
+        qdreal &operator*=(const qdreal &b);
+        qdreal &operator/=(const qdreal &b);
+    };
+
+    //  Arithmetic
+
+    inline qdreal operator+(const qdreal &a, const qdreal &b) {
+        /*  Merge the components of the two operands in order of
+            decreasing magnitude, accumulating them into a
+            three-component running sum.  */
+        int i = 0, j = 0, k = 0;
+        double s, t, u, v;
+        double x[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+        if (std::fabs(a.x[i]) > std::fabs(b.x[j])) {
+            u = a.x[i++];
+        } else {
+            u = b.x[j++];
+        }
+        if (std::fabs(a.x[i]) > std::fabs(b.x[j])) {
+            v = a.x[i++];
+        } else {
+            v = b.x[j++];
+        }
+
+        u = quick_two_sum(u, v, v);
+
+        while (k < 4) {
+            if (i >= 4 && j >= 4) {
+                x[k] = u;
+                if (k < 3) {
+                    x[++k] = v;
+                }
+                break;
+            }
+
+            if (i >= 4) {
+                t = b.x[j++];
+            } else if (j >= 4) {
+                t = a.x[i++];
+            } else if (std::fabs(a.x[i]) > std::fabs(b.x[j])) {
+                t = a.x[i++];
+            } else {
+                t = b.x[j++];
+            }
+
+            s = quick_three_accum(u, v, t);
+
+            if (s != 0.0) {
+                x[k++] = s;
+            }
+        }
+
+        //  Add the remaining components into the last place
+        for (k = i; k < 4; k++) {
+            x[3] += a.x[k];
+        }
+        for (k = j; k < 4; k++) {
+            x[3] += b.x[k];
+        }
+
+        double x4 = 0.0;
+        renorm(x[0], x[1], x[2], x[3], x4);
+        return qdreal(x[0], x[1], x[2], x[3]);
+    }
+
+    inline qdreal operator+(const qdreal &a, double b) {
+        double c0, c1, c2, c3, e;
+
+        c0 = two_sum(a.x[0], b, e);
+        c1 = two_sum(a.x[1], e, e);
+        c2 = two_sum(a.x[2], e, e);
+        c3 = two_sum(a.x[3], e, e);
+
+        renorm(c0, c1, c2, c3, e);
+        return qdreal(c0, c1, c2, c3);
+    }
+
+    inline qdreal operator+(double a, const qdreal &b) {
+        return b + a;
+    }
+
+    inline qdreal operator-(const qdreal &a, const qdreal &b) {
+        return a + (-b);
+    }
+
+    inline qdreal operator-(const qdreal &a, double b) {
+        return a + (-b);
+    }
+
+    inline qdreal operator-(double a, const qdreal &b) {
+        return (-b) + a;
+    }
+
+    inline qdreal operator*(const qdreal &a, double b) {
+        double p0, p1, p2, p3;
+        double q0, q1, q2;
+        double s0, s1, s2, s3, s4;
+
+        p0 = two_prod(a.x[0], b, q0);
+        p1 = two_prod(a.x[1], b, q1);
+        p2 = two_prod(a.x[2], b, q2);
+        p3 = a.x[3] * b;
+
+        s0 = p0;
+        s1 = two_sum(q0, p1, s2);
+        three_sum(s2, q1, p2);
+        three_sum2(q1, q2, p3);
+        s3 = q1;
+        s4 = q2 + p2;
+
+        renorm(s0, s1, s2, s3, s4);
+        return qdreal(s0, s1, s2, s3);
+    }
+
+    inline qdreal operator*(double a, const qdreal &b) {
+        return b * a;
+    }
+
+    inline qdreal operator*(const qdreal &a, const qdreal &b) {
+        double p0, p1, p2, p3, p4, p5;
+        double q0, q1, q2, q3, q4, q5;
+        double t0, t1;
+        double s0, s1, s2;
+
+        p0 = two_prod(a.x[0], b.x[0], q0);
+
+        p1 = two_prod(a.x[0], b.x[1], q1);
+        p2 = two_prod(a.x[1], b.x[0], q2);
+
+        p3 = two_prod(a.x[0], b.x[2], q3);
+        p4 = two_prod(a.x[1], b.x[1], q4);
+        p5 = two_prod(a.x[2], b.x[0], q5);
+
+        //  Start accumulation
+        three_sum(p1, p2, q0);
+
+        //  Six-three sum of p2, q1, q2, p3, p4, p5
+        three_sum(p2, q1, q2);
+        three_sum(p3, p4, p5);
+        //  (s0, s1, s2) = (p2, q1, q2) + (p3, p4, p5)
+        s0 = two_sum(p2, p3, t0);
+        s1 = two_sum(q1, p4, t1);
+        s2 = q2 + p5;
+        s1 = two_sum(s1, t0, t0);
+        s2 += (t0 + t1);
+
+        //  O(eps^3) order terms
+        s1 += a.x[0] * b.x[3] + a.x[1] * b.x[2] + a.x[2] * b.x[1] +
+              a.x[3] * b.x[0] + q0 + q3 + q4 + q5;
+
+        renorm(p0, p1, s0, s1, s2);
+        return qdreal(p0, p1, s0, s1);
+    }
+
+    inline qdreal sqr(const qdreal &a) {
+        return a * a;
+    }
+
+    inline qdreal operator/(const qdreal &a, const qdreal &b) {
+        //  Long division, one double at a time
+        double q0, q1, q2, q3, q4;
+        qdreal r;
+
+        q0 = a.x[0] / b.x[0];
+        r = a - (b * q0);
+
+        q1 = r.x[0] / b.x[0];
+        r -= (b * q1);
+
+        q2 = r.x[0] / b.x[0];
+        r -= (b * q2);
+
+        q3 = r.x[0] / b.x[0];
+        r -= (b * q3);
+
+        q4 = r.x[0] / b.x[0];
+
+        renorm(q0, q1, q2, q3, q4);
+        return qdreal(q0, q1, q2, q3);
+    }
+
+    inline qdreal operator/(const qdreal &a, double b) {
+        return a / qdreal(b);
+    }
+
+    inline qdreal operator/(double a, const qdreal &b) {
+        return qdreal(a) / b;
+    }
+
+    inline qdreal &qdreal::operator+=(const qdreal &b) {
+        return *this = *this + b;
+    }
+
+    inline qdreal &qdreal::operator-=(const qdreal &b) {
+        return *this = *this - b;
+    }
+
+    inline qdreal &qdreal::operator*=(const qdreal &b) {
+        return *this = *this * b;
+    }
+
+    inline qdreal &qdreal::operator/=(const qdreal &b) {
+        return *this = *this / b;
+    }
+
+    //  Comparison
+
+    inline bool operator==(const qdreal &a, const qdreal &b) {
+        return a.x[0] == b.x[0] && a.x[1] == b.x[1] &&
+               a.x[2] == b.x[2] && a.x[3] == b.x[3];
+    }
+    inline bool operator==(const qdreal &a, double b) {
+        return a.x[0] == b && a.x[1] == 0.0 &&
+               a.x[2] == 0.0 && a.x[3] == 0.0;
+    }
+    inline bool operator!=(const qdreal &a, const qdreal &b) {
+        return !(a == b);
+    }
+    inline bool operator!=(const qdreal &a, double b) {
+        return !(a == b);
+    }
+    inline bool operator<(const qdreal &a, const qdreal &b) {
+        for (int i = 0; i < 4; i++) {
+            if (a.x[i] != b.x[i]) {
+                return a.x[i] < b.x[i];
+            }
+        }
+        return false;
+    }
+    inline bool operator<(const qdreal &a, double b) {
+        return a < qdreal(b);
+    }
+    inline bool operator>(const qdreal &a, const qdreal &b) {
+        return b < a;
+    }
+    inline bool operator>(const qdreal &a, double b) {
+        return qdreal(b) < a;
+    }
+    inline bool operator<=(const qdreal &a, const qdreal &b) {
+        return !(b < a);
+    }
+    inline bool operator<=(const qdreal &a, double b) {
+        return !(qdreal(b) < a);
+    }
+    inline bool operator>=(const qdreal &a, const qdreal &b) {
+        return !(a < b);
+    }
+    inline bool operator>=(const qdreal &a, double b) {
+        return !(a < qdreal(b));
+    }
+
+    //  Mathematical functions
+
+    inline qdreal fabs(const qdreal &a) {
+        return (a.x[0] < 0.0) ? -a : a;
+    }
+
+    inline qdreal sqrt(const qdreal &a) {
+        /*  Three Newton iterations on 1 / sqrt(a), starting from
+            the double approximation, then multiply by a.  */
+        if (a.x[0] <= 0.0) {
+            return (a.x[0] == 0.0) ? qdreal(0.0) :
+                qdreal(std::numeric_limits<double>::quiet_NaN());
+        }
+        qdreal r = 1.0 / std::sqrt(a.x[0]);
+        const qdreal h = a * 0.5;
+
+        r += ((0.5 - h * sqr(r)) * r);
+        r += ((0.5 - h * sqr(r)) * r);
+        r += ((0.5 - h * sqr(r)) * r);
+
+        return r * a;
+    }
+
+    //  Reduce a modulo pi / 2, as for ddreal
+    inline qdreal reduce_pi_2(const qdreal &a, int &j) {
+        double q = std::floor(a.x[0] / pi_2[0] + 0.5);
+        j = 0;
+        if (q == 0.0) {
+            return a;
+        }
+        j = ((int) std::fmod(q, 4.0) + 4) & 3;
+        return a - qdreal(pi_2) * q;
+    }
+
+    //  Sine by Taylor series, |a| <= pi / 4
+    inline qdreal sin_taylor(const qdreal &a) {
+        if (a.x[0] == 0.0) {
+            return a;
+        }
+        const double thresh = 0.5 * std::fabs(a.x[0]) * qdreal::eps();
+        const qdreal x2 = -sqr(a);
+        qdreal s = a, p = a, t;
+        int i = 0;
+        do {
+            p *= x2;
+            t = p * qdreal(inv_fact[i]);
+            s += t;
+            i += 2;
+        } while (i < n_inv_fact && std::fabs(t.x[0]) > thresh);
+        return s;
+    }
+
+    //  Cosine by Taylor series, |a| <= pi / 4
+    inline qdreal cos_taylor(const qdreal &a) {
+        if (a.x[0] == 0.0) {
+            return qdreal(1.0);
+        }
+        const double thresh = 0.5 * qdreal::eps();
+        const qdreal x2 = -sqr(a);
+        qdreal s = 1.0 + x2 * 0.5, p = x2, t;
+        int i = 1;
+        do {
+            p *= x2;
+            t = p * qdreal(inv_fact[i]);
+            s += t;
+            i += 2;
+        } while (i < n_inv_fact && std::fabs(t.x[0]) > thresh);
+        return s;
+    }
+
+    inline void sincos(const qdreal &a, qdreal &sin_a, qdreal &cos_a) {
+        int j;
+        const qdreal r = reduce_pi_2(a, j);
+        const qdreal s = sin_taylor(r);
+        const qdreal c = sqrt(1.0 - sqr(s));
+
+        switch (j) {
+            case 0:     sin_a = s;      cos_a = c;      break;
+            case 1:     sin_a = c;      cos_a = -s;     break;
+            case 2:     sin_a = -s;     cos_a = -c;     break;
+            default:    sin_a = -c;     cos_a = s;      break;
+        }
+    }
+
+    inline qdreal sin(const qdreal &a) {
+        int j;
+        const qdreal r = reduce_pi_2(a, j);
+
+        switch (j) {
+            case 0:     return sin_taylor(r);
+            case 1:     return cos_taylor(r);
+            case 2:     return -sin_taylor(r);
+            default:    return -cos_taylor(r);
+        }
+    }
+
+    inline qdreal cos(const qdreal &a) {
+        int j;
+        const qdreal r = reduce_pi_2(a, j);
+
+        switch (j) {
+            case 0:     return cos_taylor(r);
+            case 1:     return -sin_taylor(r);
+            case 2:     return -cos_taylor(r);
+            default:    return sin_taylor(r);
+        }
+    }
+
+    inline qdreal tan(const qdreal &a) {
+        qdreal s, c;
+        sincos(a, s, c);
+        return s / c;
+    }
+
+    inline qdreal cot(const qdreal &a) {
+        qdreal s, c;
+        sincos(a, s, c);
+        return c / s;
+    }
+
+    inline qdreal asin(const qdreal &a) {
+        if (std::fabs(a.x[0]) >= 1.0) {
+            if (fabs(a) == 1.0) {
+                return (a.x[0] > 0.0) ? qdreal(pi_2) : -qdreal(pi_2);
+            }
+            return qdreal(std::numeric_limits<double>::quiet_NaN());
+        }
+        qdreal z = asin(a.toDD()), s, c;
+        sincos(z, s, c);
+        return z + (a - s) / c;
+    }
+
+    inline std::string qdreal::toString(const char *format) const {
+        int width, places;
+        realedit::parseFormat(format, width, places);
+        return realedit::edit(*this, width, places);
+    }
+
+    inline std::ostream &operator<<(std::ostream &os, const qdreal &a) {
+        return os << a.toString("%16.11f");
+    }
+}
+
+#endif
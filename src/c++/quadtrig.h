@@ -0,0 +1,320 @@
+/*  Fast trigonometric functions for __float128
+
+    The libquadmath functions sinq, cosq, tanq, and asinq are
+    written to be correct for any argument, and pay for it with
+    general-purpose argument reduction and long rational
+    approximations.  The ray tracer only ever evaluates them on
+    small angles and on arc sine arguments well below one, so
+    these functions are tuned for that case.
+
+    Sine and cosine are evaluated with minimax polynomials found
+    with the Remez exchange algorithm in 90 digit arithmetic.  All
+    of the arguments the benchmark presents are less than 1/4 in
+    magnitude, and for these a separate polynomial is used, whose
+    terms fall off so rapidly that all but the first four or five
+    are smaller than 2^-49 of the result, and may be evaluated in
+    hardware long double arithmetic, which is many times faster
+    than the software __float128.  For arguments up to pi/4, a
+    polynomial with all its terms evaluated in __float128 is used.
+    The relative error of each polynomial is less than 2.6e-35 (a
+    quarter of the unit in the last place of a __float128).
+    Larger arguments are reduced modulo pi/2 by subtracting a
+    multiple of pi/2 split into three pieces (Cody and Waite),
+    the first two with few enough bits that their product with
+    the multiple is exact.  Beyond 2^30, where this is no longer
+    the case, we defer to libquadmath.
+
+    The arc sine is computed with one Newton step on the sine,
+    starting from the long double arc sine, which is accurate to
+    64 bits.  Since the correction is of the order of 2^-64 of the
+    result, it need only be computed to long double precision, so
+    the step costs one __float128 sine and a long double cosine
+    and division.  Arguments larger than 0.75, where the step
+    loses accuracy as the derivative of the sine approaches zero,
+    are handed to asinq.  */
+
+#ifndef QUADTRIG_H
+#define QUADTRIG_H
+
+#include <quadmath.h>
+#include <cmath>
+
+namespace quadtrig {
+
+    //  pi/2 in three pieces of 80, 80, and 113 bits
+    const __float128 PiOver2_1 = 0x1.921fb54442d18469898c00000000p+0Q,
+                     PiOver2_2 = 0x1.8a2e03707344a409382200000000p-81Q,
+                     PiOver2_3 = 0x1.4cf98e804177d4c76273644a2735p-164Q;
+    const __float128 TwoOverPi = 0x1.45f306dc9c882a53f84eafa3ea6ap-1Q;
+    const __float128 PiOver4 = 0x1.921fb54442d18469898cc51701b8p-1Q;
+
+    //  Largest argument reduced here
+    const __float128 ReduceLimit = 0x1p30Q;
+
+    //  Largest argument for the small argument polynomials
+    const __float128 SmallLimit = 0.25Q;
+
+    /*  Minimax coefficients for (sin(x) - x) / x^3 and
+        (cos(x) - 1 + x^2 / 2) / x^4 as polynomials in x^2 on
+        [-1/4, 1/4].  The first few are used in __float128 and the
+        rest, whose terms are less than 2^-49 of the result, in
+        long double.  */
+
+    const __float128 sinSmallCoeff[5] = {
+        -1.666666666666666666666666666666666644836e-1Q,
+        8.333333333333333333333333333327680982388e-3Q,
+        -1.984126984126984126984126960031053771112e-4Q,
+        2.755731922398589065255336383820930256648e-6Q,
+        -2.505210838544171874252374467174225650126e-8Q
+    };
+    const long double sinSmallTail[4] = {
+        1.605904383682146431831215462110804121619e-10L,
+        -7.647163731411942947289687878653419505342e-13L,
+        2.811456609125067127449779150098035854151e-15L,
+        -8.215130565131939619315859443689170147558e-18L
+    };
+
+    const __float128 cosSmallCoeff[4] = {
+        4.166666666666666666666666666666374788774e-2Q,
+        -1.388888888888888888888888882911128559342e-3Q,
+        2.480158730158730158729957873853155362262e-5Q,
+        -2.755731922398589062684718932655150252883e-7Q
+    };
+    const long double cosSmallTail[4] = {
+        2.087675698786793736854248940793814943439e-9L,
+        -1.147074559717807393808031418210227957587e-11L,
+        4.779476289206718594538073259731001611187e-14L,
+        -1.560893451879990083105236681552614303900e-16L
+    };
+
+    /*  Minimax coefficients for (1/x - cot(x)) / x as a
+        polynomial in x^2 on [-1/4, 1/4], split in the same way.  */
+
+    const __float128 cotSmallCoeff[6] = {
+        3.333333333333333333333333333333333335014e-1Q,
+        2.222222222222222222222222222222131533184e-2Q,
+        2.116402116402116402116402117213204847990e-3Q,
+        2.116402116402116402116399266162362554977e-4Q,
+        2.137779915557693335476316867422584358196e-5Q,
+        2.164404280806397202860787873195155044496e-6Q
+    };
+    const long double cotSmallTail[7] = {
+        2.192594785187381720538666488671713838272e-7L,
+        2.221460878996127955789711525344104085431e-8L,
+        2.250784652268605667518682214600527257878e-9L,
+        2.280514991677980948869132726517744623428e-10L,
+        2.310662291258817451638900036823547506345e-11L,
+        2.339359538492045721564141238567109961361e-12L,
+        2.472075370782234285195174248839692876587e-13L
+    };
+
+    /*  Minimax coefficients for (sin(x) - x) / x^3 and
+        (cos(x) - 1 + x^2 / 2) / x^4 as polynomials in x^2 on
+        [-pi/4, pi/4].  */
+
+    const __float128 sinCoeff[11] = {
+        -1.666666666666666666666666666666590948715e-1Q,
+        8.333333333333333333333333332627004322527e-3Q,
+        -1.984126984126984126984126754832640524676e-4Q,
+        2.755731922398589065255360412906113127391e-6Q,
+        -2.505210838544171877155255261650489013161e-8Q,
+        1.605904383682161252539489560667137653139e-10Q,
+        -7.647163731819010870021973194824315071236e-13Q,
+        2.811457254137331966602460919326281292500e-15Q,
+        -8.220634891870464991395915740897716493141e-18Q,
+        1.957255810809840547680810075864140146840e-20Q,
+        -3.844430900709117396728765530773676483385e-23Q
+    };
+
+    const __float128 cosCoeff[11] = {
+        4.166666666666666666666666666666666087768e-2Q,
+        -1.388888888888888888888888888886617612207e-3Q,
+        2.480158730158730158730158715429389430593e-5Q,
+        -2.755731922398589065255694669188489953134e-7Q,
+        2.087675698786809897872690457835207266376e-9Q,
+        -1.147074559772972434826624971117741745216e-11Q,
+        4.779477332387212862035920915528203271981e-14Q,
+        -1.561920696806390898460112462464544268421e-16Q,
+        4.110317521674944546444904082024319637595e-19Q,
+        -8.896668570290945801221967383637142119450e-22Q,
+        1.603346673034801474146094383214565929280e-24Q
+    };
+
+    /*  Evaluate a polynomial of n coefficients by Horner's rule,
+        starting from s, the value of the higher order terms
+        divided by t^n.  */
+    template <class T> inline T poly(const T *c, int n, T t, T s = 0) {
+        for (int i = n - 1; i >= 0; i--) {
+            s = s * t + c[i];
+        }
+        return s;
+    }
+
+    //  Sine and cosine for |r| <= 1/4
+    inline __float128 sinSmall(__float128 r) {
+        const __float128 t = r * r;
+        const long double tl = (long double) t;
+        const __float128 tail = poly(sinSmallTail, 4, tl);
+        return r + (r * t) * poly(sinSmallCoeff, 5, t, tail);
+    }
+
+    inline __float128 cosSmall(__float128 r) {
+        const __float128 t = r * r;
+        const long double tl = (long double) t;
+        const __float128 tail = poly(cosSmallTail, 4, tl);
+        return (1 - t / 2) + (t * t) * poly(cosSmallCoeff, 4, t, tail);
+    }
+
+    inline void sincosSmall(__float128 r, __float128 &s, __float128 &c) {
+        const __float128 t = r * r;
+        const long double tl = (long double) t;
+        const __float128 stail = poly(sinSmallTail, 4, tl),
+                         ctail = poly(cosSmallTail, 4, tl);
+        s = r + (r * t) * poly(sinSmallCoeff, 5, t, stail);
+        c = (1 - t / 2) + (t * t) * poly(cosSmallCoeff, 4, t, ctail);
+    }
+
+    //  Cotangent for 0 < |r| <= 1/4
+    inline __float128 cotSmall(__float128 r) {
+        const __float128 t = r * r;
+        const long double tl = (long double) t;
+        const __float128 tail = poly(cotSmallTail, 7, tl);
+        return 1 / r - r * poly(cotSmallCoeff, 6, t, tail);
+    }
+
+    //  Sine and cosine for |r| <= pi/4
+    inline __float128 sinKernel(__float128 r) {
+        if (fabsq(r) <= SmallLimit) {
+            return sinSmall(r);
+        }
+        const __float128 t = r * r;
+        return r + (r * t) * poly(sinCoeff, 11, t);
+    }
+
+    inline __float128 cosKernel(__float128 r) {
+        if (fabsq(r) <= SmallLimit) {
+            return cosSmall(r);
+        }
+        const __float128 t = r * r;
+        return (1 - t / 2) + (t * t) * poly(cosCoeff, 11, t);
+    }
+
+    /*  Reduce x, with |x| < ReduceLimit, to r in [-pi/4, pi/4],
+        returning the quadrant, x = r + quadrant * pi/2, modulo 4.  */
+    inline int reduce(__float128 x, __float128 &r) {
+        const __float128 q = x * TwoOverPi;
+        const long k = (long) (q + ((q >= 0) ? 0.5Q : -0.5Q));
+        const __float128 kq = k;
+        r = ((x - kq * PiOver2_1) - kq * PiOver2_2) - kq * PiOver2_3;
+        return (int) (k & 3);
+    }
+
+    inline void sincos(__float128 x, __float128 &s, __float128 &c) {
+        const __float128 ax = fabsq(x);
+        if (ax <= SmallLimit) {
+            sincosSmall(x, s, c);
+            return;
+        }
+        if (ax <= PiOver4) {
+            s = sinKernel(x);
+            c = cosKernel(x);
+            return;
+        }
+        if (!(ax < ReduceLimit)) {
+            s = sinq(x);
+            c = cosq(x);
+            return;
+        }
+        __float128 r;
+        switch (reduce(x, r)) {
+            case 0:
+                s = sinKernel(r);
+                c = cosKernel(r);
+                break;
+            case 1:
+                s = cosKernel(r);
+                c = -sinKernel(r);
+                break;
+            case 2:
+                s = -sinKernel(r);
+                c = -cosKernel(r);
+                break;
+            default:
+                s = -cosKernel(r);
+                c = sinKernel(r);
+                break;
+        }
+    }
+
+    inline __float128 sin(__float128 x) {
+        const __float128 ax = fabsq(x);
+        if (ax <= PiOver4) {
+            return sinKernel(x);
+        }
+        if (!(ax < ReduceLimit)) {
+            return sinq(x);
+        }
+        __float128 r;
+        switch (reduce(x, r)) {
+            case 0:
+                return sinKernel(r);
+            case 1:
+                return cosKernel(r);
+            case 2:
+                return -sinKernel(r);
+            default:
+                return -cosKernel(r);
+        }
+    }
+
+    inline __float128 cos(__float128 x) {
+        const __float128 ax = fabsq(x);
+        if (ax <= PiOver4) {
+            return cosKernel(x);
+        }
+        if (!(ax < ReduceLimit)) {
+            return cosq(x);
+        }
+        __float128 r;
+        switch (reduce(x, r)) {
+            case 0:
+                return cosKernel(r);
+            case 1:
+                return -sinKernel(r);
+            case 2:
+                return -cosKernel(r);
+            default:
+                return sinKernel(r);
+        }
+    }
+
+    inline __float128 tan(__float128 x) {
+        if (fabsq(x) <= SmallLimit && x != 0) {
+            return 1 / cotSmall(x);
+        }
+        __float128 s, c;
+        sincos(x, s, c);
+        return s / c;
+    }
+
+    inline __float128 cot(__float128 x) {
+        if (fabsq(x) <= SmallLimit && x != 0) {
+            return cotSmall(x);
+        }
+        __float128 s, c;
+        sincos(x, s, c);
+        return c / s;
+    }
+
+    inline __float128 asin(__float128 x) {
+        if (!(fabsq(x) <= 0.75Q)) {
+            return asinq(x);
+        }
+        const long double y0 = std::asin((long double) x);
+        const __float128 y = y0;
+        const long double step = ((long double) (sin(y) - x)) / std::cos(y0);
+        return y - step;
+    }
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*  Editing of software floating point types to strings
+
+    The Real types implemented in this directory (ddreal, qdreal,
+    and mpnreal) cannot be passed to printf, so they provide a
+    toString method which accepts the same "%w.pf" style of
+    format code as MPFR C++'s mpreal::toString.  This allows
+    DesignEvaluation::report() to use the same code for all of
+    them.  The editing is done here, generically, using only the
+    arithmetic of the type being edited, so the decimal places
+    shown are exact to the precision of the type rather than that
+    of a conversion to double.  */
+
+#ifndef REALEDIT_H
+#define REALEDIT_H
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace realedit {
+
+    /*  Edit a number with the given width and number of decimal
+        places, as printf's "%w.pf" would.  The type T must
+        support arithmetic and comparison with doubles and provide
+        a toDouble() method which returns a double within a unit or
+        so in the last place of the value.  The integer part of the
+        number must be exactly representable as a double.  */
+    template <class T> std::string edit(const T &x, int width, int places) {
+        const bool negative = x < 0.0;
+        const T v = negative ? -x : x;
+        double scale = 1.0;
+
+        if (places > 15) {
+            places = 15;
+        }
+        for (int i = 0; i < places; i++) {
+            scale *= 10.0;
+        }
+
+        //  Split into integer and fractional parts
+        double ipart = std::floor(v.toDouble());
+        T frac = v - ipart;
+        if (frac < 0.0) {
+            ipart -= 1.0;
+            frac += 1.0;
+        }
+
+        //  Round the fraction to the requested number of places
+        frac *= scale;
+        double fpart = std::floor(frac.toDouble());
+        T rem = frac - fpart;
+        if (rem < 0.0) {
+            fpart -= 1.0;
+            rem += 1.0;
+        }
+        if (rem >= 0.5) {
+            fpart += 1.0;
+        }
+        if (fpart >= scale) {
+            fpart -= scale;
+            ipart += 1.0;
+        }
+
+        char b[80], r[128];
+        if (places > 0) {
+            snprintf(b, sizeof b, "%s%.0f.%0*.0f", negative ? "-" : "",
+                ipart, places, fpart);
+        } else {
+            snprintf(b, sizeof b, "%s%.0f", negative ? "-" : "", ipart);
+        }
+        snprintf(r, sizeof r, "%*s", width, b);
+        return std::string(r);
+    }
+
+    /*  Parse the width and number of decimal places from a
+        printf-like format such as "%21.11f".  Any characters
+        following the precision (for example, the "R" of MPFR
+        formats) are ignored.  */
+    inline void parseFormat(const char *format, int &width, int &places) {
+        const char *p = format;
+        char *e;
+
+        width = 0;
+        places = 6;
+        while (*p != 0 && *p != '%') {
+            p++;
+        }
+        if (*p == '%') {
+            width = (int) strtol(p + 1, &e, 10);
+            if (*e == '.') {
+                places = (int) strtol(e + 1, &e, 10);
+            }
+        }
+    }
+}
+
+#endif
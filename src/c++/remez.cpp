@@ -0,0 +1,628 @@
+/*  Minimax polynomial generator for the trigonometric kernels
+
+    This program finds the coefficients of the polynomials with
+    which the kernels in minimax.h evaluate the sine, cosine, arc
+    sine, and arc tangent, and writes them to standard output as
+    the C++ header minimaxcoeff.h.  It is run by the Makefile with
+    a list of specifications, each of the form
+
+        function:type:limit:ulps
+
+    where function is sin, cos, asin, or atan; type is one of
+    float, double, longdouble, dd (ddreal), or float128
+    (__float128); limit is the largest magnitude of argument for
+    which the polynomial is used; and ulps is the largest error
+    of the approximation allowed, in units in the last place of
+    the result.
+
+    All four functions are odd or even, so they are approximated
+    as polynomials in t = x^2:
+
+        sin(x)  = x + x^3 P(t)
+        cos(x)  = 1 - t/2 + t^2 P(t)
+        asin(x) = x + x^3 P(t)
+        atan(x) = x + x^3 P(t)
+
+    For each specification, P is found for one degree after
+    another, starting with a constant, until one is found which,
+    with its coefficients rounded to the precision of the type,
+    approximates the function to within the requested error.
+    This is the cheapest polynomial that meets the target: no
+    polynomial of lower degree can do so, since it cannot do
+    better than the minimax polynomial of that degree.  P is the
+    polynomial which minimises the largest relative error in the
+    higher order part of the function (the part P represents);
+    since that part is small compared to the leading term, this
+    is very nearly the polynomial which minimises the relative
+    error of the function itself.  The error checked against the
+    target is that of the function, computed from the rounded
+    coefficients on a fine grid of arguments.
+
+    The minimax polynomial is found by the Remez exchange
+    algorithm, with all arithmetic done in quad-double (212 bit)
+    precision using qdreal.h, which is ample for every type up to
+    __float128.  The error counted is that of the approximation
+    alone: rounding in the evaluation of the polynomial adds a
+    further half unit in the last place or so to the result.
+    "ulp" here means the unit in the last place of a number at
+    the top of its binade, 2^-bits relative, so the error bound
+    holds for every result.  The long double format is taken to
+    be the 64 bit mantissa x87 extended precision of the x86.  */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "qdreal.h"
+
+    using namespace std;
+    using namespace ddqd;
+
+    //  Floating point types for which coefficients may be generated
+    struct Format {
+        const char *name;       // Name in specifications
+        const char *type;       // C++ type
+        const char *tag;        // Suffix of coefficient array names
+        const char *guard;      // Macro defined when the type is available
+        int bits;               // Bits of mantissa
+        int digits;             // Decimal digits to write
+        const char *suffix;     // Suffix of literals
+        bool pair;              // Written as the sum of two doubles
+        const char *tail;       // Format for terms needing less precision
+    };
+
+    const Format formats[] = {
+        { "float",      "float",        "Float",      NULL,          24,  9, "F", false, NULL },
+        { "double",     "double",       "Double",     NULL,          53, 17, "",  false, NULL },
+        { "longdouble", "long double",  "LongDouble", NULL,          64, 21, "L", false, NULL },
+        { "dd",         "ddqd::ddreal", "DD",         "DDREAL_H",   106, 17, "",  true,  "double" },
+        { "float128",   "__float128",   "Float128",   "QUADMATH_H", 113, 36, "Q", false, "longdouble" }
+    };
+    const int nFormats = sizeof formats / sizeof formats[0];
+
+    static const Format *findFormat(const char *name) {
+        for (int i = 0; i < nFormats; i++) {
+            if (strcmp(name, formats[i].name) == 0) {
+                return &formats[i];
+            }
+        }
+        return NULL;
+    }
+
+    //  Functions which may be approximated
+    static qdreal qdSin(const qdreal &x) { return ddqd::sin(x); }
+    static qdreal qdCos(const qdreal &x) { return ddqd::cos(x); }
+    static qdreal qdAsin(const qdreal &x) { return ddqd::asin(x); }
+    static qdreal qdAtan(const qdreal &x) {
+        return ddqd::asin(x / ddqd::sqrt(1.0 + x * x));
+    }
+
+    struct Function {
+        const char *name;       // Name in specifications
+        const char *member;     // Member of minimax::Coefficients<T>
+        bool even;              // Even (cosine) or odd function
+        qdreal (*f)(const qdreal &x);
+        int p0n, p0d;           // P(0) as a fraction
+        const char *form;       // Form of the approximation
+    };
+
+    const Function functions[] = {
+        { "sin",  "Sin",  false, qdSin,  -1,  6, "sin(x) = x + x^3 P(x^2)" },
+        { "cos",  "Cos",  true,  qdCos,   1, 24, "cos(x) = 1 - x^2/2 + x^4 P(x^2)" },
+        { "asin", "Asin", false, qdAsin,  1,  6, "asin(x) = x + x^3 P(x^2)" },
+        { "atan", "Atan", false, qdAtan, -1,  3, "atan(x) = x + x^3 P(x^2)" }
+    };
+    const int nFunctions = sizeof functions / sizeof functions[0];
+
+    const int MaxTerms = 40;            // Give up beyond this many terms
+    const int Grid = 500;               // Points searched for extrema
+    const int CheckGrid = 4000;         // Points at which accuracy is checked
+    const int MaxIterations = 40;       // Exchange iterations per degree
+
+    //  A polynomial requested and the one found
+    struct Specification {
+        const Function *function;
+        const Format *format;
+        double limit, ulps;
+        vector<qdreal> c;               // Coefficients found, in x^2
+        int head;                       // How many are evaluated in the type
+        double error;                   // Relative error
+    };
+
+    static qdreal horner(const vector<qdreal> &c, const qdreal &t) {
+        qdreal s = 0.0;
+        for (int i = (int) c.size() - 1; i >= 0; i--) {
+            s = s * t + c[i];
+        }
+        return s;
+    }
+
+    /*  The approximation problem for one function and interval.
+        The polynomial is found as Q(u) with u = t / limit^2 in
+        [0, 1], which keeps the linear systems well conditioned,
+        and converted to P(t) when done.  */
+    class Problem {
+        const Function &fn;
+        qdreal limit2;                  // limit^2
+        vector<qdreal> grid, gGrid;     // Search grid and P(t) upon it
+
+    public:
+        Problem(const Function &f, double limit) : fn(f), limit2(qdreal(limit) * limit) {
+            for (int i = 0; i <= Grid; i++) {
+                grid.push_back(qdreal((double) i) / Grid);
+                gGrid.push_back(g(grid[i]));
+            }
+        }
+
+        //  The argument x for u
+        qdreal x(const qdreal &u) const {
+            return ddqd::sqrt(u * limit2);
+        }
+
+        //  The part of the function P approximates
+        qdreal g(const qdreal &u) const {
+            if (u == 0.0) {
+                return qdreal((double) fn.p0n) / fn.p0d;
+            }
+            const qdreal a = x(u), t = a * a;
+            if (fn.even) {
+                return (fn.f(a) - (1.0 - t * 0.5)) / sqr(t);
+            }
+            return (fn.f(a) - a) / (a * t);
+        }
+
+        //  Relative error of Q at u, where g is known to be gu
+        static qdreal error(const vector<qdreal> &q, const qdreal &u, const qdreal &gu) {
+            return (horner(q, u) - gu) / gu;
+        }
+
+        vector<qdreal> remez(int n) const;
+        vector<qdreal> inT(const vector<qdreal> &q) const;
+        double check(const vector<qdreal> &c, int head, int tailBits) const;
+    };
+
+    /*  Solve the linear system a x = b by Gaussian elimination
+        with partial pivoting, leaving x in b.  */
+    static void solve(vector<vector<qdreal> > &a, vector<qdreal> &b) {
+        const int n = (int) b.size();
+        for (int c = 0; c < n; c++) {
+            int p = c;
+            for (int r = c + 1; r < n; r++) {
+                if (fabs(a[r][c]) > fabs(a[p][c])) {
+                    p = r;
+                }
+            }
+            swap(a[c], a[p]);
+            swap(b[c], b[p]);
+            for (int r = c + 1; r < n; r++) {
+                const qdreal f = a[r][c] / a[c][c];
+                for (int k = c; k < n; k++) {
+                    a[r][k] -= f * a[c][k];
+                }
+                b[r] -= f * b[c];
+            }
+        }
+        for (int r = n - 1; r >= 0; r--) {
+            qdreal s = b[r];
+            for (int k = r + 1; k < n; k++) {
+                s -= a[r][k] * b[k];
+            }
+            b[r] = s / a[r][r];
+        }
+    }
+
+    //  Minimax Q(u) with n coefficients, by the Remez exchange
+    vector<qdreal> Problem::remez(int n) const {
+        vector<qdreal> ref(n + 1), q;
+
+        //  Start from the extrema of the Chebyshev polynomial
+        for (int i = 0; i <= n; i++) {
+            ref[i] = qdreal((1.0 - std::cos(M_PI * i / n)) / 2);
+        }
+
+        for (int iteration = 0; iteration < MaxIterations; iteration++) {
+
+            /*  Find Q and the levelled error E with
+                Q(u_i) - g(u_i) = (-1)^i E g(u_i) at the reference.  */
+            vector<vector<qdreal> > a(n + 1, vector<qdreal>(n + 1));
+            vector<qdreal> b(n + 1);
+            for (int i = 0; i <= n; i++) {
+                const qdreal gu = g(ref[i]);
+                qdreal p = 1.0;
+                for (int k = 0; k < n; k++) {
+                    a[i][k] = p;
+                    p *= ref[i];
+                }
+                a[i][n] = (i & 1) ? gu : -gu;
+                b[i] = gu;
+            }
+            solve(a, b);
+            q.assign(b.begin(), b.begin() + n);
+            if (n == 1 && iteration > 0) {
+                break;
+            }
+
+            //  Local extrema of the error on the grid
+            vector<qdreal> eGrid(Grid + 1);
+            for (int i = 0; i <= Grid; i++) {
+                eGrid[i] = error(q, grid[i], gGrid[i]);
+            }
+            vector<qdreal> eu, ee;
+            for (int i = 0; i <= Grid; i++) {
+                const qdreal e = fabs(eGrid[i]);
+                if ((i == 0 || e >= fabs(eGrid[i - 1])) &&
+                    (i == Grid || e >= fabs(eGrid[i + 1]))) {
+
+                    /*  Refine by ternary search between the
+                        neighbouring grid points.  */
+                    qdreal lo = grid[(i > 0) ? i - 1 : i],
+                           hi = grid[(i < Grid) ? i + 1 : i];
+                    const double s = (eGrid[i] < 0.0) ? -1.0 : 1.0;
+                    for (int j = 0; j < 30 && i > 0 && i < Grid; j++) {
+                        const qdreal m1 = lo + (hi - lo) / 3.0,
+                                     m2 = hi - (hi - lo) / 3.0;
+                        if (error(q, m1, g(m1)) * s < error(q, m2, g(m2)) * s) {
+                            lo = m1;
+                        } else {
+                            hi = m2;
+                        }
+                    }
+                    const qdreal u = (i > 0 && i < Grid) ? (lo + hi) * 0.5 : grid[i];
+                    const qdreal e = error(q, u, g(u));
+
+                    //  Keep only the largest of a run of one sign
+                    if (!ee.empty() && ((ee.back() < 0.0) == (e < 0.0))) {
+                        if (fabs(e) > fabs(ee.back())) {
+                            eu.back() = u;
+                            ee.back() = e;
+                        }
+                    } else {
+                        eu.push_back(u);
+                        ee.push_back(e);
+                    }
+                }
+            }
+
+            //  Drop the smaller end extremum until n + 1 remain
+            while ((int) eu.size() > n + 1) {
+                if (fabs(ee.front()) < fabs(ee.back())) {
+                    eu.erase(eu.begin());
+                    ee.erase(ee.begin());
+                } else {
+                    eu.pop_back();
+                    ee.pop_back();
+                }
+            }
+            if ((int) eu.size() < n + 1) {
+                break;                  // Converged as far as it can
+            }
+
+            qdreal emax = 0.0, emin = fabs(ee[0]);
+            for (int i = 0; i <= n; i++) {
+                const qdreal e = fabs(ee[i]);
+                if (e > emax) {
+                    emax = e;
+                }
+                if (e < emin) {
+                    emin = e;
+                }
+            }
+            ref = eu;
+            if ((emax - emin) < emax * 1e-4) {
+                break;
+            }
+        }
+        return q;
+    }
+
+    //  Coefficients of P(t) from those of Q(u)
+    vector<qdreal> Problem::inT(const vector<qdreal> &q) const {
+        vector<qdreal> c(q.size());
+        qdreal s = 1.0;
+        for (size_t k = 0; k < q.size(); k++) {
+            c[k] = q[k] / s;
+            s *= limit2;
+        }
+        return c;
+    }
+
+    /*  Largest relative error of the function computed with P(t),
+        where the terms from head on are evaluated with tailBits of
+        precision.  Their rounding error is bounded by that of
+        Horner's rule, 2n units of the tail precision for n terms,
+        plus k units for the term in t^k from the rounding of t.  */
+    double Problem::check(const vector<qdreal> &c, int head, int tailBits) const {
+        const int n = (int) c.size();
+        const double unit = ldexp((double) (2 * (n - head) + n), -tailBits);
+        double worst = 0.0;
+        for (int i = 1; i <= CheckGrid; i++) {
+            const qdreal u = qdreal((double) i) / CheckGrid,
+                         a = x(u), t = a * a, fa = fn.f(a),
+                         scale = fn.even ? sqr(t) : a * t;
+            qdreal tail = 0.0, tk = 1.0;
+            for (int k = 0; k < n; k++) {
+                if (k >= head) {
+                    tail += fabs(c[k]) * tk;
+                }
+                tk *= t;
+            }
+            const qdreal v = fn.even ? (1.0 - t * 0.5) + scale * horner(c, t) :
+                                       a + scale * horner(c, t);
+            const double e = ((fabs(v - fa) + fabs(scale) * tail * unit) / fabs(fa)).toDouble();
+            if (e > worst) {
+                worst = e;
+            }
+        }
+        return worst;
+    }
+
+    //  v rounded to the nearest number with the given bits of mantissa
+    static qdreal roundTo(const qdreal &v, int bits) {
+        if (v == 0.0) {
+            return v;
+        }
+        const int e = ilogb(v.x[0]);
+        qdreal m = v * ldexp(1.0, bits - 1 - e), n = 0.0;
+        for (int i = 0; i < 4; i++) {
+            const double d = nearbyint(m.x[0]);
+            n += d;
+            m -= d;
+        }
+        if (m > 0.5) {
+            n += 1.0;
+        } else if (m < -0.5) {
+            n -= 1.0;
+        }
+        return n * ldexp(1.0, e - bits + 1);
+    }
+
+    //  Decimal representation of v to the given significant digits
+    static string decimal(const qdreal &v, int digits) {
+        if (v == 0.0) {
+            return "0.0";
+        }
+        qdreal m = fabs(v);
+        int e = (int) floor(log10(m.x[0]));
+        for (int i = 0; i < e; i++) {
+            m /= 10.0;
+        }
+        for (int i = 0; i > e; i--) {
+            m *= 10.0;
+        }
+        while (m >= 10.0) {
+            m /= 10.0;
+            e++;
+        }
+        while (m < 1.0) {
+            m *= 10.0;
+            e--;
+        }
+
+        vector<int> d(digits + 1);
+        for (int i = 0; i <= digits; i++) {
+            int k = (int) floor(m.x[0]);
+            if (m - (double) k < 0.0) {
+                k--;
+            }
+            d[i] = k;
+            m = (m - (double) k) * 10.0;
+        }
+        int carry = d[digits] >= 5;
+        for (int i = digits - 1; i >= 0 && carry; i--) {
+            d[i] += carry;
+            carry = d[i] > 9;
+            if (carry) {
+                d[i] = 0;
+            }
+        }
+        if (carry) {
+            d.insert(d.begin(), 1);
+            e++;
+        }
+
+        string s = (v < 0.0) ? "-" : "";
+        s += (char) ('0' + d[0]);
+        s += '.';
+        for (int i = 1; i < digits; i++) {
+            s += (char) ('0' + d[i]);
+        }
+        char ex[16];
+        snprintf(ex, sizeof ex, "e%+03d", e);
+        return s + ex;
+    }
+
+    //  A coefficient as a literal of its type
+    static string literal(const qdreal &c, const Format &f) {
+        if (f.pair) {
+            return string(f.type) + "(" + decimal(qdreal(c.x[0]), 17) + ", " +
+                decimal(qdreal(c.x[1]), 17) + ")";
+        }
+        return decimal(c, f.digits) + f.suffix;
+    }
+
+    //  Coefficients rounded to bits, and to tailBits from head on
+    static vector<qdreal> rounded(const vector<qdreal> &c, int head, int bits, int tailBits) {
+        vector<qdreal> r(c.size());
+        for (size_t k = 0; k < c.size(); k++) {
+            r[k] = roundTo(c[k], ((int) k < head) ? bits : tailBits);
+        }
+        return r;
+    }
+
+    /*  Find the cheapest polynomial meeting a specification,
+        returning false if none of up to MaxTerms terms does.  The
+        degree is chosen first, then, if the type has a tail format,
+        as many of the high order terms as possible, while still
+        meeting the target, are moved to the tail, which is much
+        faster than the software arithmetic of the types that
+        have one.  */
+    static bool generate(Specification &s) {
+        const Problem p(*s.function, s.limit);
+        const Format &f = *s.format;
+        const double target = s.ulps * ldexp(1.0, -f.bits);
+        for (int n = 1; n <= MaxTerms; n++) {
+            const vector<qdreal> c = p.inT(p.remez(n));
+            const vector<qdreal> r = rounded(c, n, f.bits, f.bits);
+            const double e = p.check(r, n, f.bits);
+            if (e <= target) {
+                s.c = r;
+                s.head = n;
+                s.error = e;
+                if (f.tail != NULL) {
+                    const int tailBits = findFormat(f.tail)->bits;
+                    for (int head = 1; head < n; head++) {
+                        const vector<qdreal> rt = rounded(c, head, f.bits, tailBits);
+                        const double et = p.check(rt, head, tailBits);
+                        if (et <= target) {
+                            s.c = rt;
+                            s.head = head;
+                            s.error = et;
+                            break;
+                        }
+                    }
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //  Coefficients first to last of a specification, as a C++ array
+    static void writeArray(const Specification &s, const Format &f, const char *suffix,
+                           int first, int last) {
+        printf("    const %s %s%s%s[%d] = {\n", f.type, s.function->name, s.format->tag,
+            suffix, last - first);
+        for (int k = first; k < last; k++) {
+            printf("        %s%s\n", literal(s.c[k], f).c_str(), (k + 1 < last) ? "," : "");
+        }
+        printf("    };\n");
+    }
+
+    static void writeHeader(const vector<Specification> &specs) {
+        printf("/*  Minimax polynomial coefficients for minimax.h\n\n");
+        printf("    Generated by remez.cpp from the specifications:\n\n");
+        for (size_t i = 0; i < specs.size(); i++) {
+            printf("        %s:%s:%g:%g\n", specs[i].function->name,
+                specs[i].format->name, specs[i].limit, specs[i].ulps);
+        }
+        printf("\n");
+        printf("    Do not edit: change MINIMAX in the Makefile and make\n");
+        printf("    minimaxcoeff.h instead.  */\n\n");
+        printf("#ifndef MINIMAXCOEFF_H\n#define MINIMAXCOEFF_H\n\n");
+        printf("namespace minimax {\n");
+
+        for (int i = 0; i < nFormats; i++) {
+            const Format &f = formats[i];
+            bool used = false;
+            for (size_t j = 0; j < specs.size(); j++) {
+                used |= specs[j].format == &f;
+            }
+            if (!used) {
+                continue;
+            }
+
+            const Format *tail = (f.tail != NULL) ? findFormat(f.tail) : &f;
+            printf("\n    //  %s\n", f.type);
+            if (f.guard != NULL) {
+                printf("\n#ifdef %s\n", f.guard);
+            }
+            for (size_t j = 0; j < specs.size(); j++) {
+                const Specification &s = specs[j];
+                if (s.format != &f) {
+                    continue;
+                }
+                printf("\n    /*  %s, |x| <= %g\n", s.function->form, s.limit);
+                if (s.head < (int) s.c.size()) {
+                    printf("        %d terms, the last %d in %s\n", (int) s.c.size(),
+                        (int) s.c.size() - s.head, tail->type);
+                } else {
+                    printf("        %d terms\n", (int) s.c.size());
+                }
+                printf("        Relative error %.2e (%.3f ulp)  */\n", s.error,
+                    ldexp(s.error, f.bits));
+                writeArray(s, f, "", 0, s.head);
+                if (s.head < (int) s.c.size()) {
+                    writeArray(s, *tail, "Tail", s.head, (int) s.c.size());
+                }
+            }
+            printf("\n    template <> struct Coefficients<%s> {\n", f.type);
+            printf("        typedef %s Tail;\n", tail->type);
+            for (size_t j = 0; j < specs.size(); j++) {
+                const Specification &s = specs[j];
+                if (s.format != &f) {
+                    continue;
+                }
+                const int nt = (int) s.c.size() - s.head;
+                printf("        static constexpr Polynomial<%s, Tail> %s =\n",
+                    f.type, s.function->member);
+                printf("            { %s%s, %d, ", s.function->name, f.tag, s.head);
+                if (nt > 0) {
+                    printf("%s%sTail, %d, ", s.function->name, f.tag, nt);
+                } else {
+                    printf("NULL, 0, ");
+                }
+                printf("%g };\n", s.limit);
+            }
+            printf("    };\n");
+            if (f.guard != NULL) {
+                printf("#endif\n");
+            }
+        }
+        printf("}\n\n#endif\n");
+    }
+
+    static void usage(void) {
+        fprintf(stderr, "Usage: remez function:type:limit:ulps...\n");
+        fprintf(stderr, "    function  sin, cos, asin, or atan\n");
+        fprintf(stderr, "    type      float, double, longdouble, dd, or float128\n");
+        fprintf(stderr, "    limit     Largest argument magnitude\n");
+        fprintf(stderr, "    ulps      Largest error of approximation, units in last place\n");
+    }
+
+    int main(int argc, char *argv[]) {
+        vector<Specification> specs;
+
+        for (int i = 1; i < argc; i++) {
+            char fname[16], tname[16];
+            Specification s;
+            s.function = NULL;
+            s.format = NULL;
+            if (sscanf(argv[i], "%15[a-z]:%15[a-z0-9]:%lf:%lf", fname, tname,
+                    &s.limit, &s.ulps) == 4) {
+                for (int j = 0; j < nFunctions; j++) {
+                    if (strcmp(fname, functions[j].name) == 0) {
+                        s.function = &functions[j];
+                    }
+                }
+                s.format = findFormat(tname);
+            }
+            if (s.function == NULL || s.format == NULL ||
+                !(s.limit > 0 && s.limit <= 1) || !(s.ulps > 0)) {
+                fprintf(stderr, "remez: invalid specification %s\n", argv[i]);
+                usage();
+                return 2;
+            }
+            specs.push_back(s);
+        }
+        if (specs.empty()) {
+            usage();
+            return 2;
+        }
+
+        for (size_t i = 0; i < specs.size(); i++) {
+            Specification &s = specs[i];
+            if (!generate(s)) {
+                fprintf(stderr, "remez: %s:%s:%g:%g needs more than %d terms\n",
+                    s.function->name, s.format->name, s.limit, s.ulps, MaxTerms);
+                return 1;
+            }
+            fprintf(stderr, "remez: %s %s |x| <= %g: %d terms (%d in tail), %.3f ulp\n",
+                s.function->name, s.format->name, s.limit, (int) s.c.size(),
+                (int) s.c.size() - s.head, ldexp(s.error, s.format->bits));
+        }
+        writeHeader(specs);
+        return 0;
+    }
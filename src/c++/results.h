@@ -0,0 +1,313 @@
+/*  Machine-readable results with provenance
+
+    A timing is worth keeping only if we know what produced it.  A
+    Record is an ordered list of named fields: the results of a run,
+    which the program adds, and by provenance() a description of the
+    build and machine which produced them: the time, host, kernel,
+    processor model and microcode revision, frequency governor,
+    processors the run may use, compiler and its version, the
+    options it was given, which the Makefile passes as
+    COMPILE_FLAGS, the instruction set extensions it could use,
+    and the version of the C library, which supplies the
+    mathematical functions at run time.  Fields which aren't
+    known are null.
+
+    appendJSON() appends a record to a file as one line of JSON
+    (JSON Lines), and appendCSV() as a row of comma separated
+    values, preceded by a line of field names if the file is empty,
+    so repeated runs accumulate in one file.  A file name of "-"
+    writes to standard output, with the line of names.  A program
+    should add the same fields in the same order to every record
+    it writes, so the rows of a CSV file share its header.  */
+
+#ifndef RESULTS_H
+#define RESULTS_H
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+#endif
+#ifdef __GLIBC__
+#include <gnu/libc-version.h>
+#endif
+
+namespace results {
+
+    class Record {
+    public:
+        enum Kind { Null, Number, String, Boolean };
+
+        struct Field {
+            std::string name, value;
+            Kind kind;
+        };
+
+    private:
+        std::vector<Field> fields;
+
+        void add(const char *name, const std::string &value, Kind kind) {
+            Field f;
+            f.name = name;
+            f.value = value;
+            f.kind = kind;
+            fields.push_back(f);
+        }
+
+    public:
+        void addNull(const char *name) { add(name, "", Null); }
+        void addString(const char *name, const std::string &v) { add(name, v, String); }
+        void addBoolean(const char *name, bool v) { add(name, v ? "true" : "false", Boolean); }
+        void addInteger(const char *name, long v) { add(name, std::to_string(v), Number); }
+
+        //  A number, or null if it isn't finite
+        void addNumber(const char *name, double v, const char *format = "%.6g") {
+            if (!std::isfinite(v)) {
+                addNull(name);
+                return;
+            }
+            char s[40];
+            snprintf(s, sizeof s, format, v);
+            add(name, s, Number);
+        }
+
+        const std::vector<Field> &get(void) const { return fields; }
+    };
+
+#ifdef __linux__
+    //  First line of a file, or "" if it can't be read
+    inline std::string firstLine(const char *fileName) {
+        char s[256] = "";
+        FILE *f = fopen(fileName, "r");
+        if (f != NULL) {
+            if (fgets(s, sizeof s, f) == NULL) {
+                s[0] = 0;
+            }
+            fclose(f);
+        }
+        s[strcspn(s, "\n")] = 0;
+        return s;
+    }
+
+    //  Value of the first line of /proc/cpuinfo with the given key
+    inline std::string cpuinfo(const char *key) {
+        char s[512];
+        std::string v;
+        FILE *f = fopen("/proc/cpuinfo", "r");
+        if (f == NULL) {
+            return v;
+        }
+        const size_t n = strlen(key);
+        while (fgets(s, sizeof s, f) != NULL) {
+            if (strncmp(s, key, n) == 0 && strchr(" \t:", s[n]) != NULL) {
+                const char *p = strchr(s, ':');
+                if (p != NULL) {
+                    p += strspn(p + 1, " \t") + 1;
+                    v.assign(p, strcspn(p, "\n"));
+                    break;
+                }
+            }
+        }
+        fclose(f);
+        return v;
+    }
+
+    //  Processors the process may run on, as a list of ranges
+    inline std::string affinity(void) {
+        cpu_set_t set;
+        std::string v;
+        if (sched_getaffinity(0, sizeof set, &set) != 0) {
+            return v;
+        }
+        for (int i = 0; i < CPU_SETSIZE; i++) {
+            if (!CPU_ISSET(i, &set)) {
+                continue;
+            }
+            int j = i;
+            while (j + 1 < CPU_SETSIZE && CPU_ISSET(j + 1, &set)) {
+                j++;
+            }
+            v += (v.empty() ? "" : ",") + std::to_string(i);
+            if (j > i) {
+                v += "-" + std::to_string(j);
+            }
+            i = j;
+        }
+        return v;
+    }
+#endif
+
+    //  Add a string field, or null if it's empty
+    inline void addKnown(Record &r, const char *name, const std::string &v) {
+        if (v.empty()) {
+            r.addNull(name);
+        } else {
+            r.addString(name, v);
+        }
+    }
+
+    //  Add the fields describing the build and the machine
+    inline void provenance(Record &r) {
+        char s[64];
+        const time_t now = time(NULL);
+        struct tm t;
+        strftime(s, sizeof s, "%Y-%m-%dT%H:%M:%SZ", gmtime_r(&now, &t));
+        r.addString("timestamp", s);
+
+#ifdef __linux__
+        struct utsname u;
+        const bool named = uname(&u) == 0;
+        addKnown(r, "host", named ? u.nodename : "");
+        addKnown(r, "kernel", named ? std::string(u.sysname) + " " + u.release : "");
+        addKnown(r, "machine", named ? u.machine : "");
+        std::string model = cpuinfo("model name");
+        if (model.empty()) {
+            model = cpuinfo("Model");           // ARM and others
+        }
+        addKnown(r, "cpu_model", model);
+        addKnown(r, "microcode", cpuinfo("microcode"));
+        const int cpu = sched_getcpu();
+        snprintf(s, sizeof s, "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor",
+            (cpu >= 0) ? cpu : 0);
+        addKnown(r, "governor", firstLine(s));
+        addKnown(r, "affinity", affinity());
+#else
+        const char *unknown[] = {
+            "host", "kernel", "machine", "cpu_model", "microcode", "governor", "affinity"
+        };
+        for (unsigned int i = 0; i < sizeof unknown / sizeof unknown[0]; i++) {
+            r.addNull(unknown[i]);
+        }
+#endif
+
+#if defined(__clang__)
+        r.addString("compiler", "clang " __clang_version__);
+#elif defined(__GNUC__)
+        r.addString("compiler", "gcc " __VERSION__);
+#else
+        r.addNull("compiler");
+#endif
+#ifdef COMPILE_FLAGS
+        r.addString("flags", COMPILE_FLAGS);
+#else
+        r.addNull("flags");
+#endif
+
+        //  Instruction sets and options the compiler was allowed
+        std::string features;
+#ifdef __SSE2__
+        features += " sse2";
+#endif
+#ifdef __AVX__
+        features += " avx";
+#endif
+#ifdef __AVX2__
+        features += " avx2";
+#endif
+#ifdef __FMA__
+        features += " fma";
+#endif
+#ifdef __AVX512F__
+        features += " avx512f";
+#endif
+#ifdef __ARM_NEON
+        features += " neon";
+#endif
+#ifdef __FAST_MATH__
+        features += " fast-math";
+#endif
+        addKnown(r, "features", features.empty() ? features : features.substr(1));
+#ifdef __GLIBC__
+        r.addString("libc", std::string("glibc ") + gnu_get_libc_version());
+#else
+        r.addNull("libc");
+#endif
+    }
+
+    inline FILE *openAppend(const char *fileName) {
+        return (strcmp(fileName, "-") == 0) ? stdout : fopen(fileName, "a");
+    }
+
+    inline bool close(FILE *f) {
+        return (f == stdout) ? fflush(f) == 0 : fclose(f) == 0;
+    }
+
+    inline std::string quoteJSON(const std::string &s) {
+        std::string q = "\"";
+        for (size_t i = 0; i < s.size(); i++) {
+            const unsigned char c = s[i];
+            if (c == '"' || c == '\\') {
+                q += '\\';
+                q += c;
+            } else if (c < ' ') {
+                char e[8];
+                snprintf(e, sizeof e, "\\u%04x", c);
+                q += e;
+            } else {
+                q += c;
+            }
+        }
+        return q + "\"";
+    }
+
+    inline std::string quoteCSV(const std::string &s) {
+        if (s.find_first_of(",\"\n\r") == std::string::npos) {
+            return s;
+        }
+        std::string q = "\"";
+        for (size_t i = 0; i < s.size(); i++) {
+            q += (s[i] == '"') ? "\"\"" : std::string(1, s[i]);
+        }
+        return q + "\"";
+    }
+
+    //  Append a record to a file as a line of JSON
+    inline bool appendJSON(const char *fileName, const Record &r) {
+        FILE *f = openAppend(fileName);
+        if (f == NULL) {
+            return false;
+        }
+        const std::vector<Record::Field> &fields = r.get();
+        std::string line = "{";
+        for (size_t i = 0; i < fields.size(); i++) {
+            const Record::Field &fl = fields[i];
+            line += (i > 0 ? ", " : "") + quoteJSON(fl.name) + ": " +
+                    ((fl.kind == Record::Null) ? "null" :
+                     (fl.kind == Record::String) ? quoteJSON(fl.value) : fl.value);
+        }
+        line += "}\n";
+        const bool written = fputs(line.c_str(), f) >= 0;
+        return close(f) && written;
+    }
+
+    //  Append a record to a file as a row of comma separated values
+    inline bool appendCSV(const char *fileName, const Record &r) {
+        FILE *f = openAppend(fileName);
+        if (f == NULL) {
+            return false;
+        }
+        const std::vector<Record::Field> &fields = r.get();
+        std::string line;
+        if (f == stdout || (fseek(f, 0, SEEK_END) == 0 && ftell(f) == 0)) {
+            for (size_t i = 0; i < fields.size(); i++) {
+                line += (i > 0 ? "," : "") + quoteCSV(fields[i].name);
+            }
+            line += "\n";
+        }
+        for (size_t i = 0; i < fields.size(); i++) {
+            line += (i > 0 ? "," : "") + quoteCSV(fields[i].value);
+        }
+        line += "\n";
+        const bool written = fputs(line.c_str(), f) >= 0;
+        return close(f) && written;
+    }
+}
+
+#endif
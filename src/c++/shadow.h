@@ -0,0 +1,375 @@
+/*  Shadow precision error tracking
+
+    validate() and -accuracy tell us how far the results of an
+    evaluation are from the truth, but not where along the way
+    the digits were lost.  A Shadowed<S> holds a double, which is
+    computed exactly as the double build computes it, and a
+    shadow of the higher precision type S, computed by the same
+    operations on the same inputs.  After every operation the
+    double's error relative to the shadow is measured in units in
+    the last place (ulps) of a double, and tallied by the ray and
+    surface being traced, which the tracer sets with a RayScope
+    and a SurfaceScope, and by the operation.  An addition or
+    subtraction also records how many bits cancelled, the number
+    by which it multiplies the relative error of its operands.
+    A SurfaceScope measures the error of the ray's object distance
+    and slope angle as it leaves the surface, which gives the
+    growth of the error from surface to surface.
+
+    Comparisons and branches follow the double, as they do in the
+    double build, so the shadow measures the error of the double
+    computation, not the result the program would have had in
+    higher precision; comparisons which the shadow would have
+    decided differently are counted.  S must provide arithmetic,
+    comparison, fabs, sqrt, sin, asin, cos, tan, and cot, and a
+    toDouble() method, as qdreal does.  The tallies are kept in a
+    single set of globals and must be updated by only one thread.  */
+
+#ifndef SHADOW_H
+#define SHADOW_H
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <ostream>
+
+namespace shadow {
+
+    enum Operation {
+        Add, Multiply, Divide, Sqrt, Sin, Asin, Cos, Tan, Cot,
+        nOperations
+    };
+
+    static const char *const names[nOperations] = {
+        "Add", "Mul", "Div", "sqrt", "sin", "asin", "cos", "tan", "cot"
+    };
+
+    /*  Rays and surfaces tallied.  Ray MaxRays holds operations
+        outside any RayScope, and surface 0 those of a ray before
+        its first surface.  Larger numbers are tallied with the
+        last.  */
+    const int MaxRays = 8, MaxSurfaces = 16;
+
+    struct Stats {
+        unsigned long n;
+        double maxUlp, sumUlp;          // Error of results
+        double maxLost;                 // Bits cancelled by Add
+    };
+
+    //  Error of the ray's state leaving a surface
+    struct Exit {
+        unsigned long n;
+        double od, sa;                  // Largest, in ulps
+    };
+
+    struct Tally {
+        Stats ops[MaxRays + 1][MaxSurfaces + 1][nOperations];
+        Exit exits[MaxRays + 1][MaxSurfaces + 1];
+        unsigned long divergences;      // Comparisons decided differently
+        int ray, surface;               // Current site
+
+        Tally() : ray(MaxRays), surface(0) {
+            clear();
+        }
+
+        void clear(void) {
+            for (int i = 0; i <= MaxRays; i++) {
+                for (int j = 0; j <= MaxSurfaces; j++) {
+                    for (int k = 0; k < nOperations; k++) {
+                        ops[i][j][k] = Stats();
+                    }
+                    exits[i][j] = Exit();
+                }
+            }
+            divergences = 0;
+        }
+    };
+
+    inline Tally &tally(void) {
+        static Tally t;
+        return t;
+    }
+
+    inline void reset(void) {
+        tally().clear();
+    }
+
+    inline void record(Operation op, double ulps, double lost) {
+        Tally &t = tally();
+        Stats &s = t.ops[t.ray][t.surface][op];
+        s.n++;
+        s.sumUlp += ulps;
+        s.maxUlp = (ulps > s.maxUlp) ? ulps : s.maxUlp;
+        s.maxLost = (lost > s.maxLost) ? lost : s.maxLost;
+    }
+
+    //  Tally operations to ray i for the rest of the enclosing block
+    class RayScope {
+    private:
+        const int savedRay, savedSurface;
+
+        RayScope(const RayScope &);
+        RayScope &operator=(const RayScope &);
+
+    public:
+        explicit RayScope(int i) : savedRay(tally().ray), savedSurface(tally().surface) {
+            tally().ray = (i >= 0 && i < MaxRays) ? i : MaxRays;
+            tally().surface = 0;
+        }
+
+        ~RayScope() {
+            tally().ray = savedRay;
+            tally().surface = savedSurface;
+        }
+    };
+
+    /*  Tally operations to surface n for the rest of the enclosing
+        block, and then the error of the object distance and slope
+        angle, whose values are referenced.  */
+    template <class R> class SurfaceScope {
+    private:
+        const int saved;
+        const R &od, &sa;
+
+        SurfaceScope(const SurfaceScope &);
+        SurfaceScope &operator=(const SurfaceScope &);
+
+    public:
+        SurfaceScope(int n, const R &objectDistance, const R &slopeAngle) :
+            saved(tally().surface), od(objectDistance), sa(slopeAngle) {
+            tally().surface = (n < MaxSurfaces) ? n : MaxSurfaces;
+        }
+
+        ~SurfaceScope() {
+            Tally &t = tally();
+            Exit &e = t.exits[t.ray][t.surface];
+            const double eod = od.error(), esa = sa.error();
+            e.n++;
+            e.od = (eod > e.od) ? eod : e.od;
+            e.sa = (esa > e.sa) ? esa : e.sa;
+            t.surface = saved;
+        }
+    };
+
+    template <class S> class Shadowed {
+    private:
+        double v;
+        S s;
+
+        //  Error of v from s in ulps of a double
+        static double ulps(double v, const S &s) {
+            const double d = s.toDouble();
+            if (d == 0) {
+                return (v == 0) ? 0 : HUGE_VAL;
+            }
+            return fabs(S(v) - s).toDouble() / std::ldexp(1.0, std::ilogb(d) - 52);
+        }
+
+        /*  Bits cancelled in the sum r of a and b.  An exact zero
+            has no relative error to amplify, and counts as none.  */
+        static double cancelled(const S &a, const S &b, const S &r) {
+            const double m = std::fmax(std::fabs(a.toDouble()), std::fabs(b.toDouble())),
+                         rd = std::fabs(r.toDouble());
+            return (rd == 0) ? 0 : std::fmax(0.0, std::log2(m / rd));
+        }
+
+        static Shadowed result(Operation op, double v, const S &s, double lost = 0) {
+            Shadowed r;
+            r.v = v;
+            r.s = s;
+            record(op, ulps(v, s), lost);
+            return r;
+        }
+
+    public:
+        Shadowed() : v(0), s(0.0) { }
+        Shadowed(double x) : v(x), s(x) { }
+
+        double toDouble(void) const { return v; }
+        const S &shadow(void) const { return s; }
+
+        //  Error of the value in ulps
+        double error(void) const { return ulps(v, s); }
+
+        /*  Edit the double with a printf format, in which the "R"
+            length modifier of MPFR's formats is dropped.  */
+        std::string toString(const char *format) const {
+            std::string f;
+            for (const char *p = format; *p != 0; p++) {
+                if (*p != 'R') {
+                    f += *p;
+                }
+            }
+            char str[80];
+            snprintf(str, sizeof str, f.c_str(), v);
+            return str;
+        }
+
+        Shadowed operator-() const {
+            Shadowed r;
+            r.v = -v;
+            r.s = -s;
+            return r;
+        }
+
+        friend Shadowed operator+(const Shadowed &a, const Shadowed &b) {
+            const S r = a.s + b.s;
+            return result(Add, a.v + b.v, r, cancelled(a.s, b.s, r));
+        }
+        friend Shadowed operator-(const Shadowed &a, const Shadowed &b) {
+            const S r = a.s - b.s;
+            return result(Add, a.v - b.v, r, cancelled(a.s, b.s, r));
+        }
+        friend Shadowed operator*(const Shadowed &a, const Shadowed &b) {
+            return result(Multiply, a.v * b.v, a.s * b.s);
+        }
+        friend Shadowed operator/(const Shadowed &a, const Shadowed &b) {
+            return result(Divide, a.v / b.v, a.s / b.s);
+        }
+
+        Shadowed &operator+=(const Shadowed &b) { return *this = *this + b; }
+        Shadowed &operator-=(const Shadowed &b) { return *this = *this - b; }
+        Shadowed &operator*=(const Shadowed &b) { return *this = *this * b; }
+        Shadowed &operator/=(const Shadowed &b) { return *this = *this / b; }
+
+        //  Comparisons follow the double, counting those the shadow decides otherwise
+#define SHADOW_COMPARE(op) \
+        friend bool operator op(const Shadowed &a, const Shadowed &b) { \
+            const bool r = a.v op b.v; \
+            if (r != (a.s op b.s)) { \
+                tally().divergences++; \
+            } \
+            return r; \
+        }
+        SHADOW_COMPARE(==)
+        SHADOW_COMPARE(!=)
+        SHADOW_COMPARE(<)
+        SHADOW_COMPARE(<=)
+        SHADOW_COMPARE(>)
+        SHADOW_COMPARE(>=)
+#undef SHADOW_COMPARE
+
+#define SHADOW_FUNCTION(f, op, e) \
+        friend Shadowed f(const Shadowed &x) { return result(op, e, f(x.s)); }
+        SHADOW_FUNCTION(sqrt, Sqrt, std::sqrt(x.v))
+        SHADOW_FUNCTION(sin, Sin, std::sin(x.v))
+        SHADOW_FUNCTION(asin, Asin, std::asin(x.v))
+        SHADOW_FUNCTION(cos, Cos, std::cos(x.v))
+        SHADOW_FUNCTION(tan, Tan, std::tan(x.v))
+        SHADOW_FUNCTION(cot, Cot, 1 / std::tan(x.v))
+#undef SHADOW_FUNCTION
+
+        friend Shadowed fabs(const Shadowed &x) { return (x.v < 0) ? -x : x; }
+
+        friend std::ostream &operator<<(std::ostream &os, const Shadowed &x) {
+            return os << x.v;
+        }
+    };
+
+    //  Edit an error in ulps, with two decimals unless it's large
+    inline const char *editUlps(char *s, size_t n, double u) {
+        snprintf(s, n, (u < 1e5) ? "%.2f" : "%.2e", u);
+        return s;
+    }
+
+    /*  Report the error of the ray's state leaving each surface
+        and the worst operation and cancellation within it, then
+        the largest error of each operation by surface, over all
+        rays.  rayNames names the rays numbered from 0, and the
+        ray numbered nRays holds the operations after the rays
+        are traced.  */
+    inline void report(std::ostream &os, const Tally &t, const char *const rayNames[],
+                       int nRays, const char *finalName) {
+        char line[120];
+        os << "Error leaving each surface and largest within it, in ulps of double" << std::endl;
+        snprintf(line, sizeof line, "%-12s %7s %12s %12s   %-16s %9s", "Ray", "Surface",
+            "Obj. dist.", "Slope angle", "Worst operation", "Cancelled");
+        os << line << std::endl;
+
+        bool used[nOperations] = { };
+        int lastSurface = 0;
+        for (int i = 0; i <= nRays && i < MaxRays; i++) {
+            for (int j = 0; j <= MaxSurfaces; j++) {
+                const Exit &e = t.exits[i][j];
+                int worst = -1;
+                double lost = 0;
+                for (int k = 0; k < nOperations; k++) {
+                    const Stats &s = t.ops[i][j][k];
+                    if (s.n == 0) {
+                        continue;
+                    }
+                    used[k] = true;
+                    if (worst < 0 || s.maxUlp > t.ops[i][j][worst].maxUlp) {
+                        worst = k;
+                    }
+                    lost = (s.maxLost > lost) ? s.maxLost : lost;
+                }
+                if (e.n == 0 && (i < nRays || worst < 0)) {
+                    continue;
+                }
+                lastSurface = (e.n > 0 && j > lastSurface) ? j : lastSurface;
+                char worstOp[40] = "", where[8] = "", od[16] = "", sa[16] = "", u[16];
+                if (worst >= 0) {
+                    snprintf(worstOp, sizeof worstOp, "%-5s %9s", names[worst],
+                        editUlps(u, sizeof u, t.ops[i][j][worst].maxUlp));
+                }
+                if (e.n > 0) {
+                    snprintf(where, sizeof where, "%d", j);
+                    editUlps(od, sizeof od, e.od);
+                    editUlps(sa, sizeof sa, e.sa);
+                }
+                snprintf(line, sizeof line, "%-12s %7s %12s %12s   %-16s %4.1f bits",
+                    (i < nRays) ? rayNames[i] : finalName, where, od, sa, worstOp, lost);
+                os << line << std::endl;
+            }
+        }
+
+        os << std::endl << "Largest error of each operation, in ulps of double" << std::endl;
+        char *p = line;
+        const char *const end = line + sizeof line;
+        p += snprintf(p, end - p, "%-12s", "Surface");
+        for (int k = 0; k < nOperations; k++) {
+            if (used[k]) {
+                p += snprintf(p, end - p, " %8s", names[k]);
+            }
+        }
+        os << line << std::endl;
+        for (int j = 1; j <= lastSurface + 1; j++) {
+            const bool final = j > lastSurface;
+            bool any = false;
+            p = line;
+            if (final) {
+                p += snprintf(p, end - p, "%-12s", finalName);
+            } else {
+                p += snprintf(p, end - p, "%-12d", j);
+            }
+            for (int k = 0; k < nOperations; k++) {
+                if (!used[k]) {
+                    continue;
+                }
+                double m = 0;
+                unsigned long n = 0;
+                for (int i = final ? nRays : 0; i < (final ? nRays + 1 : nRays); i++) {
+                    const Stats &s = t.ops[i][final ? 0 : j][k];
+                    n += s.n;
+                    m = (s.maxUlp > m) ? s.maxUlp : m;
+                }
+                any = any || n > 0;
+                char u[16];
+                p += snprintf(p, end - p, " %8s", (n > 0) ? editUlps(u, sizeof u, m) : "-");
+            }
+            if (any) {
+                os << line << std::endl;
+            }
+        }
+        if (t.divergences > 0) {
+            snprintf(line, sizeof line, "%lu comparisons decided differently by the shadow",
+                t.divergences);
+        } else {
+            snprintf(line, sizeof line, "No comparison decided differently by the shadow");
+        }
+        os << line << std::endl;
+    }
+}
+
+#endif
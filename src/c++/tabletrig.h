@@ -0,0 +1,164 @@
+/*  Table-driven sine, cosine, and arc sine
+
+    The ray tracer evaluates its trigonometric functions on a
+    narrow range of small arguments: for the test design, sines
+    of arguments between -0.12 and 0.10 and arc sines of
+    arguments between -0.22 and 0.07.  These functions look up
+    the value at the nearest point xk of a grid with spacing
+    1/128 and correct it with a short polynomial in the distance
+    from that point.
+
+    For the sine and cosine, with x = xk + r and |r| <= 1/256,
+
+        sin(x) = sin(xk) + (cos(xk) sin(r) - sin(xk) (1 - cos(r)))
+        cos(x) = cos(xk) - (sin(xk) sin(r) + cos(xk) (1 - cos(r)))
+
+    where sin(r) and 1 - cos(r) are the leading terms of their
+    Taylor series: two terms each for double, and three for long
+    double.  The correction in parentheses is small compared to
+    the tabulated value, so its rounding errors contribute little
+    to the result.  The table covers 0 <= xk <= 1.
+
+    For the arc sine, with xk the grid point nearest |x|,
+
+        asin(x) = asin(xk) + asin(x sqrt(1 - xk^2) - xk sqrt(1 - x^2))
+
+    where the argument d of the second arc sine is less than
+    0.006 in magnitude for |x| <= 3/4, and four or five terms of
+    its series suffice.  The table holds asin(xk) and
+    sqrt(1 - xk^2) for 0 <= xk <= 3/4.
+
+    Arguments outside the tables are passed to the library
+    functions.  The cotangent is the quotient of the cosine and
+    sine, computed together from the same table entry.
+
+    The tables are computed with the library functions of the
+    type when first used.  They occupy 3.6 Kb for double and
+    twice that for long double, and so fit easily in the level 1
+    data cache of any current processor.  The type T must be one
+    for which <cmath> provides sin, cos, asin, and sqrt: double
+    or long double.  */
+
+#ifndef TABLETRIG_H
+#define TABLETRIG_H
+
+#include <cmath>
+#include <limits>
+
+namespace tabletrig {
+
+    const int Steps = 128;                  // Grid points per unit
+    const int SinPoints = Steps + 1;        // Sine table: 0 to 1
+    const int AsinPoints = (Steps * 3) / 4 + 1; // Arc sine table: 0 to 3/4
+
+    template <class T> struct Tables {
+        struct SinCos {
+            T s, c;                         // sin(xk), cos(xk)
+        } sc[SinPoints];
+        struct ArcSin {
+            T a, c;                         // asin(xk), sqrt(1 - xk^2)
+        } as[AsinPoints];
+
+        Tables() {
+            for (int k = 0; k < SinPoints; k++) {
+                const T x = T(k) / Steps;
+                sc[k].s = std::sin(x);
+                sc[k].c = std::cos(x);
+            }
+            for (int k = 0; k < AsinPoints; k++) {
+                const T x = T(k) / Steps;
+                as[k].a = std::asin(x);
+                as[k].c = std::sqrt(1 - x * x);
+            }
+        }
+    };
+
+    template <class T> inline const Tables<T> &tables(void) {
+        static const Tables<T> t;
+        return t;
+    }
+
+    //  Does T need the additional terms for long double?
+    template <class T> inline bool extended(void) {
+        return std::numeric_limits<T>::digits > 53;
+    }
+
+    /*  sin(r) and 1 - cos(r) for the offset r from a grid point,
+        given t = r^2.  */
+    template <class T> inline T sinOffset(T r, T t) {
+        const T p = extended<T>() ? T(1) / 120 + t * (T(-1) / 5040) : T(1) / 120;
+        return r + (r * t) * (T(-1) / 6 + t * p);
+    }
+
+    template <class T> inline T versineOffset(T t) {
+        const T p = extended<T>() ? T(-1) / 24 + t * (T(1) / 720) : T(-1) / 24;
+        return t * (T(1) / 2 + t * p);
+    }
+
+    /*  Find the grid point nearest |x|, returning false if it's
+        outside the sine table.  */
+    template <class T> inline bool sinPoint(T ax, int &k, T &r) {
+        if (!(ax <= 1)) {
+            return false;
+        }
+        k = (int) (ax * Steps + T(0.5));
+        r = ax - T(k) * (T(1) / Steps);
+        return true;
+    }
+
+    template <class T> inline T sin(T x) {
+        const T ax = std::fabs(x);
+        int k;
+        T r;
+        if (!sinPoint(ax, k, r)) {
+            return std::sin(x);
+        }
+        const typename Tables<T>::SinCos &p = tables<T>().sc[k];
+        const T t = r * r;
+        const T s = p.s + (p.c * sinOffset(r, t) - p.s * versineOffset(t));
+        return (x < 0) ? -s : s;
+    }
+
+    template <class T> inline T cos(T x) {
+        const T ax = std::fabs(x);
+        int k;
+        T r;
+        if (!sinPoint(ax, k, r)) {
+            return std::cos(x);
+        }
+        const typename Tables<T>::SinCos &p = tables<T>().sc[k];
+        const T t = r * r;
+        return p.c - (p.s * sinOffset(r, t) + p.c * versineOffset(t));
+    }
+
+    template <class T> inline T cot(T x) {
+        const T ax = std::fabs(x);
+        int k;
+        T r;
+        if (!sinPoint(ax, k, r)) {
+            return 1 / std::tan(x);
+        }
+        const typename Tables<T>::SinCos &p = tables<T>().sc[k];
+        const T t = r * r;
+        const T sr = sinOffset(r, t), vr = versineOffset(t);
+        const T c = p.c - (p.s * sr + p.c * vr),
+                s = p.s + (p.c * sr - p.s * vr);
+        return (x < 0) ? -c / s : c / s;
+    }
+
+    template <class T> inline T asin(T x) {
+        const T ax = std::fabs(x);
+        if (!(ax <= T(0.75))) {
+            return std::asin(x);
+        }
+        const int k = (int) (ax * Steps + T(0.5));
+        const typename Tables<T>::ArcSin &p = tables<T>().as[k];
+        const T d = ax * p.c - (T(k) * (T(1) / Steps)) * std::sqrt(1 - ax * ax),
+                t = d * d;
+        const T q = extended<T>() ? T(5) / 112 + t * (T(35) / 1152) : T(5) / 112;
+        const T a = p.a + (d + (d * t) * (T(1) / 6 + t * (T(3) / 40 + t * q)));
+        return (x < 0) ? -a : a;
+    }
+}
+
+#endif
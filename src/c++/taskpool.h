@@ -0,0 +1,136 @@
+/*  Persistent pool of worker threads
+
+    A Pool runs a set of n independent tasks, numbered 0 to n - 1,
+    on threads created once, when the pool is constructed, and
+    kept waiting between jobs, so a job pays only for waking the
+    workers, not for creating them.  The calling thread takes
+    tasks too, so a pool of w workers runs up to w + 1 tasks at
+    once, and run() returns only when every task of the job has
+    finished and every worker has let go of it, so the caller may
+    use the tasks' results, and reuse or destroy their arguments,
+    as soon as it returns.
+
+    Tasks are handed out from a shared counter, so a thread which
+    finishes a short task goes on to the next one not yet taken.
+    Workers block on a condition variable between jobs rather
+    than spinning, so an idle pool costs nothing, and a pool with
+    more workers than the machine has processors is slower, but
+    still correct.  Only one thread may call run() at a time.
+
+    A task must not throw an exception: one escaping a task on a
+    worker thread terminates the program.  */
+
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace taskpool {
+
+    class Pool {
+    public:
+        //  A task: called with the argument given to run() and its number
+        typedef void (*Task)(void *arg, int i);
+
+    private:
+        std::vector<std::thread> workers;
+        std::mutex lock;
+        std::condition_variable wake;       // Workers: a job is ready
+        std::condition_variable done;       // Caller: the job is finished
+
+        unsigned long generation;           // Jobs started, guarded by lock
+        bool stopping;                      // Destructor called
+        int active;                         // Workers inside the current job
+
+        Task task;                          // Current job, set under lock
+        void *arg;
+        int nTasks;
+        std::atomic<int> next;              // Next task to take
+
+        //  Take and run tasks until none are left
+        void work(Task t, void *a, int n) {
+            int i;
+            while ((i = next.fetch_add(1)) < n) {
+                t(a, i);
+            }
+        }
+
+        void worker(void) {
+            std::unique_lock<std::mutex> l(lock);
+            unsigned long seen = generation;
+            while (true) {
+                wake.wait(l, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+                const Task t = task;
+                void *const a = arg;
+                const int n = nTasks;
+                active++;
+                l.unlock();
+                work(t, a, n);
+                l.lock();
+                if (--active == 0) {
+                    done.notify_one();
+                }
+            }
+        }
+
+        Pool(const Pool &);
+        Pool &operator=(const Pool &);
+
+    public:
+        //  Create a pool with the given number of workers
+        explicit Pool(int nWorkers) :
+            generation(0), stopping(false), active(0),
+            task(NULL), arg(NULL), nTasks(0), next(0) {
+            for (int i = 0; i < nWorkers; i++) {
+                workers.push_back(std::thread(&Pool::worker, this));
+            }
+        }
+
+        ~Pool() {
+            {
+                std::lock_guard<std::mutex> l(lock);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (size_t i = 0; i < workers.size(); i++) {
+                workers[i].join();
+            }
+        }
+
+        int size(void) const {
+            return (int) workers.size();
+        }
+
+        //  Run tasks 0 to n - 1 of t, returning when all are done
+        void run(Task t, void *a, int n) {
+            {
+                std::lock_guard<std::mutex> l(lock);
+                task = t;
+                arg = a;
+                nTasks = n;
+                next.store(0);
+                generation++;
+            }
+            wake.notify_all();
+            work(t, a, n);
+
+            /*  Every task has now been taken.  A worker takes tasks
+                only while it is counted as active, so once none is,
+                every task is finished and none can take a task from
+                the next job.  */
+            std::unique_lock<std::mutex> l(lock);
+            done.wait(l, [&] { return active == 0; });
+        }
+    };
+}
+
+#endif
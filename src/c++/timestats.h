@@ -0,0 +1,82 @@
+/*  Summary statistics of repeated timings
+
+    A benchmark timed once tells us little about how much the
+    time varies from run to run, and so whether a difference
+    between two machines or builds is real.  summarise() reduces
+    the times of a number of repetitions to their mean, median,
+    sample standard deviation, range, and the 95% confidence
+    interval of the mean, computed with Student's t distribution,
+    which is appropriate for the handful of repetitions a
+    benchmark can afford.  The interval assumes the repetitions
+    are independent samples of a normal distribution, which
+    timings only approximate: a machine disturbed by other work
+    produces occasional long times, which the median resists
+    better than the mean.  */
+
+#ifndef TIMESTATS_H
+#define TIMESTATS_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace timestats {
+
+    struct Summary {
+        int n;                          // Number of samples
+        double mean, median;
+        double stddev;                  // Sample standard deviation
+        double min, max;
+        double ci95;                    // Half width of 95% confidence interval of mean
+    };
+
+    /*  Two-sided 95% critical value of Student's t distribution
+        with the given degrees of freedom.  Beyond the table we
+        interpolate in 1 / df towards the normal value.  */
+    inline double t95(int df) {
+        static const double t[] = {
+            0,      12.706, 4.303,  3.182,  2.776,  2.571,  2.447,  2.365,
+            2.306,  2.262,  2.228,  2.201,  2.179,  2.160,  2.145,  2.131,
+            2.120,  2.110,  2.101,  2.093,  2.086,  2.080,  2.074,  2.069,
+            2.064,  2.060,  2.056,  2.052,  2.048,  2.045,  2.042
+        };
+        const int nt = sizeof t / sizeof t[0];
+        if (df < 1) {
+            return 0;
+        }
+        if (df < nt) {
+            return t[df];
+        }
+        const double z = 1.960;
+        return z + (t[nt - 1] - z) * (nt - 1) / df;
+    }
+
+    inline Summary summarise(std::vector<double> x) {
+        Summary s = Summary();
+        s.n = (int) x.size();
+        if (s.n == 0) {
+            return s;
+        }
+        std::sort(x.begin(), x.end());
+        s.min = x.front();
+        s.max = x.back();
+        s.median = (s.n % 2) ? x[s.n / 2] : (x[s.n / 2 - 1] + x[s.n / 2]) / 2;
+
+        double sum = 0;
+        for (int i = 0; i < s.n; i++) {
+            sum += x[i];
+        }
+        s.mean = sum / s.n;
+        if (s.n > 1) {
+            double ss = 0;
+            for (int i = 0; i < s.n; i++) {
+                ss += (x[i] - s.mean) * (x[i] - s.mean);
+            }
+            s.stddev = std::sqrt(ss / (s.n - 1));
+            s.ci95 = t95(s.n - 1) * s.stddev / std::sqrt((double) s.n);
+        }
+        return s;
+    }
+}
+
+#endif
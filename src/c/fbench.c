@@ -71,6 +71,17 @@
         and checking the results on every pass.  All incorrect results
         will be reported.
 
+        Rather than choosing an iteration count by hand, you can run
+        "fbench -t <seconds>" to have the program calibrate the count
+        for the speed of the machine.  It doubles the count of a
+        short probe until the probe runs at least a fifth of a
+        second, then runs the benchmark in chunks of about a
+        twentieth of the requested time, sizing each chunk from the
+        speed measured by the one before, so the run stops close to
+        the requested time even if the machine speeds up or slows
+        down along the way.  It reports the time normalised to 1000
+        iterations, as in the table below.
+
         Representative  timings  are  given  below.   All  have   been
         normalised as if run for 1000 iterations.
 
@@ -233,9 +244,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #ifndef INTRIG
 #include <math.h>
 #endif
+#ifndef ACCURACY
+#include "results.h"
+#endif
 
 #define cot(x) (1.0 / tan(x))
 
@@ -271,6 +286,7 @@ static double to_index;
 static double spectral_line[9];
 static double s[max_surfaces][5];
 static double od_sa[2][2];
+static double od_cline, od_fline;
 
 static char outarr[8][80];         /* Computed output of program goes here */
 
@@ -680,6 +696,120 @@ double ray_h;
         }
 }
 
+/*  Trace the design once: the marginal and paraxial rays in D
+    light and the marginal rays in C and F, and compute the
+    aberrations from them.  */
+
+static void trace_design()
+{
+        for (paraxial = 0; paraxial <= 1; paraxial++) {
+
+           /* Do main trace in D light */
+
+           trace_line(4, clear_aperture / 2.0);
+           od_sa[paraxial][0] = object_distance;
+           od_sa[paraxial][1] = axis_slope_angle;
+        }
+        paraxial = FALSE;
+
+        /* Trace marginal ray in C */
+
+        trace_line(3, clear_aperture / 2.0);
+        od_cline = object_distance;
+
+        /* Trace marginal ray in F */
+
+        trace_line(6, clear_aperture / 2.0);
+        od_fline = object_distance;
+
+        aberr_lspher = od_sa[1][0] - od_sa[0][0];
+        aberr_osc = 1.0 - (od_sa[1][0] * od_sa[1][1]) /
+           (sin(od_sa[0][1]) * od_sa[0][0]);
+        aberr_lchrom = od_fline - od_cline;
+        max_lspher = sin(od_sa[0][1]);
+
+        /* D light */
+
+        max_lspher = 0.0000926 / (max_lspher * max_lspher);
+        max_osc = 0.0025;
+        max_lchrom = max_lspher;
+}
+
+#ifndef ACCURACY
+
+/*  Calibrated runs.  Seconds on a clock which never steps
+    backward, where the system provides one.  */
+
+static double seconds()
+{
+#ifdef CLOCK_MONOTONIC
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+        return ((double) clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+/*  Trace the design n times, returning the elapsed time.  */
+
+static double time_traces(n)
+long n;
+{
+        double start = seconds();
+        long l;
+
+        for (l = 0; l < n; l++)
+           trace_design();
+        return seconds() - start;
+}
+
+#define PROBE_TIME 0.2             /* Minimum probe, seconds */
+#define CHUNKS     20              /* Chunks in a calibrated run */
+
+/*  Run for the given number of seconds, after a probe which finds
+    the iteration rate, and return the number of iterations run.
+    The elapsed time and the fastest and slowest chunk rates, in
+    iterations per second, are stored through the pointers.  */
+
+static long calibrated_run(duration, elapsed, fastest, slowest)
+double duration, *elapsed, *fastest, *slowest;
+{
+        double rate, t, want, chunk = duration / CHUNKS,
+               probe = duration / 10 < PROBE_TIME ? duration / 10 : PROBE_TIME;
+        long n, total = 0;
+        int chunks = 0, last;
+
+        n = 1;
+        while ((t = time_traces(n)) < probe)
+           n *= 2;
+        rate = n / t;
+
+        *elapsed = *fastest = *slowest = 0;
+        while (*elapsed < duration) {
+           want = duration - *elapsed;
+           last = want <= 1.5 * chunk;
+           n = (long) ((last ? want : chunk) * rate + 0.5);
+           if (n < 1) {
+              if (last && total > 0)
+                 break;            /* Stopping is closer to the duration */
+              n = 1;
+           }
+           t = time_traces(n);
+           *elapsed += t;
+           total += n;
+           rate = n / t;
+           if (chunks == 0 || rate > *fastest)
+              *fastest = rate;
+           if (chunks == 0 || rate < *slowest)
+              *slowest = rate;
+           chunks++;
+        }
+        return total;
+}
+#endif
+
 /*  Initialise when called the first time  */
 
 int main(argc, argv)
@@ -687,9 +817,14 @@ int argc;
 char *argv[];
 {
         int i, j, k, errors;
-        double od_fline, od_cline;
+        double duration = 0;
 #ifdef ACCURACY
         long passes;
+#else
+        double elapsed = 0, fastest, slowest;
+        long iterations = 0;
+        char *json = NULL, *csv = NULL, **args = argv;
+        int nargs = argc;
 #endif
 
         spectral_line[1] = 7621.0;       /* A */
@@ -703,16 +838,44 @@ char *argv[];
 
         /* Process the number of iterations argument, if one is supplied. */
 
+#ifndef ACCURACY
+        /* Files to which to append a record of the run */
+
+        while (argc > 2 && (strcmp(argv[1], "-json") == 0 ||
+                            strcmp(argv[1], "-csv") == 0)) {
+           if (strcmp(argv[1], "-json") == 0)
+              json = argv[2];
+           else
+              csv = argv[2];
+           argc -= 2;
+           argv += 2;
+        }
+#endif
+
         if (argc > 1) {
-           niter = atoi(argv[1]);
-           if (*argv[1] == '-' || niter < 1) {
+#ifndef ACCURACY
+           if (argc > 2 && strcmp(argv[1], "-t") == 0)
+              duration = atof(argv[2]);
+           else
+#endif
+              niter = atoi(argv[1]);
+           if (!(duration > 0) && (*argv[1] == '-' || niter < 1)) {
               printf("This is John Walker's floating point accuracy and\n");
               printf("performance benchmark program.  You call it with\n");
               printf("\nfbench <itercount>\n\n");
               printf("where <itercount> is the number of iterations\n");
               printf("to be executed.  Archival timings should be made\n");
               printf("with the iteration count set so that roughly five\n");
-              printf("minutes of execution is timed.\n");
+              printf("minutes of execution is timed.  Or call it with\n");
+              printf("\nfbench -t <seconds>\n\n");
+              printf("to calibrate the iteration count to run for the\n");
+              printf("given number of seconds and report the time.\n");
+#ifndef ACCURACY
+              printf("Either may be preceded by \"-json <file>\" or\n");
+              printf("\"-csv <file>\" to append a record of the run,\n");
+              printf("timed by the program, to the file (\"-\" for\n");
+              printf("standard output).\n");
+#endif
               exit(0);
            }
         }
@@ -729,16 +892,32 @@ char *argv[];
         printf("Beginning execution of floating point accuracy test...\n");
         passes = 0;
 #else
-        printf("Ready to begin John Walker's floating point accuracy\n");
-        printf("and performance benchmark.  %d iterations will be made.\n\n",
-           niter);
+        if (duration > 0) {
+           printf("Calibrating John Walker's floating point accuracy and\n");
+           printf("performance benchmark to run for %.f seconds.\n\n", duration);
+           iterations = calibrated_run(duration, &elapsed, &fastest, &slowest);
+           printf("%ld iterations in %.3f seconds.\n", iterations, elapsed);
+           printf("Normalised to 1000 iterations:   %.6f seconds.\n",
+              (elapsed * 1000) / iterations);
+           printf("Chunks ranged from %.6f to %.6f seconds per 1000 (%.2f%%).\n",
+              1000 / fastest, 1000 / slowest, 100 * (fastest - slowest) / slowest);
+           niter = 0;              /* The results are those of the last chunk */
+        } else if (json != NULL || csv != NULL) {
+           iterations = niter;     /* Timed by the program */
+           elapsed = time_traces(iterations);
+           niter = 0;
+        } else {
+           printf("Ready to begin John Walker's floating point accuracy\n");
+           printf("and performance benchmark.  %d iterations will be made.\n\n",
+              niter);
 
-        printf("\nMeasured run time in seconds should be divided by %.f\n", niter / 1000.0);
-        printf("to normalise for reporting results.  For archival results,\n");
-        printf("adjust iteration count so the benchmark runs about five minutes.\n\n");
+           printf("\nMeasured run time in seconds should be divided by %.f\n", niter / 1000.0);
+           printf("to normalise for reporting results.  For archival results,\n");
+           printf("adjust iteration count so the benchmark runs about five minutes.\n\n");
 
-        printf("Press return to begin benchmark:");
-        fgets(tbfr, sizeof tbfr, stdin);
+           printf("Press return to begin benchmark:");
+           fgets(tbfr, sizeof tbfr, stdin);
+        }
 #endif
 
         /* Perform ray trace the specified number of times. */
@@ -753,42 +932,14 @@ char *argv[];
         for (itercount = 0; itercount < niter; itercount++) {
 #endif
 
-           for (paraxial = 0; paraxial <= 1; paraxial++) {
-
-              /* Do main trace in D light */
-
-              trace_line(4, clear_aperture / 2.0);
-              od_sa[paraxial][0] = object_distance;
-              od_sa[paraxial][1] = axis_slope_angle;
-           }
-           paraxial = FALSE;
-
-           /* Trace marginal ray in C */
-
-           trace_line(3, clear_aperture / 2.0);
-           od_cline = object_distance;
-
-           /* Trace marginal ray in F */
-
-           trace_line(6, clear_aperture / 2.0);
-           od_fline = object_distance;
-
-           aberr_lspher = od_sa[1][0] - od_sa[0][0];
-           aberr_osc = 1.0 - (od_sa[1][0] * od_sa[1][1]) /
-              (sin(od_sa[0][1]) * od_sa[0][0]);
-           aberr_lchrom = od_fline - od_cline;
-           max_lspher = sin(od_sa[0][1]);
-
-           /* D light */
-
-           max_lspher = 0.0000926 / (max_lspher * max_lspher);
-           max_osc = 0.0025;
-           max_lchrom = max_lspher;
+           trace_design();
 #ifndef ACCURACY
         }
 
-        printf("Stop the timer:\007");
-        fgets(tbfr, sizeof tbfr, stdin);
+        if (!(duration > 0) && json == NULL && csv == NULL) {
+           printf("Stop the timer:\007");
+           fgets(tbfr, sizeof tbfr, stdin);
+        }
 #endif
 
         /* Now evaluate the accuracy of the results from the last ray trace */
@@ -848,6 +999,25 @@ char *argv[];
               errors, errors > 1 ? "s" : "");
         } else
            printf("\nNo errors in results.\n");
+
+        if (json != NULL || csv != NULL) {
+           run_fields("fbench", "double", 53,
+#ifdef INTRIG
+              "intrig",
+#else
+              "library",
+#endif
+              nargs, args, duration > 0 ? "duration" : "iterations",
+              iterations, elapsed, errors);
+           if (json != NULL && !append_json(json)) {
+              fprintf(stderr, "fbench: cannot write results to %s\n", json);
+              return 1;
+           }
+           if (csv != NULL && !append_csv(csv)) {
+              fprintf(stderr, "fbench: cannot write results to %s\n", csv);
+              return 1;
+           }
+        }
 #endif
         return 0;
 }
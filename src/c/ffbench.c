@@ -24,7 +24,23 @@
         follows: Float = double, Asize = 256, Passes = 20, CAPOUT  not
         defined.   Times on faster machines are scaled by running more
         iterations   and  adjusting  the   measured  run  time  to  an
-        equivalent iteration count.
+        equivalent iteration count.  Alternatively, "ffbench -t
+        <seconds>" calibrates the iteration count for the speed of
+        the machine: it doubles the count of a short probe until the
+        probe runs at least a fifth of a second, then runs in chunks
+        of about a twentieth of the requested time, sizing each chunk
+        from the speed measured by the one before, so the run stops
+        close to the requested time even if the machine speeds up or
+        slows down along the way, and reports the time normalised to
+        1000 iterations.
+
+        "ffbench -perf" followed by either form of arguments reports
+        the counts of the processor's performance counters during the
+        timed iterations, on Linux systems where they are available.
+
+        "-json <file>" and "-csv <file>" before the  other  arguments
+        append  a record of the run, its iterations, time, validation
+        and the build and machine which ran it, to the file.
 
         Time (seconds)              System
 
@@ -135,13 +151,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <math.h>
+#include <float.h>
+#ifdef __linux__
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#include "results.h"
 
 /*  The  program  may  be  run  with  Float defined as either float or
     double.  With IEEE arithmetic, the same answers are generated  for
     either floating point mode.  */
 
 #define Float    double            /* Floating point type used in FFT */
+#define STRING(x) #x
+#define NAME(x)   STRING(x)
+#define FloatBits (sizeof(Float) == sizeof(float) ? FLT_MANT_DIG : \
+                   sizeof(Float) == sizeof(double) ? DBL_MANT_DIG : LDBL_MANT_DIG)
 
 #define Asize    256               /* Array edge size */
 
@@ -246,6 +279,360 @@ static void fourn(data, nn, ndim, isign)
 }
 #undef SWAP
 
+/*  Restore the data array and run npasses FFT/inverse passes
+    over it.  */
+
+#define Re(x,y) fdata[1 + (faedge * (x) + (y)) * 2]
+#define Im(x,y) fdata[2 + (faedge * (x) + (y)) * 2]
+
+static void fft_passes(fdata, nsize, faedge, fasize, npasses)
+  Float fdata[];
+  int nsize[], faedge, npasses;
+  long fasize;
+{
+        int i, j;
+
+        /*  Generate data array to process.  */
+
+        memset(fdata, 0, fasize);
+        for (i = 0; i < faedge; i++) {
+           for (j = 0; j < faedge; j++) {
+              if (((i & 15) == 8) || ((j & 15) == 8))
+                 Re(i, j) = 128.0;
+           }
+        }
+
+        for (i = 0; i < npasses; i++) {
+/*printf("Pass %d\n", i);*/
+           /* Transform image to frequency domain. */
+           fourn(fdata, nsize, 2, 1);
+
+           /* Back-transform to image. */
+           fourn(fdata, nsize, 2, -1);
+        }
+}
+
+/*  Calibrated runs.  Seconds on a clock which never steps
+    backward, where the system provides one.  */
+
+static double seconds()
+{
+#ifdef CLOCK_MONOTONIC
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+        return ((double) clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+/*  Hardware performance counters.  Each group of events is counted
+    together, so the ratios among its counts, such as instructions
+    per cycle, are exact even when the kernel shares the hardware
+    counters among groups by time, in which case the counts are
+    scaled by the fraction of the time the group was counted.  A
+    group whose leader can't be opened is reported as unavailable
+    with the reason, and a member which can't be opened is dropped.
+    Only events of this process are counted: hardware events in
+    user mode only, and software events, such as context switches,
+    which happen in the kernel, including it.  Floating point
+    operations are counted with the FP_ARITH_INST_RETIRED events
+    of Intel processors from Broadwell on, which count a fused
+    multiply-add as two.  */
+
+int perf = 0;                      /* Counting requested by -perf */
+long perf_iterations = 0;          /* Iterations counted */
+
+#ifdef __linux__
+
+#define L1D_MISS  (PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | \
+                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+#define LLC_MISS  (PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | \
+                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static struct perf_counter {
+        char *group;               /* Group name, set for its leader only */
+        char *name;
+        unsigned int type;
+        unsigned long long config;
+        int fd;                    /* File descriptor, or -1 */
+        char *problem;             /* Why the group isn't counted */
+        double count;              /* Scaled count */
+} counters[] = {
+        {"Processor", "Cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {NULL, "Instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {NULL, "Branch misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {"Cache", "L1D read misses", PERF_TYPE_HW_CACHE, L1D_MISS},
+        {NULL, "LLC read misses", PERF_TYPE_HW_CACHE, LLC_MISS},
+        {"Floating point", "FP scalar double", PERF_TYPE_RAW, 0x01C7},
+        {NULL, "FP 128-bit double", PERF_TYPE_RAW, 0x04C7},
+        {NULL, "FP 256-bit double", PERF_TYPE_RAW, 0x10C7},
+        {NULL, "FP 512-bit double", PERF_TYPE_RAW, 0x40C7},
+        {"Kernel", "Task clock (ns)", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+        {NULL, "Context switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+        {NULL, "CPU migrations", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS},
+        {NULL, "Page faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}
+};
+
+#define NCOUNTERS ((int) (sizeof counters / sizeof counters[0]))
+
+/*  Does the processor have Intel's FP_ARITH_INST_RETIRED events?  */
+
+static int intel_arith()
+{
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned int eax, ebx, ecx, edx;
+
+        if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx))
+           return 0;
+        if (ebx != 0x756e6547 || edx != 0x49656e69 || ecx != 0x6c65746e)
+           return 0;               /* Not "GenuineIntel" */
+        __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+        return ((eax >> 8) & 0xF) == 6;
+#else
+        return 0;
+#endif
+}
+
+static void perf_open()
+{
+        struct perf_event_attr a;
+        int i, leader = -1;
+
+        for (i = 0; i < NCOUNTERS; i++) {
+           counters[i].fd = -1;
+           counters[i].count = 0;
+           if (counters[i].group != NULL) {
+              leader = i;
+              counters[i].problem = NULL;
+              if (counters[i].type == PERF_TYPE_RAW && !intel_arith()) {
+                 counters[i].problem = "no arithmetic events known for this processor";
+                 continue;
+              }
+           } else if (counters[leader].fd < 0) {
+              continue;
+           }
+           memset(&a, 0, sizeof a);
+           a.size = sizeof a;
+           a.type = counters[i].type;
+           a.config = counters[i].config;
+           a.disabled = leader == i;
+           /* Software events such as context switches happen in the kernel */
+           a.exclude_kernel = a.exclude_hv = counters[i].type != PERF_TYPE_SOFTWARE;
+           a.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+           counters[i].fd = (int) syscall(SYS_perf_event_open, &a, 0, -1,
+              leader == i ? -1 : counters[leader].fd, 0);
+           if (counters[i].fd < 0 && leader == i)
+              counters[i].problem = strerror(errno);
+        }
+}
+
+static void perf_ioctl(request)
+  unsigned long request;
+{
+        int i;
+
+        for (i = 0; i < NCOUNTERS; i++) {
+           if (counters[i].group != NULL && counters[i].fd >= 0)
+              ioctl(counters[i].fd, request, PERF_IOC_FLAG_GROUP);
+        }
+}
+
+/*  Read the counts of each group, scaled to the time it was enabled.  */
+
+static void perf_read()
+{
+        unsigned long long v[3 + NCOUNTERS];
+        int i, j, n;
+        double scale;
+
+        for (i = 0; i < NCOUNTERS; i++) {
+           if (counters[i].group == NULL || counters[i].fd < 0)
+              continue;
+           for (n = 0, j = i + 1; j < NCOUNTERS && counters[j].group == NULL; j++) {
+              if (counters[j].fd >= 0)
+                 n++;
+           }
+           if (read(counters[i].fd, v, (3 + n + 1) * sizeof v[0]) <
+                 (ssize_t) ((3 + n + 1) * sizeof v[0])) {
+              counters[i].problem = "counts could not be read";
+              continue;
+           }
+           if (v[2] == 0) {
+              counters[i].problem = "never scheduled on the processor's counters";
+              continue;
+           }
+           scale = ((double) v[1]) / v[2];
+           counters[i].count = v[3] * scale;
+           for (n = 0, j = i + 1; j < NCOUNTERS && counters[j].group == NULL; j++) {
+              if (counters[j].fd >= 0)
+                 counters[j].count = v[3 + ++n] * scale;
+           }
+        }
+}
+
+/*  Count of the named event, or -1 if it wasn't counted.  */
+
+static double perf_count(name)
+  char *name;
+{
+        int i, leader = 0;
+
+        for (i = 0; i < NCOUNTERS; i++) {
+           if (counters[i].group != NULL)
+              leader = i;
+           if (strcmp(counters[i].name, name) == 0)
+              return (counters[i].fd >= 0 && counters[leader].problem == NULL) ?
+                 counters[i].count : -1;
+        }
+        return -1;
+}
+
+/*  Report the counts per iteration and per transform, of which there
+    are two in an iteration.  */
+
+static void perf_report()
+{
+        int i, leader = 0;
+        double n, cycles, instructions, flops;
+        char title[40];
+
+        perf_read();
+        sprintf(title, "Counters for %ld iterations", perf_iterations);
+        printf("%-32s %14s  %13s\n", title, "Per iteration", "Per transform");
+        if (perf_iterations <= 0)
+           return;
+        for (i = 0; i < NCOUNTERS; i++) {
+           if (counters[i].group != NULL) {
+              leader = i;
+              if (counters[i].problem != NULL)
+                 printf("    %-16s unavailable: %s\n", counters[i].group,
+                    counters[i].problem);
+           }
+           if (counters[leader].problem != NULL || counters[i].fd < 0)
+              continue;
+           n = counters[i].count / perf_iterations;
+           printf("    %-28s %14.3f  %13.4f\n", counters[i].name, n, n / 2);
+        }
+
+        cycles = perf_count("Cycles");
+        instructions = perf_count("Instructions");
+        if (cycles > 0 && instructions >= 0)
+           printf("    %-28s %14.3f\n", "Instructions per cycle",
+              instructions / cycles);
+        if ((flops = perf_count("FP scalar double")) >= 0) {
+           flops += 2 * max(0, perf_count("FP 128-bit double")) +
+                    4 * max(0, perf_count("FP 256-bit double")) +
+                    8 * max(0, perf_count("FP 512-bit double"));
+           n = flops / perf_iterations;
+           if (n > 0)
+              printf("    %-28s %14.3f  %13.4f\n", "Double precision FLOPs", n, n / 2);
+           else
+              printf("    %-28s none counted\n", "Double precision FLOPs");
+        }
+}
+
+#else
+
+static void perf_open()
+{
+}
+
+static void perf_report()
+{
+        printf("Performance counters are supported only on Linux.\n");
+}
+
+#endif
+
+static void perf_start()
+{
+#ifdef __linux__
+        if (perf)
+           perf_ioctl(PERF_EVENT_IOC_ENABLE);
+#endif
+}
+
+static void perf_stop(n)
+  long n;
+{
+#ifdef __linux__
+        if (perf)
+           perf_ioctl(PERF_EVENT_IOC_DISABLE);
+#endif
+        perf_iterations += n;
+}
+
+/*  Run n times Passes iterations, returning the elapsed time.  */
+
+static double time_passes(fdata, nsize, faedge, fasize, n)
+  Float fdata[];
+  int nsize[], faedge;
+  long fasize, n;
+{
+        double start, t;
+        long k;
+
+        perf_start();
+        start = seconds();
+        for (k = 0; k < n; k++)
+           fft_passes(fdata, nsize, faedge, fasize, Passes);
+        t = seconds() - start;
+        perf_stop(n * Passes);
+        return t;
+}
+
+#define PROBE_TIME 0.2             /* Minimum probe, seconds */
+#define CHUNKS     20              /* Chunks in a calibrated run */
+
+/*  Run for the given number of seconds, after a probe which finds
+    the rate, in units of Passes iterations, and return the number
+    of iterations run.  The elapsed time and the fastest and
+    slowest chunk rates, in iterations per second, are stored
+    through the pointers.  */
+
+static long calibrated_run(fdata, nsize, faedge, fasize, duration,
+                           elapsed, fastest, slowest)
+  Float fdata[];
+  int nsize[], faedge;
+  long fasize;
+  double duration, *elapsed, *fastest, *slowest;
+{
+        double rate, t, want, chunk = duration / CHUNKS,
+               probe = min(PROBE_TIME, duration / 10);
+        long n, total = 0;
+        int chunks = 0, last;
+
+        n = 1;
+        while ((t = time_passes(fdata, nsize, faedge, fasize, n)) < probe)
+           n *= 2;
+        rate = n / t;
+
+        *elapsed = *fastest = *slowest = 0;
+        while (*elapsed < duration) {
+           want = duration - *elapsed;
+           last = want <= 1.5 * chunk;
+           n = (long) ((last ? want : chunk) * rate + 0.5);
+           if (n < 1) {
+              if (last && total > 0)
+                 break;            /* Stopping is closer to the duration */
+              n = 1;
+           }
+           t = time_passes(fdata, nsize, faedge, fasize, n);
+           *elapsed += t;
+           total += n * Passes;
+           rate = n / t;
+           if (chunks == 0 || rate * Passes > *fastest)
+              *fastest = rate * Passes;
+           if (chunks == 0 || rate * Passes < *slowest)
+              *slowest = rate * Passes;
+           chunks++;
+        }
+        return total;
+}
+
 int main(int argc, char *argv[])
 {
         int i, j, k, l, m, times,
@@ -254,6 +641,9 @@ int main(int argc, char *argv[])
         static int nsize[] = {0, 0, 0};
         long fanum, fasize;
         double mapbase, mapscale, rmin, rmax, imin, imax;
+        double duration = 0, elapsed, fastest, slowest;
+        char *json = NULL, *csv = NULL, **args = argv;
+        int nargs = argc;
 
         faedge = Asize;            /* FFT array edge size */
         fanum = faedge * faedge;   /* Elements in FFT array */
@@ -266,12 +656,39 @@ int main(int argc, char *argv[])
            exit(1);
         }
 
-        if (argc > 1) {
+        while (argc > 1) {
+           if (strcmp(argv[1], "-perf") == 0) {
+              perf = 1;
+              argc--;
+              argv++;
+           } else if (argc > 2 && strcmp(argv[1], "-json") == 0) {
+              json = argv[2];
+              argc -= 2;
+              argv += 2;
+           } else if (argc > 2 && strcmp(argv[1], "-csv") == 0) {
+              csv = argv[2];
+              argc -= 2;
+              argv += 2;
+           } else
+              break;
+        }
+        if (perf)
+           perf_open();
+
+        if (argc > 2 && strcmp(argv[1], "-t") == 0) {
+           duration = atof(argv[2]);
+           if (!(duration > 0)) {
+              printf("Invalid run time %s.  Must be greater than zero.\n",
+                argv[2]);
+              return 1;
+           }
+        } else if (argc > 1) {
            niter = atoi(argv[1]);
            if (*argv[1] == '-' || niter < Passes ||
               ((niter % Passes) != 0)) {
               printf("Invalid iteration count %d.  Must be a multiple of %d.\n",
                 niter, Passes);
+              printf("Or use \"-t <seconds>\" to calibrate the count.\n");
               return 1;
            }
         }
@@ -283,35 +700,29 @@ int main(int argc, char *argv[])
             accuracy will be lost due to build-up of floating
             point roundoff.  */
 
+        if (duration > 0) {
+           iters = calibrated_run(fdata, nsize, faedge, fasize, duration,
+                                  &elapsed, &fastest, &slowest);
+           printf("%d iterations in %.3f seconds.\n", iters, elapsed);
+           printf("Normalised to 1000 iterations:   %.4f seconds.\n",
+              (elapsed * 1000) / iters);
+           printf("Chunks ranged from %.4f to %.4f seconds per 1000 (%.2f%%).\n",
+              1000 / fastest, 1000 / slowest, 100 * (fastest - slowest) / slowest);
+        } else {
 /*printf("Iterations: %d\n", niter);*/
-        times = niter / Passes;
-        for (k = 0; k < times; k++) {
+           times = niter / Passes;
+           perf_start();
+           elapsed = seconds();
+           for (k = 0; k < times; k++) {
 /*printf("Time %d of %d\n", k, times);*/
-
-            /*  Generate data array to process.  */
-
-#define Re(x,y) fdata[1 + (faedge * (x) + (y)) * 2]
-#define Im(x,y) fdata[2 + (faedge * (x) + (y)) * 2]
-
-            memset(fdata, 0, fasize);
-            for (i = 0; i < faedge; i++) {
-               for (j = 0; j < faedge; j++) {
-                  if (((i & 15) == 8) || ((j & 15) == 8))
-                     Re(i, j) = 128.0;
-               }
-            }
-
-            for (i = 0; i < npasses; i++) {
-/*printf("Pass %d\n", i);*/
-               /* Transform image to frequency domain. */
-               fourn(fdata, nsize, 2, 1);
-
-               /* Back-transform to image. */
-               fourn(fdata, nsize, 2, -1);
-
-               iters++;
-            }
+              fft_passes(fdata, nsize, faedge, fasize, npasses);
+              iters += npasses;
+           }
+           elapsed = seconds() - elapsed;
+           perf_stop((long) iters);
         }
+        if (perf)
+           perf_report();
 
         {
            double r, ij, ar, ai;
@@ -362,6 +773,19 @@ int main(int argc, char *argv[])
               iters, m);
         }
 
+        if (json != NULL || csv != NULL) {
+           run_fields("ffbench", NAME(Float), FloatBits, "library", nargs, args,
+              duration > 0 ? "duration" : "iterations", (long) iters, elapsed, m);
+           if (json != NULL && !append_json(json)) {
+              fprintf(stderr, "ffbench: cannot write results to %s\n", json);
+              return 1;
+           }
+           if (csv != NULL && !append_csv(csv)) {
+              fprintf(stderr, "ffbench: cannot write results to %s\n", csv);
+              return 1;
+           }
+        }
+
 #ifdef CAPOUT
 
         /* Output the result of the transform as a CA Lab pattern
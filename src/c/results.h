@@ -0,0 +1,368 @@
+/*  Machine-readable results with provenance
+
+    The fields of a run's record are added in order by the
+    program, then by provenance() those describing the build and
+    machine which produced them: the time, host, kernel, processor
+    model and microcode revision, frequency governor, processors
+    the run may use, compiler and its version, the options it was
+    given, which the Makefile passes as COMPILE_FLAGS, the
+    instruction set extensions it could use, and the version of
+    the C library, which supplies the mathematical functions at run
+    time.  Fields which aren't known are null.  append_json() appends the record to a file as
+    one line of JSON, and append_csv() as a row of comma separated
+    values, preceded by a line of field names if the file is empty.
+    A file name of "-" writes to standard output.  The fields are
+    those written by the C++ fbench, so the records of all the
+    benchmarks can be kept together.
+
+    This file uses nothing from <math.h>, so it may be included
+    before fbench's internal trigonometric functions replace the
+    library's names.  */
+
+#ifdef __linux__
+#include <sys/utsname.h>
+#endif
+#ifdef __GLIBC__
+#include <gnu/libc-version.h>
+#endif
+
+#define R_STRING   0               /* Kinds of field: quoted string */
+#define R_LITERAL  1               /* Number or boolean, written as is */
+#define R_NULL     2               /* Unknown */
+
+#define R_FIELDS   48              /* Maximum fields in a record */
+#define R_LENGTH   256             /* Maximum length of a value */
+
+static struct r_field {
+        char *name;
+        int kind;
+        char value[R_LENGTH];
+} r_fields[R_FIELDS];
+static int r_nfields = 0;
+
+/*  Add a field.  A string which is empty or NULL is unknown.  */
+
+static void field(name, kind, value)
+  char *name;
+  int kind;
+  char *value;
+{
+        struct r_field *f;
+
+        if (r_nfields >= R_FIELDS)
+           return;
+        f = &r_fields[r_nfields++];
+        f->name = name;
+        f->kind = (value == NULL || *value == 0) ? R_NULL : kind;
+        strncpy(f->value, (f->kind == R_NULL) ? "" : value, R_LENGTH - 1);
+        f->value[R_LENGTH - 1] = 0;
+}
+
+/*  Add a number, or null if it isn't finite.  */
+
+static void field_number(name, format, v)
+  char *name, *format;
+  double v;
+{
+        char s[40];
+
+        s[0] = 0;
+        if (v == v && v - v == 0)
+           sprintf(s, format, v);
+        field(name, R_LITERAL, s);
+}
+
+#ifdef __linux__
+
+/*  First line of a file, or "" if it can't be read.  */
+
+static char *first_line(fname, s, n)
+  char *fname, *s;
+  int n;
+{
+        FILE *fp = fopen(fname, "r");
+
+        s[0] = 0;
+        if (fp != NULL) {
+           if (fgets(s, n, fp) == NULL)
+              s[0] = 0;
+           fclose(fp);
+        }
+        s[strcspn(s, "\n")] = 0;
+        return s;
+}
+
+/*  Value of the first line of a file of "key: value" lines with
+    the given key, as in /proc/cpuinfo, or "" if there's none.  */
+
+static char *key_value(fname, key, s, n)
+  char *fname, *key, *s;
+  int n;
+{
+        char line[512], *p;
+        int l = strlen(key);
+        FILE *fp = fopen(fname, "r");
+
+        s[0] = 0;
+        if (fp == NULL)
+           return s;
+        while (fgets(line, sizeof line, fp) != NULL) {
+           if (strncmp(line, key, l) == 0 && strchr(" \t:", line[l]) != NULL &&
+               (p = strchr(line, ':')) != NULL) {
+              p += strspn(p + 1, " \t") + 1;
+              p[strcspn(p, "\n")] = 0;
+              strncpy(s, p, n - 1);
+              s[n - 1] = 0;
+              break;
+           }
+        }
+        fclose(fp);
+        return s;
+}
+#endif
+
+/*  Add the fields describing the build and the machine.  */
+
+static void provenance()
+{
+        char s[R_LENGTH], features[80];
+        time_t now = time(NULL);
+
+        strftime(s, sizeof s, "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+        field("timestamp", R_STRING, s);
+
+#ifdef __linux__
+        {
+           struct utsname u;
+           char model[R_LENGTH], cpus[R_LENGTH], path[80];
+           int named = uname(&u) == 0;
+
+           field("host", R_STRING, named ? u.nodename : "");
+           if (named)
+              sprintf(s, "%.100s %.100s", u.sysname, u.release);
+           field("kernel", R_STRING, named ? s : "");
+           field("machine", R_STRING, named ? u.machine : "");
+           if (*key_value("/proc/cpuinfo", "model name", model, sizeof model) == 0)
+              key_value("/proc/cpuinfo", "Model", model, sizeof model);  /* ARM */
+           field("cpu_model", R_STRING, model);
+           field("microcode", R_STRING,
+              key_value("/proc/cpuinfo", "microcode", s, sizeof s));
+
+           /* The governor of the first processor we may run on */
+
+           key_value("/proc/self/status", "Cpus_allowed_list", cpus, sizeof cpus);
+           sprintf(path, "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor",
+              atoi(cpus));
+           field("governor", R_STRING, first_line(path, s, sizeof s));
+           field("affinity", R_STRING, cpus);
+        }
+#else
+        field("host", R_NULL, NULL);
+        field("kernel", R_NULL, NULL);
+        field("machine", R_NULL, NULL);
+        field("cpu_model", R_NULL, NULL);
+        field("microcode", R_NULL, NULL);
+        field("governor", R_NULL, NULL);
+        field("affinity", R_NULL, NULL);
+#endif
+
+#if defined(__clang__)
+        field("compiler", R_STRING, "clang " __clang_version__);
+#elif defined(__GNUC__)
+        field("compiler", R_STRING, "gcc " __VERSION__);
+#else
+        field("compiler", R_NULL, NULL);
+#endif
+#ifdef COMPILE_FLAGS
+        field("flags", R_STRING, COMPILE_FLAGS);
+#else
+        field("flags", R_NULL, NULL);
+#endif
+
+        /* Instruction sets and options the compiler was allowed */
+
+        features[0] = 0;
+#ifdef __SSE2__
+        strcat(features, " sse2");
+#endif
+#ifdef __AVX__
+        strcat(features, " avx");
+#endif
+#ifdef __AVX2__
+        strcat(features, " avx2");
+#endif
+#ifdef __FMA__
+        strcat(features, " fma");
+#endif
+#ifdef __AVX512F__
+        strcat(features, " avx512f");
+#endif
+#ifdef __ARM_NEON
+        strcat(features, " neon");
+#endif
+#ifdef __FAST_MATH__
+        strcat(features, " fast-math");
+#endif
+        field("features", R_STRING, features[0] == 0 ? features : features + 1);
+#ifdef __GLIBC__
+        sprintf(s, "glibc %.40s", gnu_get_libc_version());
+        field("libc", R_STRING, s);
+#else
+        field("libc", R_NULL, NULL);
+#endif
+}
+
+/*  Add the fields of a run: its arguments and mode, the
+    iterations it ran and their time, if it was timed (seconds
+    less than zero if not), and the errors in its results,
+    followed by the provenance.  */
+
+static void run_fields(benchmark, real_type, real_bits, trig, argc, argv,
+                       mode, iterations, seconds, errors)
+  char *benchmark, *real_type, *trig, *argv[], *mode;
+  int real_bits, argc, errors;
+  long iterations;
+  double seconds;
+{
+        char s[R_LENGTH];
+        static char *stats[] = {
+           "usec_mean", "usec_median", "usec_stddev", "usec_ci95", "usec_min", "usec_max"
+        };
+        int i;
+
+        field("benchmark", R_STRING, benchmark);
+        field("language", R_STRING, "C");
+        field("real_type", R_STRING, real_type);
+        field_number("real_bits", "%.0f", (double) real_bits);
+        field("trig", R_STRING, trig);
+        s[0] = 0;
+        for (i = 1; i < argc; i++) {
+           if (strlen(s) + strlen(argv[i]) + 2 < sizeof s) {
+              if (i > 1)
+                 strcat(s, " ");
+              strcat(s, argv[i]);
+           }
+        }
+        field("arguments", R_STRING, s);
+        field("mode", R_STRING, mode);
+        field_number("iterations", "%.0f", (double) iterations);
+        field_number("repetitions", "%.0f", 1.0);
+        if (seconds >= 0) {
+           field_number("seconds", "%.6f", seconds);
+           field_number("usec_per_iteration", "%.6f", (seconds * 1e6) / iterations);
+        } else {
+           field("seconds", R_NULL, NULL);
+           field("usec_per_iteration", R_NULL, NULL);
+        }
+        for (i = 0; i < 6; i++)               /* Repeated timings are C++ only */
+           field(stats[i], R_NULL, NULL);
+        field_number("errors", "%.0f", (double) errors);
+        field("valid", R_LITERAL, errors == 0 ? "true" : "false");
+        provenance();
+}
+
+static FILE *open_append(fname)
+  char *fname;
+{
+        return strcmp(fname, "-") == 0 ? stdout : fopen(fname, "a");
+}
+
+/*  Close a file opened by open_append(), returning nonzero if
+    everything was written.  */
+
+static int close_append(fp, written)
+  FILE *fp;
+  int written;
+{
+        if (fp == stdout)
+           return fflush(fp) == 0 && written;
+        return fclose(fp) == 0 && written;
+}
+
+static void put_json(fp, s)
+  FILE *fp;
+  char *s;
+{
+        putc('"', fp);
+        for (; *s != 0; s++) {
+           if (*s == '"' || *s == '\\')
+              fprintf(fp, "\\%c", *s);
+           else if ((unsigned char) *s < ' ')
+              fprintf(fp, "\\u%04x", (unsigned char) *s);
+           else
+              putc(*s, fp);
+        }
+        putc('"', fp);
+}
+
+static void put_csv(fp, s)
+  FILE *fp;
+  char *s;
+{
+        if (strpbrk(s, ",\"\n\r") == NULL) {
+           fputs(s, fp);
+           return;
+        }
+        putc('"', fp);
+        for (; *s != 0; s++) {
+           if (*s == '"')
+              putc('"', fp);
+           putc(*s, fp);
+        }
+        putc('"', fp);
+}
+
+/*  Append the record to a file as a line of JSON, returning
+    nonzero if it was written.  */
+
+static int append_json(fname)
+  char *fname;
+{
+        FILE *fp = open_append(fname);
+        int i;
+
+        if (fp == NULL)
+           return 0;
+        putc('{', fp);
+        for (i = 0; i < r_nfields; i++) {
+           if (i > 0)
+              fputs(", ", fp);
+           put_json(fp, r_fields[i].name);
+           fputs(": ", fp);
+           if (r_fields[i].kind == R_STRING)
+              put_json(fp, r_fields[i].value);
+           else
+              fputs(r_fields[i].kind == R_NULL ? "null" : r_fields[i].value, fp);
+        }
+        fputs("}\n", fp);
+        return close_append(fp, !ferror(fp));
+}
+
+/*  Append the record to a file as a row of comma separated
+    values, preceded by the field names if the file is empty or
+    is standard output, returning nonzero if it was written.  */
+
+static int append_csv(fname)
+  char *fname;
+{
+        FILE *fp = open_append(fname);
+        int i;
+
+        if (fp == NULL)
+           return 0;
+        if (fp == stdout || (fseek(fp, 0L, SEEK_END) == 0 && ftell(fp) == 0)) {
+           for (i = 0; i < r_nfields; i++) {
+              if (i > 0)
+                 putc(',', fp);
+              put_csv(fp, r_fields[i].name);
+           }
+           putc('\n', fp);
+        }
+        for (i = 0; i < r_nfields; i++) {
+           if (i > 0)
+              putc(',', fp);
+           put_csv(fp, r_fields[i].value);
+        }
+        putc('\n', fp);
+        return close_append(fp, !ferror(fp));
+}
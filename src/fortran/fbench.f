@@ -67,7 +67,8 @@ c       Spectral line indices
 
         double precision odsa(2,2)
         integer tbfr(80)
-        integer niter
+        integer niter, iargc
+        character*20 arg
 
         common /dat/ rheight, tlod, tlsa,
      1               findex, indref,
@@ -80,11 +81,16 @@ c       within subroutine tline.
 c
 c       The variable niter specifies the number of iterations to be
 c       executed.  Change it and recompile to adjust for reasonable
-c       timing on your system.  For archival timings, set the iteration
-c       count so the benchmark runs around five minutes.
+c       timing on your system, or give the count as the argument.
+c       For archival timings, set the iteration count so the
+c       benchmark runs around five minutes.
 c
         niter = 10000
 c        niter = 200 000 000
+        if (iargc() .gt. 0) then
+           call getarg(1, arg)
+           read (arg, *) niter
+        endif
 
         print 1111, niter
 1111    format ('Press return to begin ', i8, ' iterations:')
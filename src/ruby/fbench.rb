@@ -21,6 +21,12 @@
     #   average floating point program.
 
     niter = 1000000
+    if ARGV.length > 0
+        niter = ARGV[0].to_i
+        if niter < 1
+            abort("Invalid iteration count #{ARGV[0]}.")
+        end
+    end
 
     #       Wavelengths of standard spectral lines in Angstroms
     #               (Not all are used in this program)
@@ -190,7 +196,7 @@ EOS
         niter, niter / 1000.0)
 
     print "Press return to begin benchmark: "
-    gets()
+    $stdin.gets()
 
     tstart = Time.new
 
@@ -235,7 +241,7 @@ EOS
     tend = Time.new
 
     print "Stop the timer: "
-    gets()
+    $stdin.gets()
 
     outarr = Array.new
     outarr[0] = sprintf("%15s   %21.11f  %14.11f",
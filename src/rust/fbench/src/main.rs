@@ -437,16 +437,28 @@ fn main() {
     //  Actually run the benchmark, show results, and display time
 
     //  For official runs, adjust ITERATIONS so the benchmark
-    //  runs about five minutes.
+    //  runs about five minutes, or give the iteration count as
+    //  the argument.
 //    const ITERATIONS: u32 = 340_023_965;
     const ITERATIONS: u32 = 1_000_000;
 
+    let iterations: u32 = match std::env::args().nth(1) {
+        Some(arg) => match arg.parse() {
+            Ok(n) if n > 0 => n,
+            _ => {
+                eprintln!("Invalid iteration count {}.", arg);
+                std::process::exit(2);
+            }
+        },
+        None => ITERATIONS
+    };
+
     let start = time::precise_time_ns();
-    let de = run_benchmark(ITERATIONS, &WYLD_LENS, WYLD_CLEAR_APERTURE);
+    let de = run_benchmark(iterations, &WYLD_LENS, WYLD_CLEAR_APERTURE);
     let fin = time::precise_time_ns();
     let lapse: f64 = ((fin - start) as f64) / 1_000_000_000.0;
     evaluation_report(de);
 
     println!("Time for {} iterations: {} seconds, {} \u{00B5}sec/iteration.",
-        ITERATIONS, lapse, (lapse * 1_000_000.0) / (ITERATIONS as f64));
+        iterations, lapse, (lapse * 1_000_000.0) / (iterations as f64));
 }
@@ -0,0 +1,370 @@
+#! /usr/bin/perl
+
+#   Build, run, validate, and compare the benchmark in each language
+
+#   The language comparisons on Web_pages/fbench.html were made by
+#   hand: building each port, finding an iteration count which ran
+#   long enough, timing it, checking its results, and dividing its
+#   time by that of C.  This program does all of that for every
+#   port whose toolchain is installed, and prints a table of the
+#   results.
+#
+#       fbcompare.pl [options] [language...]
+#
+#   with no languages runs them all.  C, the reference, is run
+#   whenever it's available.  Options are:
+#
+#       -time s     Seconds of timed runs for each language (10)
+#       -probe s    Shortest run from which the speed is estimated (0.5)
+#       -nobuild    Use the programs already built
+#       -json file  Append a record of each language's run to the file
+#       -list       List the languages and whether each can be run
+#
+#   "make compare" in the src directory runs it for all languages.
+#
+#   Each port is built by making just the program we run, in its
+#   own directory and without cleaning it first, so the other
+#   programs built there, such as the C++ versions for other
+#   types, are left as they are.  The output of the build goes to
+#   fbcompare-<language>.log in the temporary directory.
+#
+#   A port joins the comparison by following this contract:
+#
+#       1.  It takes the number of iterations as its first argument,
+#           written as it is in the run command in @languages, below.
+#       2.  It reads no more than three lines from standard input,
+#           like the "Press return" prompts of many ports, which
+#           are given blank lines.
+#       3.  It reports on its results in one of three ways, named
+#           by "check" in @languages:
+#               report  It checks them itself and prints "No errors
+#                       in results." if they're correct.
+#               values  It prints them, and we check them against
+#                       the reference values.
+#               quiet   It checks them itself and prints nothing
+#                       unless they're wrong.
+#           In every case, a message of an error means they're
+#           wrong.
+#       4.  It exits with status 0.
+#
+#   Ports which can't be given an iteration count, or which must be
+#   run by hand, aren't in @languages.
+#
+#   The time of a language is measured around the whole program,
+#   so any port which meets the contract can be timed the same way.
+#   The time taken to start it, which is large for those with a
+#   virtual machine or compiler to load, is measured by running it
+#   for one iteration, and subtracted.  The iteration count is
+#   chosen from a probe, run with counts multiplied by four until
+#   it takes at least -probe seconds, so that three timed runs
+#   take about -time seconds together.  The shortest of the three
+#   runs, and of the three of one iteration, are used, as those
+#   least disturbed by other activity on the machine.
+
+    use strict;
+    use warnings;
+    use Cwd qw(abs_path);
+    use File::Basename;
+    use File::Spec;
+    use Getopt::Long;
+    use JSON::PP;
+    use POSIX qw(uname strftime);
+    use Time::HiRes;
+
+    my $src = abs_path(dirname(abs_path($0)) . "/../src");
+    my $target = 10;
+    my $probe = 0.5;
+    my $rounds = 3;
+    my $build = 1;
+    my $list = 0;
+    my $json;
+
+    #   The ports, each with:
+    #       name     The language, by which it's selected and shown
+    #       tools    The programs it needs; alternatives are separated
+    #                by "|"
+    #       dir      Its directory, in which it's built and run
+    #       build    If it's compiled, the command which builds it
+    #       program  The program the build makes
+    #       run      The command which runs it, in which %n is replaced
+    #                by the iteration count and %1, %2, ... by the tools
+    #       check    How its output reports on its results (see above)
+
+    my @languages = (
+        { name => 'C', tools => ['gcc'], dir => 'c', build => 'make fbench',
+          program => 'fbench', run => './fbench %n', check => 'report' },
+        { name => 'C++', tools => ['g++'], dir => 'c++', build => 'make fbench',
+          program => 'fbench', run => './fbench %n', check => 'report' },
+        { name => 'Ada', tools => ['gnatmake'], dir => 'ada',
+          build => 'gnatmake fbench.adb', program => 'fbench', run => './fbench %n',
+          check => 'report' },
+        { name => 'Chapel', tools => ['chpl'], dir => 'chapel', build => 'make serial',
+          program => 'fbench', run => './fbench --iterations=%n', check => 'quiet' },
+        { name => 'Fortran', tools => ['f77'], dir => 'fortran', build => 'make fbench',
+          program => 'fbench', run => './fbench %n', check => 'values' },
+        { name => 'Go', tools => ['go'], dir => 'go', build => 'make fbench',
+          program => 'fbench', run => './fbench -%n', check => 'report' },
+        { name => 'Haskell', tools => ['ghc'], dir => 'haskell', build => 'make fbench',
+          program => 'fbench', run => './fbench -%n', check => 'report' },
+        { name => 'Java', tools => ['javac', 'java'], dir => 'java',
+          build => 'make fbench', program => 'fbench.class', run => '%2 fbench %n',
+          check => 'values' },
+        { name => 'JavaScript', tools => ['nodejs|node'], dir => 'javascript',
+          run => '%1 fbench.js %n', check => 'report' },
+        { name => 'Julia', tools => ['julia'], dir => 'julia',
+          run => '%1 -O2 --check-bounds=no fbench.jl %n', check => 'report' },
+        { name => 'Perl', tools => ['perl'], dir => 'perl', run => '%1 fbench.pl %n',
+          check => 'report' },
+        { name => 'PHP', tools => ['php'], dir => 'php', run => '%1 fbench.php %n',
+          check => 'report' },
+        { name => 'Python', tools => ['python3'], dir => 'python/python3',
+          run => '%1 fbench.py %n', check => 'report' },
+        { name => 'Ruby', tools => ['ruby'], dir => 'ruby', run => '%1 fbench.rb %n',
+          check => 'report' },
+        { name => 'Rust', tools => ['cargo'], dir => 'rust',
+          build => 'cd fbench && CARGO_INCREMENTAL=0 cargo build --release',
+          program => 'fbench/target/release/fbench',
+          run => 'fbench/target/release/fbench %n', check => 'values' }
+    );
+
+    #   The values of the results, as printed by the ports which
+    #   show them
+
+    my @reference = (
+        47.09479120920, 0.04178472683, 47.08372160249, 0.04177864821,
+        -0.01106960671, 0.05306749907, 0.00008954761, 0.00250000000,
+        0.00448229032, 0.05306749907
+    );
+
+    GetOptions('time=f' => \$target, 'probe=f' => \$probe, 'build!' => \$build,
+               'json=s' => \$json, 'list' => \$list) || usage();
+
+    my @selected;
+    foreach my $a (@ARGV) {
+        my @l = grep { lc($_->{name}) eq lc($a) } @languages;
+        die("fbcompare: unknown language $a\n") if scalar(@l) == 0;
+        push(@selected, @l);
+    }
+    @selected = @languages if scalar(@selected) == 0;
+    unshift(@selected, $languages[0]) if !grep { $_ == $languages[0] } @selected;
+
+    if ($list) {
+        foreach my $l (@languages) {
+            my $missing = findTools($l);
+            printf("%-12s %s\n", $l->{name}, $missing ? "no $missing" : 'available');
+        }
+        exit(0);
+    }
+
+    my (@results, @skipped);
+    foreach my $l (@selected) {
+        my $missing = findTools($l);
+        if ($missing) {
+            push(@skipped, "$l->{name} (no $missing)");
+            next;
+        }
+        if ($l->{build} && !buildPort($l)) {
+            push(@skipped, "$l->{name} (" .
+                ($build ? "build failed, see " . buildLog($l) : "not built") . ")");
+            next;
+        }
+        print(STDERR "Timing $l->{name}...\n");
+        my $r = timePort($l);
+        if (defined($r->{failed})) {
+            push(@skipped, "$l->{name} ($r->{failed})");
+            next;
+        }
+        push(@results, $r);
+        appendRecord($r) if defined($json);
+    }
+    report();
+    exit((grep { !$_->{valid} } @results) ? 1 : 0);
+
+    sub usage {
+        print(STDERR "Usage: fbcompare.pl [-time s] [-probe s] [-nobuild] [-json file] " .
+                     "[-list] [language...]\n");
+        exit(2);
+    }
+
+    #   Find the programs a port needs, returning the name of the
+    #   first which is missing, or "" if there are all there
+
+    sub findTools {
+        my ($l) = @_;
+        my @found;
+
+        foreach my $t (@{$l->{tools}}) {
+            my ($f) = grep { inPath($_) } split(/\|/, $t);
+            return $t if !defined($f);
+            push(@found, $f);
+        }
+        $l->{found} = \@found;
+        return '';
+    }
+
+    sub inPath {
+        my ($program) = @_;
+        return scalar(grep { -x "$_/$program" } split(/:/, $ENV{PATH} || ''));
+    }
+
+    sub buildLog {
+        my ($l) = @_;
+        return File::Spec->tmpdir() . '/fbcompare-' . lc($l->{name}) . '.log';
+    }
+
+    sub buildPort {
+        my ($l) = @_;
+
+        if ($build) {
+            print(STDERR "Building $l->{name}...\n");
+            return 0 if system("cd '$src/$l->{dir}' && $l->{build} >'" .
+                               buildLog($l) . "' 2>&1") != 0;
+        }
+        return -e "$src/$l->{dir}/$l->{program}";
+    }
+
+    #   Run a port for n iterations, returning the elapsed time
+    #   and its output
+
+    sub runPort {
+        my ($l, $n) = @_;
+        my $command = $l->{run};
+
+        $command =~ s/%n/$n/g;
+        $command =~ s/%(\d)/$l->{found}[$1 - 1]/g;
+        my $start = Time::HiRes::time();
+        my $output = `cd '$src/$l->{dir}' && printf '\\n\\n\\n' | $command 2>&1`;
+        my $status = $?;
+        return (Time::HiRes::time() - $start, $output, $status, $command);
+    }
+
+    #   Check the output of a run, returning an empty string if
+    #   the results are correct, or why they aren't
+
+    sub checkOutput {
+        my ($l, $output, $status) = @_;
+
+        return sprintf("exit status %d", $status >> 8) if $status != 0;
+        return "errors in results" if $output =~ m/(?<!No )errors? (in|detected in) results/i ||
+                                      $output =~ m/Validation failed|VERY SERIOUS/;
+        if ($l->{check} eq 'report') {
+            return $output =~ m/No errors in results\./ ? '' : 'no report of results';
+        } elsif ($l->{check} eq 'values') {
+            my @v = ($output =~ m/(-?\d*\.\d{8,})/g);
+            #   The reference values must appear in order
+            my $i = 0;
+            foreach my $v (@v) {
+                $i++ if $i <= $#reference && abs($v - $reference[$i]) < 5e-12;
+            }
+            return $i > $#reference ? '' : 'results differ from reference';
+        }
+        return '';
+    }
+
+    sub timePort {
+        my ($l) = @_;
+        my ($t, $output, $status, $command);
+        my $n = 1000;
+
+        while (1) {
+            ($t, $output, $status, $command) = runPort($l, $n);
+            my $error = checkOutput($l, $output, $status);
+            return { failed => "$command: $error" } if $error ne '';
+            last if $t >= $probe;
+            $n *= 4;
+        }
+        my $m = int(($n / $t) * $target / $rounds) + 1;
+        $m = $n if $m < $n;
+
+        #   The shortest of the runs of one iteration, and of the
+        #   timed runs, least disturbed by anything else
+
+        my ($startup, $timed, $error) = (-1, -1, '');
+        for (my $i = 0; $i < $rounds; $i++) {
+            my ($t1, $o1, $s1) = runPort($l, 1);
+            my ($tm, $om, $sm) = runPort($l, $m);
+            $error = $error || checkOutput($l, $o1, $s1) || checkOutput($l, $om, $sm);
+            $startup = $t1 if $startup < 0 || $t1 < $startup;
+            $timed = $tm if $timed < 0 || $tm < $timed;
+        }
+        $command =~ s/\b$n\b/%n/;
+        return { name => $l->{name}, iterations => $m, seconds => $timed,
+                 usec => (($timed > $startup ? $timed - $startup : $timed) * 1e6) / $m,
+                 startup => $startup, valid => $error eq '', error => $error,
+                 command => $command };
+    }
+
+    sub report {
+        my ($c) = grep { $_->{name} eq 'C' } @results;
+
+        printf("\n%-12s %12s %12s %10s %9s  %s\n", 'Language', 'Iterations', 'usec/iter',
+            'Startup s', 'vs. C', 'Results');
+        foreach my $r (sort { $a->{usec} <=> $b->{usec} } @results) {
+            printf("%-12s %12d %12.4f %10.3f %9s  %s\n", $r->{name}, $r->{iterations},
+                $r->{usec}, $r->{startup}, defined($c) ? sprintf('%.3f', $r->{usec} / $c->{usec}) : '-',
+                $r->{valid} ? 'valid' : $r->{error});
+        }
+        print("\nSkipped: ", join(', ', @skipped), "\n") if scalar(@skipped) > 0;
+    }
+
+    #   Append the record of a language's run, with the fields
+    #   written by fbench and ffbench, so tools/fbresults.pl can
+    #   keep it.  What was compiled, and how, isn't known.
+
+    sub appendRecord {
+        my ($r) = @_;
+        my @u = uname();
+        my $cpus = keyValue('/proc/self/status', 'Cpus_allowed_list');
+        my $governor;
+        my ($first) = defined($cpus) ? ($cpus =~ /^(\d+)/) : ();
+        if (defined($first) && open(my $g, '<', "/sys/devices/system/cpu/cpu$first" .
+                                    '/cpufreq/scaling_governor')) {
+            chomp($governor = <$g>);
+            close($g);
+        }
+        my @record = (
+            benchmark => 'fbench', language => $r->{name}, real_type => 'double',
+            real_bits => 53, trig => 'library', arguments => $r->{command},
+            mode => 'iterations', iterations => $r->{iterations}, repetitions => 1,
+            seconds => sprintf('%.6f', $r->{seconds}) + 0,
+            usec_per_iteration => sprintf('%.6f', $r->{usec}) + 0,
+            usec_mean => undef, usec_median => undef, usec_stddev => undef,
+            usec_ci95 => undef, usec_min => undef, usec_max => undef,
+            errors => $r->{valid} ? 0 : 1,
+            valid => $r->{valid} ? JSON::PP::true : JSON::PP::false,
+            timestamp => strftime('%Y-%m-%dT%H:%M:%SZ', gmtime()),
+            host => $u[1], kernel => "$u[0] $u[2]", machine => $u[4],
+            cpu_model => keyValue('/proc/cpuinfo', 'model name') ||
+                         keyValue('/proc/cpuinfo', 'Model'),
+            microcode => keyValue('/proc/cpuinfo', 'microcode'),
+            governor => $governor, affinity => $cpus,
+            compiler => undef, flags => undef, features => undef, libc => undef
+        );
+
+        #   Write the fields in order, as the benchmarks do
+
+        my $coder = JSON::PP->new()->allow_nonref();
+        my @fields;
+        for (my $i = 0; $i < $#record; $i += 2) {
+            push(@fields, $coder->encode($record[$i]) . ': ' . $coder->encode($record[$i + 1]));
+        }
+        open(my $fh, '>>', $json) || die("fbcompare: cannot open $json: $!\n");
+        print($fh '{', join(', ', @fields), "}\n");
+        close($fh) || die("fbcompare: cannot write $json: $!\n");
+    }
+
+    #   Value of the first line of a "key: value" file with the key
+
+    sub keyValue {
+        my ($file, $key) = @_;
+
+        open(my $fh, '<', $file) || return undef;
+        while (my $l = <$fh>) {
+            if ($l =~ m/^\Q$key\E\s*:\s*(.*?)\s*$/) {
+                close($fh);
+                return $1;
+            }
+        }
+        close($fh);
+        return undef;
+    }
@@ -0,0 +1,460 @@
+#! /usr/bin/perl
+
+#   Store benchmark results and detect changes in their speed
+
+#   The C and C++ fbench and ffbench programs write a record of
+#   each run with their -json and -csv options: its time and
+#   validation, and the build and machine which produced it.
+#   This program keeps those records in a store, which is an
+#   append-only file of JSON lines, and finds where the speed of
+#   each series of runs changed.  It takes the place of the
+#   spreadsheet benchmark_analysis.ods, into which results used
+#   to be copied by hand.
+#
+#       fbresults.pl [-store file] ingest file...
+#           Add the records in the files, which may be JSON lines
+#           or CSV as the benchmarks write them, or "-" for
+#           standard input, to the store.  Records already in the
+#           store are skipped, so files may be ingested again as
+#           they grow.
+#
+#       fbresults.pl [-store file] list
+#           List the series in the store, with the number of runs
+#           and the median time of the most recent.
+#
+#       fbresults.pl [-store file] check [options]
+#           Report the changes in speed of each series, and flag
+#           those which leave it slower than its baseline as
+#           regressions.  The exit status is 1 if any were found.
+#
+#   A series is the runs of one variant, on one host, by one
+#   build.  The variant is the benchmark, language, floating
+#   point type and precision, trigonometric functions, and the
+#   options which change what is computed; options which only
+#   change how long it runs or what it reports, such as the
+#   iteration count, -repeat, -duration, and -perf, don't
+#   distinguish variants.  The build is the compiler and its
+#   version, options, and instruction set extensions.  Changes to
+#   the kernel, C library, microcode, or processor don't start a
+#   new series, since those are among the causes we're looking
+#   for: when a change is found, the differences in these between
+#   the runs on either side of it are reported as its likely
+#   cause, and changes with the same cause on many hosts are
+#   summarised together.
+#
+#   The time of a run is its microseconds per iteration.  check
+#   looks at the most recent runs of each series (-window, 60 by
+#   default) and finds changes by binary segmentation: it splits
+#   the logarithms of the times at the point which most separates
+#   their means, as measured by the t statistic, and accepts the
+#   split if fewer than -alpha (0.01) of random permutations of
+#   the times can be split as well.  Each part is then examined
+#   in the same way.  The permutation test makes no assumption
+#   about the distribution of the times, which is rarely normal,
+#   and the search for the best split is accounted for by doing
+#   the same search in every permutation.  A change must have at
+#   least -segment (5) runs on each side, and is reported if the
+#   medians on either side differ by at least -threshold percent
+#   (1).  The runs after the last change are the current level
+#   of the series, and the runs before it back to the previous
+#   change are its baseline: if the current level is slower, it's
+#   a regression.  Runs whose results failed validation are
+#   counted but not used.  The permutations are drawn from a fixed
+#   seed, so a check of the same store always gives the same
+#   result.
+
+    use strict;
+    use warnings;
+    use Getopt::Long qw(:config require_order);
+    use JSON::PP;
+    use List::Util qw(max min);
+
+    my $store = "fbresults.jsonl";
+    my $window = 60;
+    my $segment = 5;
+    my $alpha = 0.01;
+    my $threshold = 1;
+    my $permutations = 199;
+
+    #   Fields which describe the series of a record
+
+    my @buildFields = ('compiler', 'flags', 'features');
+    my @contextFields = ('libc', 'kernel', 'microcode', 'cpu_model', 'governor', 'affinity');
+
+    #   Fields of a record which are numbers, which CSV doesn't
+    #   distinguish from strings
+
+    my @numeric = qw(real_bits iterations repetitions seconds usec_per_iteration
+                     usec_mean usec_median usec_stddev usec_ci95 usec_min usec_max errors);
+
+    #   Options which don't change what a run computes, with the
+    #   number of arguments each takes
+
+    my %timingOptions = (
+        '-json' => 1, '-csv' => 1, '-repeat' => 1, '-warmup' => 1, '-duration' => 1,
+        '-t' => 1, '-trig' => 1, '-perf' => 0
+    );
+
+    GetOptions('store=s' => \$store) || usage();
+    my $command = shift(@ARGV) || usage();
+
+    if ($command eq 'ingest') {
+        usage() if scalar(@ARGV) == 0;
+        ingest(@ARGV);
+    } elsif ($command eq 'list') {
+        list();
+    } elsif ($command eq 'check') {
+        GetOptions('window=i' => \$window, 'segment=i' => \$segment,
+                   'alpha=f' => \$alpha, 'threshold=f' => \$threshold,
+                   'permutations=i' => \$permutations) || usage();
+        die("fbresults: -segment must be at least 2\n") if $segment < 2;
+        exit(check() > 0 ? 1 : 0);
+    } else {
+        usage();
+    }
+    exit(0);
+
+    sub usage {
+        print(STDERR <<"EOD");
+Usage: fbresults.pl [-store file] command
+Commands:
+    ingest file...   Add the records in the files to the store ($store)
+    list             List the series in the store
+    check [options]  Report changes in speed, and flag regressions
+Options of check:
+    -window n        Examine the most recent n runs of each series ($window)
+    -segment n       Runs required on each side of a change ($segment)
+    -alpha p         Significance required of a change ($alpha)
+    -threshold pct   Smallest change reported, percent ($threshold)
+    -permutations n  Permutations for the test of significance ($permutations)
+EOD
+        exit(2);
+    }
+
+    #   Read the records of a file of JSON lines or CSV
+
+    sub readRecords {
+        my ($file) = @_;
+        my (@records, @names, $fh);
+
+        if ($file eq '-') {
+            $fh = \*STDIN;
+        } else {
+            open($fh, '<', $file) || die("fbresults: cannot open $file: $!\n");
+        }
+        my $json = JSON::PP->new();
+        while (my $l = <$fh>) {
+            $l =~ s/\s+$//;
+            next if $l eq '';
+            if ($l =~ m/^\{/) {
+                my $r = eval { $json->decode($l) };
+                if (!defined($r)) {
+                    print(STDERR "fbresults: $file line $.: not JSON\n");
+                    next;
+                }
+                push(@records, $r);
+            } else {
+                my @values = splitCSV($l);
+                if ($values[0] eq 'benchmark') {
+                    @names = @values;                   # Header of a CSV file
+                } elsif (scalar(@names) > 0) {
+                    my %r;
+                    for (my $i = 0; $i <= $#names; $i++) {
+                        $r{$names[$i]} = (defined($values[$i]) && $values[$i] ne '') ?
+                            $values[$i] : undef;
+                    }
+                    #   As JSON would have them, so records from either round-trip
+                    for my $n (@numeric) {
+                        $r{$n} += 0 if defined($r{$n});
+                    }
+                    $r{valid} = ($r{valid} eq 'true') ? JSON::PP::true : JSON::PP::false
+                        if defined($r{valid});
+                    push(@records, \%r);
+                } else {
+                    print(STDERR "fbresults: $file line $.: CSV record before field names\n");
+                }
+            }
+        }
+        close($fh) if $file ne '-';
+        return @records;
+    }
+
+    sub splitCSV {
+        my ($l) = @_;
+        my @values;
+
+        while ($l =~ m/\G(?:"((?:[^"]|"")*)"|([^,]*))(,|$)/g) {
+            my $v = defined($1) ? $1 : $2;
+            $v =~ s/""/"/g if defined($1);
+            push(@values, $v);
+            last if $3 eq '';
+        }
+        return @values;
+    }
+
+    #   Identity of a run, for recognising one already stored
+
+    sub runId {
+        my ($r) = @_;
+        return join("\t", map { defined($r->{$_}) ? $r->{$_} : '' }
+            ('timestamp', 'host', 'benchmark', 'language', 'arguments', 'seconds'));
+    }
+
+    sub readStore {
+        return () if !-e $store;
+        return readRecords($store);
+    }
+
+    sub ingest {
+        my @files = @_;
+        my %stored = map { runId($_) => 1 } readStore();
+        my ($added, $duplicate, $untimed) = (0, 0, 0);
+        my $json = JSON::PP->new()->canonical();
+
+        open(my $out, '>>', $store) || die("fbresults: cannot open $store: $!\n");
+        foreach my $file (@files) {
+            foreach my $r (readRecords($file)) {
+                if (!defined($r->{benchmark}) || !defined($r->{timestamp}) ||
+                    !defined($r->{usec_per_iteration})) {
+                    $untimed++;
+                    next;
+                }
+                my $id = runId($r);
+                if ($stored{$id}) {
+                    $duplicate++;
+                    next;
+                }
+                $stored{$id} = 1;
+                print($out $json->encode($r), "\n");
+                $added++;
+            }
+        }
+        close($out) || die("fbresults: cannot write $store: $!\n");
+        printf("%d record%s added to %s", $added, $added == 1 ? '' : 's', $store);
+        printf(", %d already stored", $duplicate) if $duplicate > 0;
+        printf(", %d without a time skipped", $untimed) if $untimed > 0;
+        print(".\n");
+    }
+
+    #   Variant of a run: what it computes
+
+    sub variant {
+        my ($r) = @_;
+        my @args = split(' ', defined($r->{arguments}) ? $r->{arguments} : '');
+        my @options;
+
+        for (my $i = 0; $i <= $#args; $i++) {
+            if (defined($timingOptions{$args[$i]})) {
+                $i += $timingOptions{$args[$i]};
+            } elsif ($args[$i] !~ m/^\d+$/) {           # Iteration count
+                push(@options, $args[$i]);
+            }
+        }
+        my $v = join(' ', map { defined($r->{$_}) ? $r->{$_} : '?' }
+            ('benchmark', 'language', 'real_type'));
+        $v .= "/$r->{real_bits}" if defined($r->{real_bits});
+        $v .= " $r->{trig}" if defined($r->{trig}) && $r->{trig} ne 'library';
+        $v .= " " . join(' ', sort(@options)) if scalar(@options) > 0;
+        return $v;
+    }
+
+    sub build {
+        my ($r) = @_;
+        return join(' ', map { defined($r->{$_}) ? $r->{$_} : '?' } @buildFields);
+    }
+
+    #   Group the runs of the store into series, in order of time
+
+    sub series {
+        my %series;
+
+        foreach my $r (readStore()) {
+            my $host = defined($r->{host}) ? $r->{host} : '?';
+            push(@{$series{join("\n", $host, variant($r), build($r))}}, $r);
+        }
+        foreach my $k (keys(%series)) {
+            $series{$k} = [ sort { $a->{timestamp} cmp $b->{timestamp} } @{$series{$k}} ];
+        }
+        return %series;
+    }
+
+    sub valid {
+        my ($r) = @_;
+        return (!defined($r->{valid}) || $r->{valid}) && $r->{usec_per_iteration} > 0;
+    }
+
+    sub median {
+        my @x = sort { $a <=> $b } @_;
+        my $n = scalar(@x);
+        return ($n % 2) ? $x[$n / 2] : ($x[$n / 2 - 1] + $x[$n / 2]) / 2;
+    }
+
+    sub list {
+        my %series = series();
+
+        printf("%-16s %-40s %6s %12s  %s\n", 'Host', 'Variant', 'Runs', 'usec/iter', 'Build');
+        foreach my $k (sort(keys(%series))) {
+            my ($host, $variant, $build) = split("\n", $k);
+            my @t = map { $_->{usec_per_iteration} } grep { valid($_) } @{$series{$k}};
+            splice(@t, 0, scalar(@t) - $window) if scalar(@t) > $window;
+            printf("%-16s %-40s %6d %12s  %s\n", $host, $variant, scalar(@{$series{$k}}),
+                scalar(@t) > 0 ? sprintf('%.4f', median(@t)) : '-', $build);
+        }
+    }
+
+    #   The split of $x[$lo .. $hi - 1] with the largest t statistic,
+    #   returned as (index of the first element after the split, t)
+
+    sub bestSplit {
+        my ($x, $lo, $hi) = @_;
+        my $n = $hi - $lo;
+        my ($s, $ss) = (0, 0);
+
+        for (my $i = $lo; $i < $hi; $i++) {
+            $s += $x->[$i];
+            $ss += $x->[$i] * $x->[$i];
+        }
+        my ($ls, $lss) = (0, 0);
+        my ($best, $bestT) = (-1, -1);
+        for (my $i = $lo; $i < $hi - $segment; $i++) {
+            $ls += $x->[$i];
+            $lss += $x->[$i] * $x->[$i];
+            my $nl = $i - $lo + 1;
+            next if $nl < $segment;
+            my $nr = $n - $nl;
+            my ($ml, $mr) = ($ls / $nl, ($s - $ls) / $nr);
+            my $var = (($lss - $nl * $ml * $ml) + (($ss - $lss) - $nr * $mr * $mr)) / ($n - 2);
+            my $d = abs($ml - $mr);
+            my $t = ($var > 1e-30) ? $d / sqrt($var * (1 / $nl + 1 / $nr)) :
+                    ($d > 0 ? 9**9**9 : 0);
+            ($best, $bestT) = ($i + 1, $t) if $t > $bestT;
+        }
+        return ($best, $bestT);
+    }
+
+    #   Find the changes in $x[$lo .. $hi - 1], adding their indices
+    #   and significance to @$found
+
+    sub changePoints {
+        my ($x, $lo, $hi, $found) = @_;
+
+        return if $hi - $lo < 2 * $segment;
+        my ($k, $t) = bestSplit($x, $lo, $hi);
+        return if $k < 0 || $t <= 0;
+        my @y = @$x[$lo .. $hi - 1];
+        my $exceed = 0;
+        for (my $p = 0; $p < $permutations; $p++) {
+            for (my $i = $#y; $i > 0; $i--) {
+                my $j = int(rand($i + 1));
+                @y[$i, $j] = @y[$j, $i];
+            }
+            my (undef, $tp) = bestSplit(\@y, 0, scalar(@y));
+            $exceed++ if $tp >= $t;
+            return if ($exceed + 1) / ($permutations + 1) > $alpha;    # Can't be significant
+        }
+        push(@$found, [ $k, ($exceed + 1) / ($permutations + 1) ]);
+        changePoints($x, $lo, $k, $found);
+        changePoints($x, $k, $hi, $found);
+    }
+
+    #   Differences in the context of two runs
+
+    sub contextChange {
+        my ($a, $b) = @_;
+        my @changes;
+
+        foreach my $f (@contextFields) {
+            my ($va, $vb) = (defined($a->{$f}) ? $a->{$f} : '?', defined($b->{$f}) ? $b->{$f} : '?');
+            push(@changes, "$f $va -> $vb") if $va ne $vb;
+        }
+        return join(', ', @changes);
+    }
+
+    sub check {
+        my %series = series();
+        my ($nseries, $invalid, $regressions) = (0, 0, 0);
+        my %causes;
+
+        srand(1);
+        foreach my $k (sort(keys(%series))) {
+            my ($host, $variant, $build) = split("\n", $k);
+            my @runs = grep { valid($_) } @{$series{$k}};
+            $invalid += scalar(@{$series{$k}}) - scalar(@runs);
+            splice(@runs, 0, scalar(@runs) - $window) if scalar(@runs) > $window;
+            $nseries++;
+            my @x = map { log($_->{usec_per_iteration}) } @runs;
+            my @found;
+            changePoints(\@x, 0, scalar(@x), \@found);
+            @found = sort { $a->[0] <=> $b->[0] } @found;
+
+            #   Medians of the levels between the changes, merging
+            #   those which differ by less than the threshold, the
+            #   smallest difference first
+
+            my @levels;
+            while (1) {
+                my @bounds = (0, (map { $_->[0] } @found), scalar(@runs));
+                @levels = ();
+                for (my $i = 0; $i < $#bounds; $i++) {
+                    push(@levels, median(map { $_->{usec_per_iteration} }
+                        @runs[$bounds[$i] .. $bounds[$i + 1] - 1]));
+                }
+                my ($smallest, $change) = (-1, $threshold);
+                for (my $i = 0; $i <= $#found; $i++) {
+                    my $c = abs(100 * ($levels[$i + 1] / $levels[$i] - 1));
+                    ($smallest, $change) = ($i, $c) if $c < $change;
+                }
+                last if $smallest < 0;
+                splice(@found, $smallest, 1);
+            }
+
+            my $header = 0;
+            for (my $i = 0; $i <= $#found; $i++) {
+                my ($at, $p) = @{$found[$i]};
+                my $change = 100 * ($levels[$i + 1] / $levels[$i] - 1);
+                my $regression = $change > 0 && $i == $#found;
+                if (!$header) {
+                    print("$host  $variant\n    $build\n");
+                    $header = 1;
+                }
+
+                #   Changes in context near the change, whose
+                #   position is uncertain by a run or two
+
+                my %near;
+                for (my $j = max($at - 2, 1); $j <= min($at + 2, $#runs); $j++) {
+                    my $c = contextChange($runs[$j - 1], $runs[$j]);
+                    $near{$c} = $j if $c ne '';
+                }
+                my $cause = join('; ', sort { $near{$a} <=> $near{$b} } keys(%near));
+                printf("    %s  %+.2f%%  %.4f -> %.4f usec  p %.3f%s\n",
+                    $runs[$at]->{timestamp}, $change, $levels[$i], $levels[$i + 1], $p,
+                    $regression ? '  REGRESSION' : '');
+                print("        $cause\n") if $cause ne '';
+                if ($regression) {
+                    $regressions++;
+                    push(@{$causes{$cause eq '' ? 'no change recorded' : $cause}},
+                        [ $host, $change ]);
+                }
+            }
+            print("\n") if $header;
+        }
+
+        printf("%d series checked", $nseries);
+        printf(", %d invalid runs ignored", $invalid) if $invalid > 0;
+        printf(", %d regression%s.\n", $regressions, $regressions == 1 ? '' : 's');
+
+        #   Regressions with the same cause, which on many hosts
+        #   point to the change responsible
+
+        if ($regressions > 0) {
+            printf("\n%-8s %6s %8s  %s\n", 'Series', 'Hosts', 'Median', 'Change in context');
+            foreach my $cause (sort { scalar(@{$causes{$b}}) <=> scalar(@{$causes{$a}}) ||
+                                      $a cmp $b } keys(%causes)) {
+                my %hosts = map { $_->[0] => 1 } @{$causes{$cause}};
+                printf("%-8d %6d %+7.2f%%  %s\n", scalar(@{$causes{$cause}}),
+                    scalar(keys(%hosts)), median(map { $_->[1] } @{$causes{$cause}}), $cause);
+            }
+        }
+        return $regressions;
+    }